@@ -0,0 +1,60 @@
+#version 440
+
+layout(location = 0) in vec2 inUV;
+
+out vec4 frag_color;
+
+// The G-buffer, see gbuffer_outputs.glsl for what's in each target
+uniform layout (binding=0) sampler2D s_AlbedoShininess;
+uniform layout (binding=1) sampler2D s_NormalFog;
+uniform layout (binding=2) sampler2D s_Lighting;
+uniform layout (binding=3) sampler2D s_Depth;
+
+// Takes us from clip space back to world space, for rebuilding positions from depth
+uniform mat4 u_InverseViewProjection;
+
+// Every pixel gets it's lights from the clusters, we don't know which object a pixel came from
+// so there are no per-object lights to use
+#undef PER_OBJECT_LIGHTS
+
+#include "../fragments/multiple_point_lights.glsl"
+#include "../fragments/frame_uniforms.glsl"
+
+// Same fog color as frag_blinn_phong_textured.glsl
+const vec3 FOG_COLOR = vec3(0.3647, 0.3412, 0.4);
+
+void main() {
+	// Nothing was drawn to the G-buffer here, so leave the clear color alone
+	float depth = texture(s_Depth, inUV).r;
+	if (depth >= 1.0) {
+		discard;
+	}
+
+	vec4 albedoShininess = texture(s_AlbedoShininess, inUV);
+	vec4 normalFog = texture(s_NormalFog, inUV);
+	vec4 lighting = texture(s_Lighting, inUV);
+
+	vec3 albedo = albedoShininess.rgb;
+	vec3 normal = normalize(normalFog.xyz);
+
+	// Rebuild the world position from the depth buffer
+	vec4 worldPos = u_InverseViewProjection * vec4(vec3(inUV, depth) * 2.0 - 1.0, 1.0);
+	worldPos /= worldPos.w;
+
+	// Materials that lit themselves have already done the work for us
+	vec3 lightAccumulation = lighting.a > 0.5 ? lighting.rgb : CalcAllLightContribution(worldPos.xyz, normal, u_CamPos.xyz, albedoShininess.a);
+
+	vec3 result = lightAccumulation * albedo;
+	frag_color = vec4(mix(result, FOG_COLOR, normalFog.w), 1.0);
+
+	// The debug views only need one or two channels of the G-buffer
+	if(IsFlagSet(FLAG_ENABLE_D)){
+		frag_color = vec4(albedo, 1.0);
+	}
+	if(IsFlagSet(FLAG_ENABLE_A)){
+		frag_color = vec4(albedo * getAmbient(), 1.0);
+	}
+	if(IsFlagSet(FLAG_ENABLE_S)){
+		frag_color = vec4(albedo * getSpecular(worldPos.xyz, normal, u_CamPos.xyz, albedoShininess.a), 1.0);
+	}
+}
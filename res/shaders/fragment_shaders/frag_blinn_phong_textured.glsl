@@ -2,8 +2,13 @@
 
 #include "../fragments/fs_common_inputs.glsl"
 
+#ifdef DEFERRED
+// Writes the surface to the G-buffer, the lighting is added afterwards by deferred_lighting.glsl
+#include "../fragments/gbuffer_outputs.glsl"
+#else
 // We output a single color to the color buffer
 layout(location = 0) out vec4 frag_color;
+#endif
 
 ////////////////////////////////////////////////////////////////
 /////////////// Instance Level Uniforms ////////////////////////
@@ -12,13 +17,29 @@ layout(location = 0) out vec4 frag_color;
 // Represents a collection of attributes that would define a material
 // For instance, you can think of this like material settings in 
 // Unity
-struct Material {
+// Samplers can't be stored in a uniform block, so the material's textures are regular uniforms
+struct MaterialTextures {
+#ifdef TEXTURE_ARRAY
+	// Materials that only differ by their texture share an array, see Material::PackTextureArrays
+	sampler2DArray Diffuse;
+#else
 	sampler2D Diffuse;
-	float     Shininess;
+#endif
 	sampler1D toonTex;
 };
-// Create a uniform for the material
-uniform Material u_Material;
+uniform MaterialTextures u_Textures;
+
+// Everything else is packed into a buffer owned by the material, which is only
+// re-uploaded when a parameter changes (see Material::Apply)
+layout (std140, binding = 4) uniform b_Material {
+	float Shininess;
+} u_Material;
+
+#ifdef TEXTURE_ARRAY
+#define SampleDiffuse(uv) texture(u_Textures.Diffuse, vec3(uv, inTextureLayer))
+#else
+#define SampleDiffuse(uv) texture(u_Textures.Diffuse, uv)
+#endif
 
 ////////////////////////////////////////////////////////////////
 ///////////// Application Level Uniforms ///////////////////////
@@ -31,39 +52,51 @@ uniform Material u_Material;
 ////////////////////////////////////////////////////////////////
 
 #include "../fragments/frame_uniforms.glsl"
-#include "../fragments/color_correction.glsl"
 
 // https://learnopengl.com/Advanced-Lighting/Advanced-Lighting
 void main() {
 	// Normalize our input normal
 	vec3 normal = normalize(inNormal);
 
-	// Use the lighting calculation that we included from our partial file
-	vec3 lightAccumulation = CalcAllLightContribution(inWorldPos, normal, u_CamPos.xyz, u_Material.Shininess);
-	
-	vec4 textureColor = texture(u_Material.Diffuse, inUVAlt);
+	vec4 textureColor = SampleDiffuse(inUVAlt);
 	// Get the albedo from the diffuse / albedo map
 	if(IsFlagSet(FLAG_ENABLE_ASC)){
-		textureColor = texture(u_Material.Diffuse, inUV);
-		lightAccumulation = inLight;
+		textureColor = SampleDiffuse(inUV);
 	}
 
 	if(IsFlagSet(FLAG_ENABLE_TOON_BULL)){
-		textureColor.r = texture(u_Material.toonTex, textureColor.r).r;
-		textureColor.g = texture(u_Material.toonTex, textureColor.g).g;
-		textureColor.b = texture(u_Material.toonTex, textureColor.b).b;
+		textureColor.r = texture(u_Textures.toonTex, textureColor.r).r;
+		textureColor.g = texture(u_Textures.toonTex, textureColor.g).g;
+		textureColor.b = texture(u_Textures.toonTex, textureColor.b).b;
 	}
 
-	if(IsFlagSet(FLAG_ENABLE_TOON_LIGHT)){
-		lightAccumulation.r = texture(u_Material.toonTex, lightAccumulation.r).r;
-		lightAccumulation.g = texture(u_Material.toonTex, lightAccumulation.g).g;
-		lightAccumulation.b = texture(u_Material.toonTex, lightAccumulation.b).b;
+#ifdef DEFERRED
+	// The lighting pass can evaluate the lights for us, unless we're using the vertex lighting or
+	// running the lighting through the toon ramp, which needs our material's texture
+	bool ownLighting = IsFlagSet(FLAG_ENABLE_ASC) || IsFlagSet(FLAG_ENABLE_TOON_LIGHT);
+#else
+	bool ownLighting = true;
+#endif
+
+	vec3 lightAccumulation = vec3(0);
+	if(ownLighting){
+		// Use the lighting calculation that we included from our partial file
+		lightAccumulation = IsFlagSet(FLAG_ENABLE_ASC) ? inLight : CalcAllLightContribution(inWorldPos, normal, u_CamPos.xyz, u_Material.Shininess);
+
+		if(IsFlagSet(FLAG_ENABLE_TOON_LIGHT)){
+			lightAccumulation.r = texture(u_Textures.toonTex, lightAccumulation.r).r;
+			lightAccumulation.g = texture(u_Textures.toonTex, lightAccumulation.g).g;
+			lightAccumulation.b = texture(u_Textures.toonTex, lightAccumulation.b).b;
+		}
 	}
 
+#ifdef DEFERRED
+	WriteGBuffer(inColor * textureColor.rgb, u_Material.Shininess, normal, inFog, lightAccumulation, ownLighting);
+#else
 	// combine for the final result
 	vec3 result = lightAccumulation  * inColor * textureColor.rgb;
 
-	frag_color = vec4(ColorCorrect(mix(result, vec3(0.3647, 0.3412, 0.4), inFog)), textureColor.a);
+	frag_color = vec4(mix(result, vec3(0.3647, 0.3412, 0.4), inFog), textureColor.a);
 
 	if(IsFlagSet(FLAG_ENABLE_D)){
 		frag_color = textureColor;
@@ -74,4 +107,5 @@ void main() {
 	if(IsFlagSet(FLAG_ENABLE_S)){
 		frag_color = vec4((textureColor.rgb * getSpecular(inWorldPos, normal, u_CamPos.xyz, u_Material.Shininess)), textureColor.a);
 	}
+#endif
 }
\ No newline at end of file
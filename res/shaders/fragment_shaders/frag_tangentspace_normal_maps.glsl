@@ -20,12 +20,16 @@ layout(location = 0) out vec4 frag_color;
 // Represents a collection of attributes that would define a material
 // For instance, you can think of this like material settings in 
 // Unity
-struct Material {
+// Samplers can't be stored in a uniform block, so the material's textures are regular uniforms
+struct MaterialTextures {
 	sampler2D Diffuse;
-	float     Shininess;
 };
-// Create a uniform for the material
-uniform Material u_Material;
+uniform MaterialTextures u_Textures;
+
+// Everything else is packed into a buffer owned by the material, must match basic.glsl
+layout (std140, binding = 4) uniform b_Material {
+	float Shininess;
+} u_Material;
 
 uniform sampler2D s_NormalMap;
 
@@ -34,7 +38,6 @@ uniform sampler2D s_NormalMap;
 ////////////////////////////////////////////////////////////////
 
 #include "../fragments/multiple_point_lights.glsl"
-#include "../fragments/color_correction.glsl"
 
 const float LOG_MAX = 2.40823996531;
 
@@ -53,10 +56,10 @@ void main() {
 	vec3 lightAccumulation = CalcAllLightContribution(inWorldPos, normal, u_CamPos.xyz, u_Material.Shininess);
 
 	// Get the albedo from the diffuse / albedo map
-	vec4 textureColor = texture(u_Material.Diffuse, inUV);
+	vec4 textureColor = texture(u_Textures.Diffuse, inUV);
 
 	// combine for the final result
 	vec3 result = lightAccumulation  * inColor * textureColor.rgb;
 
-	frag_color = vec4(ColorCorrect(result), textureColor.a);
+	frag_color = vec4(result, textureColor.a);
 }
\ No newline at end of file
@@ -0,0 +1,27 @@
+#version 440
+
+layout(location = 0) in vec2 inUV;
+
+out vec4 frag_color;
+
+// The scene's color output
+uniform layout (binding=0) sampler2D s_Image;
+// The LUT we're correcting with
+uniform layout (binding=1) sampler3D s_ColorCorrection;
+
+#ifdef BLEND_LUTS
+// The LUT we're blending away from, and how far along the blend is (0 is all previous, 1 is all current)
+uniform layout (binding=2) sampler3D s_PreviousColorCorrection;
+uniform float u_LutBlend;
+#endif
+
+void main() {
+    vec4 color = texture(s_Image, inUV);
+    vec3 result = texture(s_ColorCorrection, color.rgb).rgb;
+
+#ifdef BLEND_LUTS
+    result = mix(texture(s_PreviousColorCorrection, color.rgb).rgb, result, u_LutBlend);
+#endif
+
+    frag_color = vec4(result, color.a);
+}
@@ -0,0 +1,24 @@
+#version 440
+
+layout(location = 0) in vec2 inUV;
+
+out vec4 frag_color;
+
+// The image to scale up, should be using linear filtering
+uniform layout (binding=0) sampler2D s_Image;
+// How much detail to bring back, 0 is a plain bilinear upscale
+uniform float u_Sharpness;
+
+void main() {
+    vec2 texel = 1.0 / vec2(textureSize(s_Image, 0));
+    vec4 center = texture(s_Image, inUV);
+
+    // Unsharp mask, push the pixel away from the average of its neighbours to undo some of the blur from upscaling
+    vec3 neighbours = texture(s_Image, inUV + vec2(texel.x, 0.0)).rgb +
+                      texture(s_Image, inUV - vec2(texel.x, 0.0)).rgb +
+                      texture(s_Image, inUV + vec2(0.0, texel.y)).rgb +
+                      texture(s_Image, inUV - vec2(0.0, texel.y)).rgb;
+    vec3 result = center.rgb + (center.rgb - neighbours * 0.25) * u_Sharpness;
+
+    frag_color = vec4(clamp(result, 0.0, 1.0), center.a);
+}
@@ -12,13 +12,17 @@ layout(location = 0) out vec4 frag_color;
 // Represents a collection of attributes that would define a material
 // For instance, you can think of this like material settings in 
 // Unity
-struct Material {
+// Samplers can't be stored in a uniform block, so the material's textures are regular uniforms
+struct MaterialTextures {
 	sampler2D Diffuse;
 	sampler2D Specular;
-	float Shininess;
 };
-// Create a uniform for the material
-uniform Material u_Material;
+uniform MaterialTextures u_Textures;
+
+// Everything else is packed into a buffer owned by the material, must match basic.glsl
+layout (std140, binding = 4) uniform b_Material {
+	float Shininess;
+} u_Material;
 
 ////////////////////////////////////////////////////////////////
 ///////////// Application Level Uniforms ///////////////////////
@@ -31,14 +35,13 @@ uniform Material u_Material;
 ////////////////////////////////////////////////////////////////
 
 #include "../fragments/frame_uniforms.glsl"
-#include "../fragments/color_correction.glsl"
 
 // https://learnopengl.com/Advanced-Lighting/Advanced-Lighting
 void main() {
 	// Normalize our input normal
 	vec3 normal = normalize(inNormal);
 
-	float specPower = texture(u_Material.Specular, inUV).r;
+	float specPower = texture(u_Textures.Specular, inUV).r;
 	
 	vec3 toEye = normalize(u_CamPos.xyz - inWorldPos);
 	vec3 environmentDir = reflect(-toEye, normal);
@@ -48,10 +51,10 @@ void main() {
 	vec3 lightAccumulation = CalcAllLightContribution(inWorldPos, normal, u_CamPos.xyz, specPower);
 
 	// Get the albedo from the diffuse / albedo map
-	vec4 textureColor = texture(u_Material.Diffuse, inUV);
+	vec4 textureColor = texture(u_Textures.Diffuse, inUV);
 
 	// combine for the final result
 	vec3 result = lightAccumulation  * inColor * textureColor.rgb;
 
-	frag_color = vec4(ColorCorrect(mix(result, reflected, specPower)), textureColor.a);
+	frag_color = vec4(mix(result, reflected, specPower), textureColor.a);
 }
\ No newline at end of file
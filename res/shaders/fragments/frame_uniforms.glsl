@@ -16,6 +16,14 @@ layout (std140, binding = 0) uniform b_FrameLevelUniforms {
     uniform uint  u_Flags;
 };
 
+#ifdef INSTANCED
+// When instancing, the per-object data comes in as vertex attributes instead (see vs_common.glsl)
+#define u_ModelViewProjection (u_ViewProjection * inModelTransform)
+#define u_Model inModelTransform
+#define u_NormalMatrix mat4(inNormalMatrix)
+#define u_TextureLayer inTextureLayer
+#define u_ObjectLights inInstanceLights
+#else
 // Stores uniforms that change every object/instance
 layout (std140, binding = 1) uniform b_InstanceLevelUniforms {
     // Complete MVP
@@ -24,7 +32,12 @@ layout (std140, binding = 1) uniform b_InstanceLevelUniforms {
     uniform mat4 u_Model;
     // Normal Matrix for transforming normals
     uniform mat4 u_NormalMatrix;
+    // The layer of the material's texture array, if it uses one
+    uniform float u_TextureLayer;
+    // Indices of the lights picked for this object (-1 for empty slots), only used with PER_OBJECT_LIGHTS
+    uniform vec4  u_ObjectLights;
 };
+#endif
 
 #define FLAG_ENABLE_COLOR_CORRECTIONA (1 << 0)
 #define FLAG_ENABLE_COLOR_CORRECTIONB (1 << 1)
@@ -37,6 +50,14 @@ layout (std140, binding = 1) uniform b_InstanceLevelUniforms {
 #define FLAG_ENABLE_A (1 << 8)
 #define FLAG_ENABLE_D (1 << 9)
 
+#ifdef STATIC_RENDER_FLAGS
+// The flags were baked in when this variant was compiled (see RenderLayer::SetRenderFlags), so every
+// check folds down to a constant and the code for disabled features gets compiled out
+bool IsFlagSet(uint flag) {
+    return (uint(STATIC_RENDER_FLAGS) & flag) != 0;
+}
+#else
 bool IsFlagSet(uint flag) {
     return (u_Flags & flag) != 0;
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
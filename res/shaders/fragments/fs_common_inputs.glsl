@@ -4,4 +4,12 @@ layout(location = 2) in vec3 inNormal;
 layout(location = 3) in noperspective vec2 inUV;
 layout(location = 10) in vec2 inUVAlt;
 layout(location = 7) in vec3 inLight;
-layout(location = 9) in float inFog;
\ No newline at end of file
+layout(location = 9) in float inFog;
+#ifdef TEXTURE_ARRAY
+layout(location = 11) flat in float inTextureLayer;
+#endif
+#ifdef PER_OBJECT_LIGHTS
+// The lights picked for this object on the CPU, passed down from the vertex stage
+layout(location = 12) flat in ivec4 inObjectLights;
+#define OBJECT_LIGHT_INDICES inObjectLights
+#endif
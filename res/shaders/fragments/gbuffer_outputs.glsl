@@ -0,0 +1,34 @@
+/*
+ * Partial file for fragment shaders that support deferred shading. When DEFERRED is defined
+ * (see ShaderProgram::GetDeferredVariant), the shader writes the surface to the G-buffer with
+ * WriteGBuffer instead of writing a color, and the lights are added in a full screen pass
+ * afterwards (see deferred_lighting.glsl). Layout matches RenderLayer's G-buffer:
+ *
+ * Color0 (RGBA8)   albedo in rgb, shininess in a
+ * Color1 (RGBA16F) world space normal in xyz, fog amount in w
+ * Color2 (RGBA16F) lighting the material worked out itself in rgb, 1 in a if it did
+ *
+ * Usage:
+ * #ifdef DEFERRED
+ * WriteGBuffer(albedo, shininess, normal, inFog, vec3(0), false);
+ * #endif
+*/
+#ifdef DEFERRED
+layout(location = 0) out vec4 gb_AlbedoShininess;
+layout(location = 1) out vec4 gb_NormalFog;
+layout(location = 2) out vec4 gb_Lighting;
+
+// Writes a surface to the G-buffer
+// @param albedo      The surface color, before lighting
+// @param shininess   The specular power for the surface, between 0 and 1
+// @param normal      The world space normal (normalized)
+// @param fog         How much the fog color should be mixed in, between 0 and 1
+// @param lighting    The lighting for the surface, only used if hasLighting is set
+// @param hasLighting True if the material has already lit the surface (ex: vertex lighting), so the
+//                    lighting pass should use it instead of evaluating the lights
+void WriteGBuffer(vec3 albedo, float shininess, vec3 normal, float fog, vec3 lighting, bool hasLighting) {
+	gb_AlbedoShininess = vec4(albedo, shininess);
+	gb_NormalFog = vec4(normal, fog);
+	gb_Lighting = vec4(lighting, hasLighting ? 1.0 : 0.0);
+}
+#endif
@@ -9,12 +9,10 @@
  * vec3 lighting = CalculateAllLightContribution(inWorldPos, normal, u_CamPos);
 */
 
-// The maximum number of lights the shader supports, increasing this will lower performance!
-#define MAX_LIGHTS 8
-
 // Represents a single light source
 struct Light {
-	vec4  Position;
+	// Stores position in xyz and the distance the light is cut off at in w
+	vec4  PositionRadius;
 	// Stores color in RBG and attenuation in w
 	vec4  ColorAttenuation;
 };
@@ -27,13 +25,35 @@ layout (std140, binding = 2) uniform b_LightBlock {
 	// on the C++ side
     vec4  AmbientColAndNumLights;
 
-    // Our array of all lights
-    Light Lights[MAX_LIGHTS];
-
     // The rotation of the skybox/environment map
 	mat3  EnvironmentRotation;
 };
 
+// Describes the grid of clusters the lights have been sorted into, see ClusteredLighting.h
+layout (std140, binding = 3) uniform b_LightClusterBlock {
+	// The view projection the clusters were built with
+	mat4  ClusterViewProjection;
+	// The number of clusters along each axis
+	uvec4 ClusterGridSize;
+	// Scale and bias for turning log(depth) into a depth slice
+	vec4  ClusterDepthParams;
+};
+
+// All the lights in the scene
+layout (std430, binding = 0) readonly buffer b_Lights {
+	Light Lights[];
+};
+
+// The offset (x) and count (y) of each cluster's lights in LightIndices
+layout (std430, binding = 1) readonly buffer b_LightClusters {
+	uvec2 LightClusters[];
+};
+
+// The indices of the lights in each cluster, packed together
+layout (std430, binding = 2) readonly buffer b_LightIndices {
+	uint LightIndices[];
+};
+
 // Uniform for our environment map / skybox, bound to slot 0 by default
 uniform layout(binding=15) samplerCube s_EnvironmentMap;
 
@@ -55,7 +75,7 @@ vec3 SampleEnvironmentMap(vec3 normal) {
 // @param shininess The specular power for the fragment, between 0 and 1
 vec3 CalcPointLightContribution(vec3 worldPos, vec3 normal, vec3 viewDir, Light light, float shininess) {
 	// Get the direction to the light in world space
-	vec3 toLight = light.Position.xyz - worldPos;
+	vec3 toLight = light.PositionRadius.xyz - worldPos;
 	// Get distance between fragment and light
 	float dist = length(toLight);
 	// Normalize toLight for other calculations
@@ -78,9 +98,54 @@ vec3 CalcPointLightContribution(vec3 worldPos, vec3 normal, vec3 viewDir, Light
 	// We add the one to prevent divide by zero errors
 	float attenuation = clamp(1.0 / (1.0 + light.ColorAttenuation.w * pow(dist, 2)), 0, 1);
 
+	// Fade out to nothing at the cutoff radius, so lights don't visibly end at cluster edges
+	float window = clamp(1.0 - pow(dist / light.PositionRadius.w, 4), 0, 1);
+	attenuation *= window * window;
+
 	return (diffuseOut + specularOut) * attenuation;
 }
 
+// Finds the range of lights that can affect the given position
+// @param worldPos The position in world space
+// @returns The offset of the cluster's lights in LightIndices in x, and the number of lights in y
+uvec2 GetLightCluster(vec3 worldPos) {
+	vec4 clipPos = ClusterViewProjection * vec4(worldPos, 1.0);
+	// w is the view depth, clamp it so points behind the camera land in the first slice
+	float depth = max(clipPos.w, 0.0001);
+
+	vec2 tile = (clipPos.xy / depth * 0.5 + 0.5) * vec2(ClusterGridSize.xy);
+	uvec2 xy = uvec2(clamp(tile, vec2(0), vec2(ClusterGridSize.xy) - 1));
+	uint z = uint(clamp(log(depth) * ClusterDepthParams.x + ClusterDepthParams.y, 0, float(ClusterGridSize.z) - 1));
+
+	return LightClusters[xy.x + ClusterGridSize.x * (xy.y + ClusterGridSize.y * z)];
+}
+
+// Adds up the contributions of every light that can reach the fragment. With PER_OBJECT_LIGHTS
+// defined this is only the few lights that were picked for the object on the CPU (see
+// ClusteredLighting::SelectObjectLights), otherwise it's the lights in the fragment's cluster
+// @param worldPos  The fragment's position in world space
+// @param normal    The fragment's normal (normalized)
+// @param viewDir   Direction between camera and fragment
+// @param shininess The specular power for the fragment, between 0 and 1
+vec3 CalcLightSum(vec3 worldPos, vec3 normal, vec3 viewDir, float shininess) {
+	vec3 result = vec3(0);
+#ifdef PER_OBJECT_LIGHTS
+	// The picked lights are packed at the front, with -1 in the unused slots
+	ivec4 lights = OBJECT_LIGHT_INDICES;
+	for(int ix = 0; ix < 4 && lights[ix] >= 0; ix++) {
+		result += CalcPointLightContribution(worldPos, normal, viewDir, Lights[lights[ix]], shininess);
+	}
+#else
+	// Iterate over only the lights that reach our cluster
+	uvec2 cluster = GetLightCluster(worldPos);
+	for(uint ix = 0; ix < cluster.y; ix++) {
+		// Additive lighting model
+		result += CalcPointLightContribution(worldPos, normal, viewDir, Lights[LightIndices[cluster.x + ix]], shininess);
+	}
+#endif
+	return result;
+}
+
 /*
  * Calculates the lighting contribution for all lights in the scene
  * for a given fragment
@@ -95,11 +160,7 @@ vec3 CalcAllLightContribution(vec3 worldPos, vec3 normal, vec3 camPos, float shi
 	// Direction between camera and fragment will be shared for all lights
 	vec3 viewDir  = normalize(camPos - worldPos);
 	
-	// Iterate over all lights
-	for(int ix = 0; ix < AmbientColAndNumLights.w && ix < MAX_LIGHTS; ix++) {
-		// Additive lighting model
-		lightAccumulation += CalcPointLightContribution(worldPos, normal, viewDir, Lights[ix], shininess);
-	}
+	lightAccumulation += CalcLightSum(worldPos, normal, viewDir, shininess);
 
 	return lightAccumulation;
 }
@@ -115,11 +176,7 @@ vec3 getSpecular(vec3 worldPos, vec3 normal, vec3 camPos, float shininess) {
 	// Direction between camera and fragment will be shared for all lights
 	vec3 viewDir  = normalize(camPos - worldPos);
 	
-	// Iterate over all lights
-	for(int ix = 0; ix < AmbientColAndNumLights.w && ix < MAX_LIGHTS; ix++) {
-		// Additive lighting model
-		lightAccumulation += CalcPointLightContribution(worldPos, normal, viewDir, Lights[ix], shininess);
-	}
+	lightAccumulation += CalcLightSum(worldPos, normal, viewDir, shininess);
 
 	return lightAccumulation;
 }
\ No newline at end of file
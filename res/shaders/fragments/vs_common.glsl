@@ -8,6 +8,19 @@ layout(location = 3) in vec2 inUV;
 layout(location = 4) in vec3 inTangent;
 layout(location = 5) in vec3 inBiTangent;
 
+#ifdef INSTANCED
+// Per-instance transforms, fed from RenderLayer's instance buffer when drawing batches
+// of objects that share a mesh and material. These replace the instance UBO (see frame_uniforms.glsl)
+// This will consume 4 slots, since it's essentially 4 vec4s in memory
+layout(location = 8) in mat4 inModelTransform;
+// This will consume 3 slots in memory
+layout(location = 12) in mat3 inNormalMatrix;
+// Layer of the material's texture array, see Material::PackTextureArrays
+layout(location = 15) in float inTextureLayer;
+// The lights picked for this instance, see RenderLayer::IsPerObjectLightsEnabled
+layout(location = 7) in vec4 inInstanceLights;
+#endif
+
 // Standard vertex shader outputs
 layout(location = 0) out vec3 outWorldPos;
 layout(location = 1) out vec3 outColor;
@@ -17,6 +30,22 @@ layout(location = 10) out vec2 outUVAlt;
 layout(location = 4) out mat3 outTBN;
 layout(location = 7) out vec3 outLight;
 layout(location = 9) out float outFog;
+#ifdef TEXTURE_ARRAY
+layout(location = 11) flat out float outTextureLayer;
+#endif
+#ifdef PER_OBJECT_LIGHTS
+// Vertex shaders should copy u_ObjectLights into this, so the fragment stage knows which lights to use
+layout(location = 12) flat out ivec4 outObjectLights;
+#endif
+
+// Lets the depth pre-pass (which uses the same vertex stage with a different fragment stage) produce
+// bit-identical depth values, so the color pass can use GL_EQUAL
+invariant gl_Position;
 
 // Include the matrices and frame level parameters
 #include "frame_uniforms.glsl"
+
+#ifdef PER_OBJECT_LIGHTS
+// Where multiple_point_lights.glsl reads the object's lights from in the vertex stage
+#define OBJECT_LIGHT_INDICES ivec4(u_ObjectLights)
+#endif
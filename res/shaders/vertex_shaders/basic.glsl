@@ -4,13 +4,12 @@
 #include "../fragments/vs_common.glsl"
 #include "../fragments/multiple_point_lights.glsl"
 
-struct Material {
-	sampler2D Diffuse;
-	float     Shininess;
-	sampler1D toonTex;
-};
-// Create a uniform for the material
-uniform Material u_Material;
+// The material's parameters are packed into a buffer owned by the material, which is only
+// re-uploaded when a parameter changes (see Material::Apply). Every fragment shader paired
+// with this one must declare the block with the same members, and keep it's samplers in u_Textures
+layout (std140, binding = 4) uniform b_Material {
+	float Shininess;
+} u_Material;
 
 void main() {
 
@@ -63,6 +62,13 @@ void main() {
 	///////////
 	outColor = inColor;
 
+#ifdef TEXTURE_ARRAY
+	outTextureLayer = u_TextureLayer;
+#endif
+#ifdef PER_OBJECT_LIGHTS
+	outObjectLights = ivec4(u_ObjectLights);
+#endif
+
 	outLight = CalcAllLightContribution(outWorldPos, normalize(outNormal), u_CamPos.xyz, u_Material.Shininess);
 }
 
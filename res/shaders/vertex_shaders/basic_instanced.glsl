@@ -35,5 +35,8 @@ void main() {
 	///////////
 	outColor = inColor;
 
+#ifdef PER_OBJECT_LIGHTS
+	outObjectLights = ivec4(u_ObjectLights);
+#endif
 }
 
@@ -50,4 +50,7 @@ void main() {
 	///////////
 	outColor = inColor;
 
+#ifdef PER_OBJECT_LIGHTS
+	outObjectLights = ivec4(u_ObjectLights);
+#endif
 }
\ No newline at end of file
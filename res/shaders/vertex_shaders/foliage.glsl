@@ -21,5 +21,9 @@ void main() {
 	// Pass our UV coords to the fragment shader
 	outUV = inUV;
 	outColor = inColor;
+
+#ifdef PER_OBJECT_LIGHTS
+	outObjectLights = ivec4(u_ObjectLights);
+#endif
 }
 
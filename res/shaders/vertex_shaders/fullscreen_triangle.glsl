@@ -0,0 +1,10 @@
+#version 440
+
+layout(location = 0) out vec2 outUV;
+
+// Draws a single triangle big enough to cover the screen, no vertex buffers needed
+// Call with glDrawArrays(GL_TRIANGLES, 0, 3), the parts outside of the screen get clipped
+void main() {
+    outUV = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(outUV * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -29,5 +29,9 @@ void main() {
         (sin(outWorldPos.z / u_Scale + M_PI) + 1) / 2,
         (sin(outWorldPos.z / u_Scale) + 1) / 2
     );
+
+#ifdef PER_OBJECT_LIGHTS
+	outObjectLights = ivec4(u_ObjectLights);
+#endif
 }
 
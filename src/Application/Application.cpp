@@ -20,12 +20,14 @@
 #include "Graphics/ShaderProgram.h"
 #include "Graphics/Textures/Texture1D.h"
 #include "Graphics/Textures/Texture2D.h"
+#include "Graphics/Textures/Texture2DArray.h"
 #include "Graphics/Textures/Texture3D.h"
 #include "Graphics/Textures/TextureCube.h"
 #include "Graphics/VertexTypes.h"
 #include "Graphics/Font.h"
 #include "Graphics/GuiBatcher.h"
 #include "Graphics/Framebuffer.h"
+#include "Graphics/GpuProfiler.h"
 
 // Gameplay
 #include "Gameplay/Material.h"
@@ -57,6 +59,7 @@
 #include "Layers/ImGuiDebugLayer.h"
 #include "Layers/InstancedRenderingTestLayer.h"
 #include "Layers/ParticleLayer.h"
+#include "Layers/PostProcessingLayer.h"
 
 Application* Application::_singleton = nullptr;
 std::string Application::_applicationName = "INFR-2350U - DEMO";
@@ -72,7 +75,9 @@ Application::Application() :
 	_windowTitle("Silent Hill - PSX"),
 	_currentScene(nullptr),
 	_targetScene(nullptr),
-	_renderOutput(nullptr)
+	_renderOutput(nullptr),
+	_upscaleShader(nullptr),
+	_fullscreenTriangle(nullptr)
 { }
 
 Application::~Application() = default; 
@@ -150,6 +155,7 @@ void Application::_Run()
 	_layers.push_back(std::make_shared<LogicUpdateLayer>());
 	_layers.push_back(std::make_shared<RenderLayer>());
 	_layers.push_back(std::make_shared<ParticleLayer>());
+	_layers.push_back(std::make_shared<PostProcessingLayer>());
 	//_layers.push_back(std::make_shared<InstancedRenderingTestLayer>());
 	_layers.push_back(std::make_shared<InterfaceLayer>());
 
@@ -291,6 +297,7 @@ void Application::_RegisterClasses()
 	// Register all our resource types so we can load them from manifest files
 	ResourceManager::RegisterType<Texture1D>();
 	ResourceManager::RegisterType<Texture2D>();
+	ResourceManager::RegisterType<Texture2DArray>();
 	ResourceManager::RegisterType<Texture3D>();
 	ResourceManager::RegisterType<TextureCube>();
 	ResourceManager::RegisterType<ShaderProgram>();
@@ -349,6 +356,9 @@ void Application::_LateUpdate() {
 
 void Application::_PreRender()
 {
+	// Everything from here to the end of _PostRender is part of the frame's GPU timings
+	GpuProfiler::Get().BeginFrame();
+
 	glm::ivec2 size ={ 0, 0 };
 	glfwGetWindowSize(_window, &size.x, &size.y);
 	glViewport(0, 0, size.x, size.y);
@@ -369,7 +379,9 @@ void Application::_RenderScene() {
 	Framebuffer::Sptr result = nullptr;
 	for (const auto& layer : _layers) {
 		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnRender)) {
+			GpuProfiler::Get().BeginScope(layer->Name);
 			layer->OnRender(result);
+			GpuProfiler::Get().EndScope();
 			Framebuffer::Sptr layerResult = layer->GetRenderOutput(); 
 			result = layerResult != nullptr ? layerResult : result;
 		}
@@ -383,7 +395,9 @@ void Application::_PostRender() {
 	for (auto it = _layers.crbegin(); it != _layers.crend(); it++) {
 		const auto& layer = *it;
 		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnPostRender)) {
+			GpuProfiler::Get().BeginScope(layer->Name + " (Post)");
 			layer->OnPostRender();
+			GpuProfiler::Get().EndScope();
 			Framebuffer::Sptr layerResult = layer->GetPostRenderOutput();
 			_renderOutput = layerResult != nullptr ? layerResult : _renderOutput;
 		}
@@ -405,10 +419,63 @@ void Application::_PostRender() {
 		//glViewport(0, 0, windowSize.x, windowSize.y);
 		glm::ivec4 viewportMinMax ={ viewport.x, viewport.y, viewport.x + viewport.z, viewport.y + viewport.w };
 
-		_renderOutput->Bind(FramebufferBinding::Read);
-		glBindFramebuffer(*FramebufferBinding::Write, 0);
-		Framebuffer::Blit({ 0, 0, _renderOutput->GetWidth(), _renderOutput->GetHeight() }, viewportMinMax, BufferFlags::All, MagFilter::Nearest);
+		// The render layer may be drawing below the window's resolution, in which case we need to filter
+		// the output as we scale it up. If the sizes match a straight copy is the cheapest
+		RenderLayer::Sptr renderLayer = GetLayer<RenderLayer>();
+		UpscaleFilter filter = renderLayer != nullptr ? renderLayer->GetUpscaleFilter() : UpscaleFilter::Nearest;
+		if (_renderOutput->GetWidth() == viewport.z && _renderOutput->GetHeight() == viewport.w) {
+			filter = UpscaleFilter::Nearest;
+		}
+
+		GpuProfiler::Scope scope("Present");
+		if (filter == UpscaleFilter::Sharpen) {
+			glBindFramebuffer(*FramebufferBinding::Write, 0);
+			_DrawSharpenedOutput();
+		} else {
+			_renderOutput->Bind(FramebufferBinding::Read);
+			glBindFramebuffer(*FramebufferBinding::Write, 0);
+			// Depth can only be copied with nearest filtering, and nothing after us needs it anyways
+			if (filter == UpscaleFilter::Linear) {
+				Framebuffer::Blit({ 0, 0, _renderOutput->GetWidth(), _renderOutput->GetHeight() }, viewportMinMax, BufferFlags::Color, MagFilter::Linear);
+			} else {
+				Framebuffer::Blit({ 0, 0, _renderOutput->GetWidth(), _renderOutput->GetHeight() }, viewportMinMax, BufferFlags::All, MagFilter::Nearest);
+			}
+		}
+	}
+
+	GpuProfiler::Get().EndFrame();
+}
+
+void Application::_DrawSharpenedOutput() {
+	if (_upscaleShader == nullptr) {
+		_upscaleShader = ShaderProgram::Create();
+		_upscaleShader->LoadShaderPartFromFile("shaders/vertex_shaders/fullscreen_triangle.glsl", ShaderPartType::Vertex);
+		_upscaleShader->LoadShaderPartFromFile("shaders/fragment_shaders/post_sharpen_upscale.glsl", ShaderPartType::Fragment);
+		_upscaleShader->Link();
+		_upscaleShader->SetDebugName("Sharpen Upscale");
+
+		_fullscreenTriangle = VertexArrayObject::Create();
+		_fullscreenTriangle->SetDebugName("Upscale Triangle");
+	}
+
+	Texture2D::Sptr source = _renderOutput->GetTextureAttachment(RenderTargetAttachment::Color0);
+	if (source == nullptr) {
+		return;
 	}
+
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+	glDepthMask(GL_FALSE);
+
+	_upscaleShader->Bind();
+	_upscaleShader->SetUniform("u_Sharpness", UPSCALE_SHARPNESS);
+	source->Bind(0);
+	_fullscreenTriangle->Bind();
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	VertexArrayObject::Unbind();
+
+	glDepthMask(GL_TRUE);
+	glEnable(GL_DEPTH_TEST);
 }
 
 void Application::_Unload() {
@@ -422,6 +489,8 @@ void Application::_Unload() {
 
 	// Clean up ImGui
 	ImGuiHelper::Cleanup();
+
+	GpuProfiler::Uninitialize();
 }
 
 void Application::_HandleSceneChange() {
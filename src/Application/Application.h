@@ -5,6 +5,8 @@
 #include "Utils/Macros.h"
 #include "Application/ApplicationLayer.h"
 #include "Gameplay/Scene.h"
+#include "Graphics/ShaderProgram.h"
+#include "Graphics/VertexArrayObject.h"
 
 struct GLFWwindow;
 
@@ -142,6 +144,12 @@ protected:
 
 	Framebuffer::Sptr _renderOutput;
 
+	// For scaling the render output up to the window with UpscaleFilter::Sharpen, created on first use
+	ShaderProgram::Sptr     _upscaleShader;
+	VertexArrayObject::Sptr _fullscreenTriangle;
+	// How strongly the sharpening upscale sharpens, see post_sharpen_upscale.glsl
+	const float UPSCALE_SHARPNESS = 0.5f;
+
 	void _Run();
 	void _RegisterClasses();
 	void _Load();
@@ -150,6 +158,10 @@ protected:
 	void _PreRender();
 	void _RenderScene();
 	void _PostRender();
+	/// <summary>
+	/// Draws the render output into the bound viewport of the back buffer with a sharpening filter
+	/// </summary>
+	void _DrawSharpenedOutput();
 	void _Unload();
 	void _HandleSceneChange();
 	void _HandleWindowSizeChanged(const glm::ivec2& newSize);
@@ -173,58 +173,62 @@ void DefaultSceneLayer::_CreateScene()
 		Material::Sptr THR1Mat = ResourceManager::CreateAsset<Material>(basicShader);
 		{
 			THR1Mat->Name = "THR1";
-			THR1Mat->Set("u_Material.Diffuse", TexTHR1);
+			THR1Mat->Set("u_Textures.Diffuse", TexTHR1);
 			THR1Mat->Set("u_Material.Shininess", 0.0f);
-			THR1Mat->Set("u_Material.toonTex", toonLut);
+			THR1Mat->Set("u_Textures.toonTex", toonLut);
 		}
 
 		Material::Sptr THR2Mat = ResourceManager::CreateAsset<Material>(basicShader);
 		{
 			THR2Mat->Name = "THR2";
-			THR2Mat->Set("u_Material.Diffuse", TexTHR2);
+			THR2Mat->Set("u_Textures.Diffuse", TexTHR2);
 			THR2Mat->Set("u_Material.Shininess", 0.0f);
-			THR2Mat->Set("u_Material.toonTex", toonLut);
+			THR2Mat->Set("u_Textures.toonTex", toonLut);
 		}
 
 		Material::Sptr THR3Mat = ResourceManager::CreateAsset<Material>(basicShader);
 		{
 			THR3Mat->Name = "THR3";
-			THR3Mat->Set("u_Material.Diffuse", TexTHR3);
+			THR3Mat->Set("u_Textures.Diffuse", TexTHR3);
 			THR3Mat->Set("u_Material.Shininess", 0.0f);
-			THR3Mat->Set("u_Material.toonTex", toonLut);
+			THR3Mat->Set("u_Textures.toonTex", toonLut);
 		}
 
 		Material::Sptr THR4Mat = ResourceManager::CreateAsset<Material>(basicShader);
 		{
 			THR4Mat->Name = "THR4";
-			THR4Mat->Set("u_Material.Diffuse", TexTHR4);
+			THR4Mat->Set("u_Textures.Diffuse", TexTHR4);
 			THR4Mat->Set("u_Material.Shininess", 0.0f);
-			THR4Mat->Set("u_Material.toonTex", toonLut);
+			THR4Mat->Set("u_Textures.toonTex", toonLut);
 		}
 
 		Material::Sptr THF1Mat = ResourceManager::CreateAsset<Material>(basicShader);
 		{
 			THF1Mat->Name = "THF1";
-			THF1Mat->Set("u_Material.Diffuse", TexTHF1);
+			THF1Mat->Set("u_Textures.Diffuse", TexTHF1);
 			THF1Mat->Set("u_Material.Shininess", 0.0f);
-			THF1Mat->Set("u_Material.toonTex", toonLut);
+			THF1Mat->Set("u_Textures.toonTex", toonLut);
 		}
 
 		Material::Sptr THF2Mat = ResourceManager::CreateAsset<Material>(basicShader);
 		{
 			THF2Mat->Name = "THF2";
-			THF2Mat->Set("u_Material.Diffuse", TexTHF2);
+			THF2Mat->Set("u_Textures.Diffuse", TexTHF2);
 			THF2Mat->Set("u_Material.Shininess", 0.0f);
-			THF2Mat->Set("u_Material.toonTex", toonLut);
+			THF2Mat->Set("u_Textures.toonTex", toonLut);
 		}
 
 		Material::Sptr THF3Mat = ResourceManager::CreateAsset<Material>(basicShader);
 		{
 			THF3Mat->Name = "THF3";
-			THF3Mat->Set("u_Material.Diffuse", TexTHF3);
+			THF3Mat->Set("u_Textures.Diffuse", TexTHF3);
 			THF3Mat->Set("u_Material.Shininess", 0.0f);
-			THF3Mat->Set("u_Material.toonTex", toonLut);
+			THF3Mat->Set("u_Textures.toonTex", toonLut);
 		}
+
+		// The THR textures are all the same size and format, so they can go in one texture array,
+		// which lets the renderer batch these materials together
+		Material::PackTextureArrays({ THR1Mat, THR2Mat, THR3Mat, THR4Mat, THF1Mat, THF2Mat, THF3Mat });
 #pragma endregion
 #pragma region Lighting
 
@@ -267,6 +271,7 @@ void DefaultSceneLayer::_CreateScene()
 			RenderComponent::Sptr renderer = THR1Object->Add<RenderComponent>();
 			renderer->SetMesh(THR1);
 			renderer->SetMaterial(THR1Mat);
+			renderer->SetStatic(true);
 		}
 
 		GameObject::Sptr THR2Object = scene->CreateGameObject("THR2Object");
@@ -278,6 +283,7 @@ void DefaultSceneLayer::_CreateScene()
 			RenderComponent::Sptr renderer = THR2Object->Add<RenderComponent>();
 			renderer->SetMesh(THR2);
 			renderer->SetMaterial(THR2Mat);
+			renderer->SetStatic(true);
 		}
 
 		GameObject::Sptr THR3Object = scene->CreateGameObject("THR3Object");
@@ -289,6 +295,7 @@ void DefaultSceneLayer::_CreateScene()
 			RenderComponent::Sptr renderer = THR3Object->Add<RenderComponent>();
 			renderer->SetMesh(THR3);
 			renderer->SetMaterial(THR3Mat);
+			renderer->SetStatic(true);
 		}
 
 		GameObject::Sptr THR4Object = scene->CreateGameObject("THR4Object");
@@ -300,6 +307,7 @@ void DefaultSceneLayer::_CreateScene()
 			RenderComponent::Sptr renderer = THR4Object->Add<RenderComponent>();
 			renderer->SetMesh(THR4);
 			renderer->SetMaterial(THR4Mat);
+			renderer->SetStatic(true);
 		}
 
 		GameObject::Sptr THF1Object = scene->CreateGameObject("THF1Object");
@@ -311,6 +319,7 @@ void DefaultSceneLayer::_CreateScene()
 			RenderComponent::Sptr renderer = THF1Object->Add<RenderComponent>();
 			renderer->SetMesh(THF1);
 			renderer->SetMaterial(THF1Mat);
+			renderer->SetStatic(true);
 		}
 
 		GameObject::Sptr THF2Object = scene->CreateGameObject("THF2Object");
@@ -322,6 +331,7 @@ void DefaultSceneLayer::_CreateScene()
 			RenderComponent::Sptr renderer = THF2Object->Add<RenderComponent>();
 			renderer->SetMesh(THF2);
 			renderer->SetMaterial(THF2Mat);
+			renderer->SetStatic(true);
 		}
 
 		GameObject::Sptr THF3Object = scene->CreateGameObject("THF3Object");
@@ -333,6 +343,7 @@ void DefaultSceneLayer::_CreateScene()
 			RenderComponent::Sptr renderer = THF3Object->Add<RenderComponent>();
 			renderer->SetMesh(THF3);
 			renderer->SetMaterial(THF3Mat);
+			renderer->SetStatic(true);
 		}
 
 		/*
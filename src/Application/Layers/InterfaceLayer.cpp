@@ -20,7 +20,13 @@ void InterfaceLayer::OnRender(const Framebuffer::Sptr& prevLayer) {
 
 	// We can use the application's viewport to set our OpenGL viewport, as well as clip rendering to that area
 	const glm::uvec4& viewport = app.GetPrimaryViewport();
-	glViewport(viewport.x, viewport.y, viewport.z, viewport.w);
+	// The scene may be drawn below the window's resolution (see RenderLayer's dynamic resolution), so
+	// scale the viewport down to match the target we're drawing into
+	glm::vec2 scale = prevLayer != nullptr ? glm::vec2(prevLayer->GetSize()) / glm::vec2(app.GetWindowSize()) : glm::vec2(1.0f);
+	glViewport(
+		static_cast<GLint>(viewport.x * scale.x), static_cast<GLint>(viewport.y * scale.y),
+		static_cast<GLsizei>(viewport.z * scale.x), static_cast<GLsizei>(viewport.w * scale.y)
+	);
 
 	// Disable culling
 	glDisable(GL_CULL_FACE);
@@ -0,0 +1,140 @@
+#include "PostProcessingLayer.h"
+#include "Application/Application.h"
+#include "Application/Timing.h"
+#include "Application/Layers/RenderLayer.h"
+#include "Utils/JsonGlmHelpers.h"
+
+PostProcessingLayer::PostProcessingLayer() :
+	ApplicationLayer(),
+	_output(nullptr),
+	_colorCorrectionShader(nullptr),
+	_fullscreenTriangle(nullptr),
+	_colorLut(nullptr),
+	_previousColorLut(nullptr),
+	_lutBlend(1.0f),
+	_lutBlendTime(0.5f)
+{
+	Name = "PostProcessing";
+	Overrides = AppLayerFunctions::OnAppLoad | AppLayerFunctions::OnRender;
+}
+
+PostProcessingLayer::~PostProcessingLayer() = default;
+
+void PostProcessingLayer::OnAppLoad(const nlohmann::json& config) {
+	_colorCorrectionShader = ShaderProgram::Create();
+	_colorCorrectionShader->LoadShaderPartFromFile("shaders/vertex_shaders/fullscreen_triangle.glsl", ShaderPartType::Vertex);
+	_colorCorrectionShader->LoadShaderPartFromFile("shaders/fragment_shaders/post_color_correction.glsl", ShaderPartType::Fragment);
+	_colorCorrectionShader->Link();
+	_colorCorrectionShader->SetDebugName("Color Correction");
+
+	_fullscreenTriangle = VertexArrayObject::Create();
+	_fullscreenTriangle->SetDebugName("Fullscreen Triangle");
+
+	// Our settings are under our name in the app config, see GetDefaultConfig
+	if (config.contains(Name)) {
+		_lutBlendTime = JsonGet(config[Name], "lut_blend_time", _lutBlendTime);
+	}
+}
+
+void PostProcessingLayer::OnRender(const Framebuffer::Sptr& prevLayer) {
+	_output = nullptr;
+	_UpdateColorLut();
+
+	// Nothing to correct, leave the scene's output as is
+	if (_colorLut == nullptr || prevLayer == nullptr) {
+		return;
+	}
+	Texture2D::Sptr source = prevLayer->GetTextureAttachment(RenderTargetAttachment::Color0);
+	if (source == nullptr) {
+		return;
+	}
+
+	RenderLayer::Sptr renderLayer = Application::Get().GetLayer<RenderLayer>();
+	_output = renderLayer->GetRenderTargetPool()->AcquireForFrame(prevLayer->GetWidth(), prevLayer->GetHeight(), RenderTargetType::ColorRgb8);
+	_output->Bind();
+	glViewport(0, 0, _output->GetWidth(), _output->GetHeight());
+
+	// Every pixel gets written, so there's no need to clear, and no depth to test against
+	glDisable(GL_DEPTH_TEST);
+	glDepthMask(GL_FALSE);
+
+	// Only pay for the second lookup while we're actually blending
+	const ShaderProgram::Sptr& shader = _previousColorLut != nullptr ? _colorCorrectionShader->GetVariant({ "BLEND_LUTS" }) : _colorCorrectionShader;
+	if (shader != nullptr) {
+		shader->Bind();
+		source->Bind(0);
+		_colorLut->Bind(1);
+		if (_previousColorLut != nullptr) {
+			_previousColorLut->Bind(2);
+			shader->SetUniform("u_LutBlend", _lutBlend);
+		}
+
+		_fullscreenTriangle->Bind();
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		VertexArrayObject::Unbind();
+	}
+
+	glDepthMask(GL_TRUE);
+	glEnable(GL_DEPTH_TEST);
+
+	// The output is presented after every layer has finished, so it's acquired for the whole frame and the
+	// pool takes it back when the next frame starts
+}
+
+Framebuffer::Sptr PostProcessingLayer::GetRenderOutput() {
+	return _output;
+}
+
+nlohmann::json PostProcessingLayer::GetDefaultConfig() {
+	return {
+		{ "lut_blend_time", 0.5f }
+	};
+}
+
+const Texture3D::Sptr& PostProcessingLayer::GetColorLUT() const {
+	return _colorLut;
+}
+
+float PostProcessingLayer::GetLutBlendTime() const {
+	return _lutBlendTime;
+}
+
+void PostProcessingLayer::SetLutBlendTime(float value) {
+	_lutBlendTime = value;
+}
+
+void PostProcessingLayer::_UpdateColorLut() {
+	Application& app = Application::Get();
+	RenderFlags flags = app.GetLayer<RenderLayer>()->GetRenderFlags();
+
+	// Later flags win if more than one is set
+	Texture3D::Sptr lut = nullptr;
+	if (*(flags & RenderFlags::EnableColorCorrection)) {
+		lut = app.CurrentScene()->GetColorLUT(1);
+	}
+	if (*(flags & RenderFlags::EnableWarm)) {
+		lut = app.CurrentScene()->GetColorLUT(2);
+	}
+	if (*(flags & RenderFlags::EnableBlackAndWhite)) {
+		lut = app.CurrentScene()->GetColorLUT(3);
+	}
+
+	if (lut != _colorLut) {
+		// We can only blend if there's something on both sides, turning correction on or off is instant
+		if (_lutBlendTime > 0.0f && lut != nullptr && _colorLut != nullptr) {
+			_previousColorLut = _colorLut;
+			_lutBlend = 0.0f;
+		} else {
+			_previousColorLut = nullptr;
+			_lutBlend = 1.0f;
+		}
+		_colorLut = lut;
+	}
+	else if (_previousColorLut != nullptr) {
+		_lutBlend += Timing::Current().DeltaTime() / _lutBlendTime;
+		if (_lutBlend >= 1.0f) {
+			_previousColorLut = nullptr;
+			_lutBlend = 1.0f;
+		}
+	}
+}
@@ -1 +1,59 @@
 #pragma once
+#include "../ApplicationLayer.h"
+#include "Graphics/Framebuffer.h"
+#include "Graphics/ShaderProgram.h"
+#include "Graphics/VertexArrayObject.h"
+#include "Graphics/Textures/Texture3D.h"
+
+/// <summary>
+/// Runs full screen passes over the scene once it has been drawn, before the GUI goes on top
+///
+/// Currently only handles color correction, which looks up every pixel in the LUT selected by the
+/// render layer's flags. When the LUT changes we can blend from the old LUT to the new one over a
+/// short time instead of snapping. Intermediate targets come from the render layer's RenderTargetPool
+/// </summary>
+class PostProcessingLayer final : public ApplicationLayer {
+public:
+	MAKE_PTRS(PostProcessingLayer);
+
+	PostProcessingLayer();
+	virtual ~PostProcessingLayer();
+
+	/// <summary>
+	/// Gets the LUT that color correction is currently using, or nullptr if color correction is off
+	/// </summary>
+	const Texture3D::Sptr& GetColorLUT() const;
+
+	/// <summary>
+	/// Gets or sets the time in seconds to blend between the old and new LUT when the LUT changes,
+	/// 0 to switch instantly. Can be set with "lut_blend_time" in the PostProcessing section of the app settings
+	/// </summary>
+	float GetLutBlendTime() const;
+	void SetLutBlendTime(float value);
+
+	// Inherited from ApplicationLayer
+
+	virtual void OnAppLoad(const nlohmann::json& config) override;
+	virtual void OnRender(const Framebuffer::Sptr& prevLayer) override;
+	virtual Framebuffer::Sptr GetRenderOutput() override;
+	virtual nlohmann::json GetDefaultConfig() override;
+
+protected:
+	// The target we drew into this frame, or nullptr if we didn't draw anything
+	Framebuffer::Sptr _output;
+
+	ShaderProgram::Sptr       _colorCorrectionShader;
+	// Empty VAO for drawing the full screen triangle, the vertices are generated in the shader
+	VertexArrayObject::Sptr   _fullscreenTriangle;
+
+	Texture3D::Sptr _colorLut;
+	// The LUT we're blending away from, or nullptr if we aren't blending
+	Texture3D::Sptr _previousColorLut;
+	float           _lutBlend;
+	float           _lutBlendTime;
+
+	/// <summary>
+	/// Picks the LUT to use from the render flags, and advances the blend between LUTs
+	/// </summary>
+	void _UpdateColorLut();
+};
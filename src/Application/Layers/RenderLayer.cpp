@@ -3,10 +3,15 @@
 #include "Graphics/GuiBatcher.h"
 #include "Gameplay/Components/Camera.h"
 #include "Graphics/DebugDraw.h"
+#include "Graphics/GpuProfiler.h"
 #include "Graphics/Textures/TextureCube.h"
 #include "../Timing.h"
 #include "Gameplay/Components/ComponentManager.h"
 #include "Gameplay/Components/RenderComponent.h"
+#include "Graphics/VertexTypes.h"
+#include "Utils/JsonGlmHelpers.h"
+
+#include <algorithm>
 
 // GLM math library
 #include <GLM/glm.hpp>
@@ -19,13 +24,36 @@
 RenderLayer::RenderLayer() :
 	ApplicationLayer(),
 	_primaryFBO(nullptr),
+	_targetPool(nullptr),
 	_blitFbo(true),
 	_frameUniforms(nullptr),
 	_instanceUniforms(nullptr),
 	_renderFlags(RenderFlags::AmbientSpecularCustom),
-	_clearColor({ 0.1f, 0.1f, 0.1f, 1.0f })
+	_clearColor({ 0.1f, 0.1f, 0.1f, 1.0f }),
+	_frustumCulling(true),
+	_gpuCulling(false),
+	_pvsCulling(true),
+	_perObjectLights(false),
+	_deferredShading(false),
+	_geometryPoolEnabled(false),
+	_occlusionCulling(false),
+	_depthPrepass(false),
+	_lodSelection(true),
+	_parallelExtract(true),
+	_dynamicResolution(false),
+	_upscaleFilter(UpscaleFilter::Linear),
+	_renderStats(RenderStats()),
+	_resolutionScale(1.0f),
+	_minResolutionScale(0.5f),
+	_maxResolutionScale(1.0f),
+	_targetFrameTime(16.6f),
+	_gpuFrameTime(0.0f),
+	_smoothedFrameTime(0.0f),
+	_resolutionCooldown(0),
+	_gpuTimeVersion(0)
 {
 	Name = "Rendering";
+	SetRenderFlags(_renderFlags);
 	Overrides = AppLayerFunctions::OnAppLoad | AppLayerFunctions::OnRender | AppLayerFunctions::OnWindowResize;
 }
 
@@ -37,6 +65,12 @@ void RenderLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 
 	Application& app = Application::Get();
 
+	// Recycle any transient targets from last frame
+	_targetPool->BeginFrame();
+
+	// Pick this frame's resolution before anything gets drawn
+	_UpdateResolutionScale();
+
 	glViewport(0, 0, _primaryFBO->GetWidth(), _primaryFBO->GetHeight());
 
 	// We bind our framebuffer so we can render to it
@@ -57,10 +91,6 @@ void RenderLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 	glEnable(GL_DEPTH_TEST);
 	glEnable(GL_CULL_FACE);
 
-	// The current material that is bound for rendering
-	Material::Sptr currentMat = nullptr;
-	ShaderProgram::Sptr shader = nullptr;
-
 	// Bind the skybox texture to a reserved texture slot
 	// See Material.h and Material.cpp for how we're reserving texture slots
 	TextureCube::Sptr environment = app.CurrentScene()->GetSkyboxTexture();
@@ -68,28 +98,15 @@ void RenderLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 		environment->Bind(15);
 	}
 
-	Texture3D::Sptr colorLUT;
-	// Binding the color correction LUT
-	if (_renderFlags == RenderFlags::EnableColorCorrection) {
-		colorLUT = app.CurrentScene()->GetColorLUT(1);
-	}
-	if (_renderFlags == RenderFlags::EnableWarm) {
-		colorLUT = app.CurrentScene()->GetColorLUT(2);
-	}
-	if (_renderFlags == RenderFlags::EnableBlackAndWhite) {
-		colorLUT = app.CurrentScene()->GetColorLUT(3);
-	}
-	if (colorLUT) {
-		colorLUT->Bind(14);
-	}
-
 	// Here we'll bind all the UBOs to their corresponding slots
 	app.CurrentScene()->PreRender();
 	_frameUniforms->Bind(FRAME_UBO_BINDING);
-	_instanceUniforms->Bind(INSTANCE_UBO_BINDING);
 
 	// Draw physics debug
-	app.CurrentScene()->DrawPhysicsDebug();
+	{
+		GpuProfiler::Scope scope("Physics Debug");
+		app.CurrentScene()->DrawPhysicsDebug();
+	}
 
 	// Upload frame level uniforms
 	auto& frameData = _frameUniforms->GetData();
@@ -102,51 +119,301 @@ void RenderLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 	frameData.u_RenderFlags = _renderFlags;
 	_frameUniforms->Update();
 
-	Material::Sptr defaultMat = app.CurrentScene()->DefaultMaterial;
+	// Sort the scene's lights into clusters for this view, the lights are re-uploaded every frame so
+	// they can be moved around freely
+	_lightClusters->Update(app.CurrentScene()->Lights, camera->GetView(), camera->GetProjection(),
+						   camera->GetNearPlane(), camera->GetFarPlane(), camera->GetOrthoEnabled());
+	_lightClusters->Bind();
 
-	// Render all our objects
-	app.CurrentScene()->Components().Each<RenderComponent>([&](const RenderComponent::Sptr& renderable) {
-		// Early bail if mesh not set
-		if (renderable->GetMesh() == nullptr) {
-			return;
+	// Everything the extraction needs from the camera
+	ExtractContext context;
+	context.ViewProjection  = viewProj;
+	context.View            = camera->GetView();
+	context.ViewFrustum     = Frustum::FromViewProjection(viewProj);
+	context.ProjectionScale = camera->GetProjection()[1][1];
+	context.NearPlane       = camera->GetNearPlane();
+	context.Orthographic    = camera->GetOrthoEnabled();
+	context.DefaultMaterial = app.CurrentScene()->DefaultMaterial;
+
+	_renderStats = RenderStats();
+	_renderStats.Lights = _lightClusters->GetLightCount();
+	_renderStats.LightClusterEntries = _lightClusters->GetIndexCount();
+
+	if (_occlusionCulling) {
+		_occlusionCuller->BeginFrame();
+	}
+
+	// The scene's transforms were brought up to date in PreRender, so from here until submission the
+	// scene is only read from, and the per-object work can be split up into chunks across threads
+	_renderables.clear();
+	if (_frustumCulling && !_gpuCulling) {
+		// Let the scene's spatial tree throw out whole branches of objects that are off screen, anything it
+		// lets through still gets the exact sphere and box tests during extraction
+		app.CurrentScene()->QueryFrustum(context.ViewFrustum, [&](Gameplay::GameObject* object) {
+			object->Each<RenderComponent>([&](const RenderComponent::Sptr& renderable) {
+				if (renderable->IsEnabled && !renderable->IsStaticBatched()) {
+					_renderables.push_back(renderable.get());
+				}
+			});
+			return true;
+		});
+	} else {
+		app.CurrentScene()->Components().Each<RenderComponent>([&](const RenderComponent::Sptr& renderable) {
+			// Merged static objects get drawn by their batch instead
+			if (!renderable->IsStaticBatched()) {
+				_renderables.push_back(renderable.get());
+			}
+		});
+	}
+	_renderStats.ObjectsVisited = static_cast<uint32_t>(_renderables.size());
+	for (const RenderComponent::Sptr& batch : app.CurrentScene()->GetStaticBatcher()->GetRenderables()) {
+		_renderables.push_back(batch.get());
+	}
+
+	// Look up which chunks can't be seen from the camera's view cell. A static batch can only be skipped
+	// if none of the chunks merged into it can be seen
+	_pvsHidden.clear();
+	const Gameplay::PotentiallyVisibleSet::Sptr& pvs = app.CurrentScene()->GetPotentiallyVisibleSet();
+	if (_pvsCulling && pvs != nullptr && pvs->CollectHidden(*app.CurrentScene(), camera->GetGameObject()->GetPosition(), _pvsHidden)) {
+		const Gameplay::StaticBatcher::Sptr& batcher = app.CurrentScene()->GetStaticBatcher();
+		for (size_t ix = 0; ix < batcher->GetRenderables().size(); ix++) {
+			_pvsBatchMembers.clear();
+			batcher->GetMembers(ix, _pvsBatchMembers);
+			bool hidden = !_pvsBatchMembers.empty() && std::all_of(_pvsBatchMembers.begin(), _pvsBatchMembers.end(), [&](const RenderComponent* member) {
+				return _pvsHidden.count(member) != 0;
+			});
+			if (hidden) {
+				_pvsHidden.insert(batcher->GetRenderables()[ix].get());
+			}
 		}
+	}
 
-		// If we don't have a material, try getting the scene's fallback material
-		// If none exists, do not draw anything
-		if (renderable->GetMaterial() == nullptr) {
-			if (defaultMat != nullptr) {
-				renderable->SetMaterial(defaultMat);
-			} else {
-				return;
+	uint32_t chunkCount = static_cast<uint32_t>((_renderables.size() + EXTRACT_CHUNK_SIZE - 1) / EXTRACT_CHUNK_SIZE);
+	if (_extractBuffers.size() < chunkCount) {
+		_extractBuffers.resize(chunkCount);
+	}
+	auto extractChunk = [&](uint32_t chunk) {
+		size_t first = chunk * EXTRACT_CHUNK_SIZE;
+		_ExtractDraws(context, first, glm::min(first + EXTRACT_CHUNK_SIZE, _renderables.size()), _extractBuffers[chunk]);
+	};
+	if (_parallelExtract) {
+		_extractPool->ParallelFor(chunkCount, extractChunk);
+	} else {
+		for (uint32_t chunk = 0; chunk < chunkCount; chunk++) {
+			extractChunk(chunk);
+		}
+	}
+
+	// Merge the chunks in order, so the queue comes out the same however the work was split up. Occlusion
+	// queries are GL objects, so those get checked here on the GL thread
+	_drawQueue.clear();
+	_drawTransforms.clear();
+	for (uint32_t chunk = 0; chunk < chunkCount; chunk++) {
+		ExtractBuffer& buffer = _extractBuffers[chunk];
+		_renderStats.ObjectsCulled += buffer.Culled;
+		_renderStats.ObjectsPvsCulled += buffer.PvsCulled;
+		_renderStats.ObjectLightEntries += buffer.ObjectLights;
+
+		for (ExtractedDraw& draw : buffer.Draws) {
+			// Skip big objects that were hidden last frame, or let the GPU decide if we don't know yet
+			if (draw.TestOcclusion) {
+				if (!_occlusionCuller->Test(draw.Command.Renderable, draw.WorldBox, draw.Command.Condition)) {
+					_renderStats.ObjectsOccluded++;
+					continue;
+				}
+				if (draw.Command.Condition != 0) {
+					_renderStats.ObjectsConditional++;
+				}
+			}
+			if (draw.Command.Renderable->GetLodLevel() > 0) {
+				_renderStats.ObjectsReducedLod++;
 			}
+
+			draw.Command.Transform = static_cast<uint32_t>(_drawTransforms.size());
+			_drawQueue.push_back(draw.Command);
+			_drawTransforms.push_back(draw.Transform);
 		}
+	}
+	_renderStats.ObjectsDrawn = static_cast<uint32_t>(_drawQueue.size());
 
-		// If the material has changed, we need to bind the new shader and set up our material and frame data
-		// Note: This is a good reason why we should be sorting the render components in ComponentManager
-		if (renderable->GetMaterial() != currentMat) {
-			currentMat = renderable->GetMaterial();
-			shader = currentMat->GetShader();
+	// Sort so that draws sharing state end up next to each other
+	_SortDrawQueue();
 
-			shader->Bind();
-			currentMat->Apply();
+	// Group runs of draws sharing a mesh and material into batches, and collect instance
+	// data for any batch that is big enough to be worth instancing
+	_drawBatches.clear();
+	_instanceData.clear();
+	_indirectCommands.clear();
+	_cullInstances.clear();
+	_cullBounds.clear();
+	const bool gpuCulling = _frustumCulling && _gpuCulling;
+	for (size_t ix = 0; ix < _drawQueue.size(); ) {
+		const DrawCommand& first = _drawQueue[ix];
+		size_t end = ix + 1;
+		// Conditionally rendered draws need their own draw call, so they never join a batch
+		while (end < _drawQueue.size() && first.Condition == 0 && _drawQueue[end].Condition == 0 &&
+			   _drawQueue[end].Material->GetBatchId() == first.Material->GetBatchId() && _drawQueue[end].Mesh == first.Mesh) {
+			end++;
+		}
+		const size_t next = end;
+
+		// If the shader can't be instanced (ex: it doesn't use vs_common.glsl) we fall back to regular draws
+		bool canInstance = _GetFlagVariant(first.Material)->GetInstancedVariant() != nullptr;
+
+		// The culling shader fills in indirect commands, so it can only handle instanced draws of indexed meshes
+		bool gpuCull = gpuCulling && canInstance && first.Condition == 0 && first.Mesh->GetIndexBuffer() != nullptr;
+
+		// Everything else skipped the frustum tests during extraction, so test it here instead. The
+		// draws that are kept get moved to the front of the run
+		if (gpuCulling && !gpuCull) {
+			size_t kept = ix;
+			for (size_t command = ix; command < end; command++) {
+				const DrawCommand& draw = _drawQueue[command];
+				if (_IsInFrustum(context.ViewFrustum, draw.Renderable->GetMeshResource()->Mesh->GetBounds(), _drawTransforms[draw.Transform].Model)) {
+					_drawQueue[kept++] = draw;
+				}
+			}
+			_renderStats.ObjectsCulled += static_cast<uint32_t>(end - kept);
+			_renderStats.ObjectsDrawn -= static_cast<uint32_t>(end - kept);
+			end = kept;
+			if (end == ix) {
+				ix = next;
+				continue;
+			}
+		}
+
+		DrawBatch batch;
+		batch.FirstCommand = ix;
+		batch.Count = static_cast<uint32_t>(end - ix);
+		batch.BaseInstance = -1;
+		batch.IndirectCommand = -1;
+		batch.Pooled = false;
+		batch.GpuCulled = gpuCull;
+		batch.DepthPrepass = false;
+		batch.Deferred = false;
+
+		// Pooled meshes are always drawn through the indirect buffer, even single objects, so
+		// that all of a material's pooled batches can go out in one multi-draw
+		const GeometryPool::Allocation* alloc = nullptr;
+		if (_geometryPoolEnabled && canInstance && first.Condition == 0) {
+			alloc = _geometryPool->GetAllocation(first.Renderable->GetLodMesh());
+		}
+
+		// With GPU culling the instance buffer is filled by the culling shader, so anything it can't cull
+		// (ex: non-indexed meshes) is drawn without instancing
+		if (alloc != nullptr || gpuCull || (batch.Count >= MIN_INSTANCED_BATCH && canInstance && !gpuCulling)) {
+			std::vector<InstanceData>& instances = gpuCull ? _cullInstances : _instanceData;
+			batch.BaseInstance = static_cast<int32_t>(instances.size());
+			if (alloc != nullptr || gpuCull) {
+				batch.IndirectCommand = static_cast<int32_t>(_indirectCommands.size());
+				batch.Pooled = alloc != nullptr;
+				// GPU culled commands start out empty, the culling shader adds each instance that's visible
+				uint32_t instanceCount = gpuCull ? 0 : batch.Count;
+				if (alloc != nullptr) {
+					_indirectCommands.push_back({ alloc->IndexCount, instanceCount, alloc->FirstIndex, alloc->BaseVertex, static_cast<uint32_t>(batch.BaseInstance) });
+				} else {
+					uint32_t indexCount = first.Mesh->GetElementCount() != 0 ? first.Mesh->GetElementCount() : first.Mesh->GetIndexCount();
+					_indirectCommands.push_back({ indexCount, instanceCount, 0, 0, static_cast<uint32_t>(batch.BaseInstance) });
+				}
+			}
+			for (size_t command = ix; command < end; command++) {
+				const DrawCommand& draw = _drawQueue[command];
+				const DrawTransform& transform = _drawTransforms[draw.Transform];
+				float layer = static_cast<float>(glm::max(draw.Material->GetTextureLayer(), 0));
+				instances.push_back({ transform.Model, transform.NormalMatrix, layer, { }, transform.ObjectLights });
+				if (gpuCull) {
+					_cullBounds.push_back(GpuCuller::MakeBounds(draw.Renderable->GetMeshResource()->Mesh->GetBounds().Box, static_cast<uint32_t>(batch.IndirectCommand)));
+				}
+			}
+		}
+
+		// Materials that discard fragments can't be drawn depth only, so they keep the regular depth test
+		batch.DepthPrepass = _depthPrepass && _GetBatchShader(batch, true) != nullptr;
+
+		// Materials that can't write to the G-buffer (ex: transparent ones) get shaded forward after the lighting pass
+		if (_deferredShading && _GetBatchShader(batch, false)->GetDeferredVariant() != nullptr) {
+			batch.Deferred = true;
+			_renderStats.ObjectsDeferred += batch.Count;
+		}
+
+		_drawBatches.push_back(batch);
+		ix = next;
+	}
+
+	// Upload all the instance data for the frame in one go, re-specifying the buffer
+	// each frame lets the driver hand us fresh memory instead of waiting on last frame's draws
+	if (!_instanceData.empty()) {
+		_instanceBuffer->LoadData(_instanceData.data(), static_cast<uint32_t>(_instanceData.size()));
+	}
+	if (!_indirectCommands.empty()) {
+		_indirectBuffer->LoadData(_indirectCommands.data(), static_cast<uint32_t>(_indirectCommands.size()));
+	}
+
+	// Now that the commands are on the GPU, let the culling shader fill in their instances
+	if (!_cullBounds.empty()) {
+		GpuProfiler::Scope scope("GPU Culling");
+		_gpuCuller->Cull(context.ViewFrustum, _cullInstances.data(), static_cast<uint32_t>(sizeof(InstanceData)), _cullBounds, _indirectBuffer, _instanceBuffer);
+		_renderStats.ObjectsGpuTested = _gpuCuller->GetInstancesTested();
+	}
+
+	// Every draw that isn't instanced needs a block in the ring buffer. These are all written up
+	// front so that the depth pre-pass and the color pass can share them
+	_instanceUniforms->BeginFrame(static_cast<uint32_t>(_drawQueue.size() - _instanceData.size() - _cullInstances.size()));
+	for (const DrawBatch& batch : _drawBatches) {
+		if (batch.BaseInstance >= 0) {
+			continue;
+		}
+		for (size_t ix = batch.FirstCommand; ix < batch.FirstCommand + batch.Count; ix++) {
+			const DrawTransform& transform = _drawTransforms[_drawQueue[ix].Transform];
+
+			InstanceLevelUniforms instanceData;
+			instanceData.u_Model = transform.Model;
+			instanceData.u_ModelViewProjection = transform.ModelViewProjection;
+			instanceData.u_NormalMatrix = transform.NormalMatrix;
+			instanceData.u_TextureLayer = static_cast<float>(glm::max(_drawQueue[ix].Material->GetTextureLayer(), 0));
+			instanceData.u_ObjectLights = transform.ObjectLights;
+			_drawQueue[ix].UniformOffset = _instanceUniforms->Push(instanceData);
 		}
+	}
 
-		// Grab the game object so we can do some stuff with it
-		GameObject* object = renderable->GetGameObject();
+	// Fill the G-buffer and light it, leaving the primary FBO with the lit surfaces and their depth
+	if (_renderStats.ObjectsDeferred > 0) {
+		_RenderDeferred(viewProj);
+	}
+
+	// Lay down depth for everything we can first, so that the color pass only shades the closest surface
+	if (_depthPrepass) {
+		GpuProfiler::Scope scope("Depth Pre-pass");
+		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+		_SubmitBatches(true, false);
+		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	}
 
-		// Use our uniform buffer for our instance level uniforms
-		auto& instanceData = _instanceUniforms->GetData();
-		instanceData.u_Model = object->GetTransform();
-		instanceData.u_ModelViewProjection = viewProj * object->GetTransform();
-		instanceData.u_NormalMatrix = glm::mat3(glm::transpose(glm::inverse(object->GetTransform())));
-		_instanceUniforms->Update();
+	// Render all our objects
+	{
+		GpuProfiler::Scope scope("Objects");
+		_SubmitBatches(false, false);
+	}
 
-		// Draw the object
-		renderable->GetMesh()->Draw();
-	});
+	// The color pass may leave the depth test in GL_EQUAL mode, so put it back for everything after us
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+
+	// Fence off this frame's instance uniforms so we don't overwrite them while the GPU is reading
+	_instanceUniforms->EndFrame();
+
+	// Now that the depth buffer has all our occluders, test the boxes of everything we checked this frame
+	if (_occlusionCulling) {
+		GpuProfiler::Scope scope("Occlusion Queries");
+		_occlusionCuller->IssueQueries(viewProj, camera->GetGameObject()->GetPosition());
+		_renderStats.OcclusionQueries = _occlusionCuller->GetQueriesIssued();
+	}
 
 	// Use our cubemap to draw our skybox
-	app.CurrentScene()->DrawSkybox();
+	{
+		GpuProfiler::Scope scope("Skybox");
+		app.CurrentScene()->DrawSkybox();
+	}
 
 	// Unbind our primary framebuffer so subsequent draw calls do not modify it
 	//_primaryFBO->Unbind();
@@ -159,7 +426,7 @@ void RenderLayer::OnWindowResize(const glm::ivec2& oldSize, const glm::ivec2& ne
 	if (newSize.x * newSize.y == 0) return;
 
 	// Set viewport and resize our primary FBO
-	_primaryFBO->Resize(newSize);
+	_ResizePrimaryFBO(newSize);
 
 	// Update the main camera's projection
 	Application& app = Application::Get();
@@ -188,16 +455,506 @@ void RenderLayer::OnAppLoad(const nlohmann::json& config)
 
 	// Create the primary FBO
 	_primaryFBO = std::make_shared<Framebuffer>(fboDescriptor);
+	_targetPool = std::make_shared<RenderTargetPool>();
 
 	// Create our common uniform buffers
 	_frameUniforms = std::make_shared<UniformBuffer<FrameLevelUniforms>>(BufferUsage::DynamicDraw);
-	_instanceUniforms = std::make_shared<UniformBuffer<InstanceLevelUniforms>>(BufferUsage::DynamicDraw);
+	_instanceUniforms = std::make_shared<UniformRingBuffer>(static_cast<uint32_t>(sizeof(InstanceLevelUniforms)));
+	_instanceUniforms->SetDebugName("Instance Uniforms");
+
+	// Buffer for per-instance data when batching draws, it will grow as needed
+	_instanceBuffer = VertexBuffer::Create(BufferUsage::DynamicDraw);
+	_instanceBuffer->SetDebugName("Render Instances");
+
+	// Most of our meshes are loaded from OBJs, so the pool uses the same layout as the OBJ loader
+	_geometryPool = std::make_shared<GeometryPool>(VertexPosNormTexColTangents::V_DECL, static_cast<uint32_t>(sizeof(VertexPosNormTexColTangents)));
+	_indirectBuffer = IndirectBuffer::Create(BufferUsage::DynamicDraw);
+	_indirectBuffer->SetDebugName("Render Indirect Commands");
+
+	_occlusionCuller = std::make_shared<OcclusionCuller>();
+	_gpuCuller = std::make_shared<GpuCuller>();
+	_lightClusters = std::make_shared<ClusteredLighting>();
+
+	// Lights the G-buffer when using deferred shading, the G-buffer itself is only created once it's needed
+	_deferredLightingShader = ShaderProgram::Create();
+	_deferredLightingShader->LoadShaderPartFromFile("shaders/vertex_shaders/fullscreen_triangle.glsl", ShaderPartType::Vertex);
+	_deferredLightingShader->LoadShaderPartFromFile("shaders/fragment_shaders/deferred_lighting.glsl", ShaderPartType::Fragment);
+	_deferredLightingShader->Link();
+	_deferredLightingShader->SetDebugName("Deferred Lighting");
+
+	_fullscreenTriangle = VertexArrayObject::Create();
+	_fullscreenTriangle->SetDebugName("Deferred Lighting Triangle");
+
+	_extractPool = std::make_unique<ThreadPool>();
+
+	// Our settings are under our name in the app config, see GetDefaultConfig
+	if (config.contains(Name)) {
+		_depthPrepass = JsonGet(config[Name], "depth_prepass", _depthPrepass);
+		_lodSelection = JsonGet(config[Name], "mesh_lods", _lodSelection);
+		_pvsCulling = JsonGet(config[Name], "pvs_culling", _pvsCulling);
+		_gpuCulling = JsonGet(config[Name], "gpu_culling", _gpuCulling);
+		SetPerObjectLightsEnabled(JsonGet(config[Name], "per_object_lights", _perObjectLights));
+		_deferredShading = JsonGet(config[Name], "deferred_shading", _deferredShading);
+		_parallelExtract = JsonGet(config[Name], "parallel_extract", _parallelExtract);
+		_dynamicResolution = JsonGet(config[Name], "dynamic_resolution", _dynamicResolution);
+		_targetFrameTime = JsonGet(config[Name], "target_frame_time", _targetFrameTime);
+		SetResolutionScaleBounds(JsonGet(config[Name], "min_resolution_scale", _minResolutionScale), JsonGet(config[Name], "max_resolution_scale", _maxResolutionScale));
+		_upscaleFilter = JsonParseEnum(UpscaleFilter, config[Name], "upscale_filter", _upscaleFilter);
+	}
+}
+
+nlohmann::json RenderLayer::GetDefaultConfig()
+{
+	return {
+		{ "depth_prepass", false },
+		{ "mesh_lods", true },
+		{ "pvs_culling", true },
+		{ "gpu_culling", false },
+		{ "per_object_lights", false },
+		{ "deferred_shading", false },
+		{ "parallel_extract", true },
+		{ "dynamic_resolution", false },
+		{ "target_frame_time", 16.6f },
+		{ "min_resolution_scale", 0.5f },
+		{ "max_resolution_scale", 1.0f },
+		{ "upscale_filter", ~UpscaleFilter::Linear }
+	};
+}
+
+void RenderLayer::_UpdateResolutionScale()
+{
+	// The application times each layer's OnRender under the layer's name, so our GPU time comes from the
+	// profiler. Results come back a few frames late, and only frames the GPU finished in time have one
+	const GpuProfiler::ScopeStats* gpuTime = GpuProfiler::Get().GetScope(Name);
+	if (gpuTime != nullptr && gpuTime->Version != _gpuTimeVersion) {
+		_gpuTimeVersion = gpuTime->Version;
+		_gpuFrameTime = gpuTime->Last;
+		_smoothedFrameTime = glm::mix(_smoothedFrameTime, _gpuFrameTime, FRAME_TIME_SMOOTHING);
+	}
+
+	float scale = 1.0f;
+	if (_dynamicResolution) {
+		scale = _resolutionScale;
+		if (_resolutionCooldown > 0) {
+			_resolutionCooldown--;
+		}
+		// Only react when we're over budget, or comfortably under it, so we don't flip back and forth
+		else if (_smoothedFrameTime > _targetFrameTime || _smoothedFrameTime < _targetFrameTime * (1.0f - RESOLUTION_HYSTERESIS)) {
+			// Most of our GPU time goes with the number of pixels, which goes with the square of the scale
+			float desired = _resolutionScale * glm::sqrt(_targetFrameTime / glm::max(_smoothedFrameTime, 0.01f));
+			desired = glm::clamp(desired, _resolutionScale - MAX_RESOLUTION_CHANGE, _resolutionScale + MAX_RESOLUTION_CHANGE);
+			scale = glm::round(desired / RESOLUTION_SCALE_STEP) * RESOLUTION_SCALE_STEP;
+		}
+		scale = glm::clamp(scale, _minResolutionScale, _maxResolutionScale);
+	}
+
+	if (scale != _resolutionScale) {
+		_resolutionScale = scale;
+		_resolutionCooldown = RESOLUTION_COOLDOWN_FRAMES;
+		_ResizePrimaryFBO(Application::Get().GetWindowSize());
+	}
+}
+
+void RenderLayer::_ResizePrimaryFBO(const glm::ivec2& windowSize)
+{
+	glm::ivec2 size = glm::max(glm::ivec2(glm::round(glm::vec2(windowSize) * _resolutionScale)), glm::ivec2(1));
+	_primaryFBO->Resize(size);
+	if (_gBuffer != nullptr) {
+		_gBuffer->Resize(size);
+	}
+}
+
+void RenderLayer::_ExtractDraws(const ExtractContext& context, size_t first, size_t end, ExtractBuffer& buffer)
+{
+	buffer.Draws.clear();
+	buffer.Culled = 0;
+	buffer.PvsCulled = 0;
+	buffer.ObjectLights = 0;
+
+	for (size_t ix = first; ix < end; ix++) {
+		RenderComponent* renderable = _renderables[ix];
+
+		// Chunks the camera's view cell can't see are dropped before anything else looks at them
+		if (!_pvsHidden.empty() && _pvsHidden.count(renderable) != 0) {
+			buffer.PvsCulled++;
+			continue;
+		}
+
+		// Early bail if mesh not set
+		VertexArrayObject* mesh = renderable->GetMeshResource() != nullptr ? renderable->GetMeshResource()->Mesh.get() : nullptr;
+		if (mesh == nullptr) {
+			continue;
+		}
+
+		// If we don't have a material, try getting the scene's fallback material
+		// If none exists, do not draw anything
+		if (renderable->GetMaterial() == nullptr) {
+			if (context.DefaultMaterial != nullptr) {
+				renderable->SetMaterial(context.DefaultMaterial);
+			} else {
+				continue;
+			}
+		}
+
+		// Static batches are already in world space, and don't have an object to get a transform from
+		Gameplay::GameObject* object = renderable->GetGameObject();
+		const glm::mat4 transform = object != nullptr ? object->GetTransform() : glm::mat4(1.0f);
+
+		// Skip anything that is entirely outside of the camera's view. With GPU culling this waits until we
+		// know which draws the GPU can't cull for us, see OnRender
+		const MeshBounds& bounds = mesh->GetBounds();
+		if (_frustumCulling && !_gpuCulling && !_IsInFrustum(context.ViewFrustum, bounds, transform)) {
+			buffer.Culled++;
+			continue;
+		}
+
+		// View space looks down -Z, so negate to get the distance in front of the camera
+		float viewDepth = -(context.View * transform[3]).z;
+
+		// Pick a detail level from how big the object's bounding sphere is on screen
+		const Gameplay::MeshResource::Sptr& meshResource = renderable->GetMeshResource();
+		if (meshResource->GetLodCount() > 1) {
+			int level = 0;
+			if (_lodSelection && bounds.Box.IsValid()) {
+				BoundingSphere sphere = bounds.Sphere.Transform(transform);
+				float screenSize = sphere.Radius * context.ProjectionScale;
+				if (!context.Orthographic) {
+					screenSize /= glm::max(-(context.View * glm::vec4(sphere.Center, 1.0f)).z, context.NearPlane);
+				}
+				level = _SelectLod(renderable->GetLodLevel(), meshResource->GetLodCount(), screenSize);
+			}
+			renderable->SetLodLevel(level);
+			mesh = meshResource->GetLod(level).get();
+		}
+
+		ExtractedDraw& draw = buffer.Draws.emplace_back();
+		draw.Command ={
+			_MakeSortKey(renderable, viewDepth),
+			renderable,
+			renderable->GetMaterial().get(),
+			mesh,
+			0,
+			0,
+			0
+		};
+		draw.Transform.Model = transform;
+		draw.Transform.ModelViewProjection = context.ViewProjection * transform;
+		draw.Transform.NormalMatrix = object != nullptr ? glm::mat4(object->GetNormalMatrix()) : glm::mat4(1.0f);
+
+		// Pick the lights for the object against it's bounding sphere, the light list was built for this frame before extraction
+		draw.Transform.ObjectLights = glm::vec4(-1.0f);
+		if (_perObjectLights) {
+			BoundingSphere sphere;
+			if (bounds.Box.IsValid()) {
+				sphere = bounds.Sphere.Transform(transform);
+			} else {
+				sphere.Center = glm::vec3(transform[3]);
+			}
+			buffer.ObjectLights += _lightClusters->SelectObjectLights(sphere, draw.Transform.ObjectLights);
+		}
+
+		// Big objects get tested against last frame's occlusion queries once we're back on the GL thread
+		draw.TestOcclusion = _occlusionCulling && bounds.Box.IsValid() && bounds.Sphere.Transform(transform).Radius >= MIN_OCCLUDEE_RADIUS;
+		if (draw.TestOcclusion) {
+			draw.WorldBox = bounds.Box.Transform(transform);
+		}
+	}
+}
+
+void RenderLayer::_RenderDeferred(const glm::mat4& viewProj)
+{
+	// The G-buffer matches the primary FBO, so the depth can be copied straight across
+	if (_gBuffer == nullptr) {
+		FramebufferDescriptor descriptor;
+		descriptor.Width = _primaryFBO->GetWidth();
+		descriptor.Height = _primaryFBO->GetHeight();
+		descriptor.RenderTargets[RenderTargetAttachment::Color0] ={ true, RenderTargetType::ColorRgba8 };
+		descriptor.RenderTargets[RenderTargetAttachment::Color1] ={ true, RenderTargetType::ColorRgba16F };
+		descriptor.RenderTargets[RenderTargetAttachment::Color2] ={ true, RenderTargetType::ColorRgba16F };
+		descriptor.RenderTargets[RenderTargetAttachment::DepthStencil] ={ true, RenderTargetType::DepthStencil };
+		_gBuffer = std::make_shared<Framebuffer>(descriptor);
+		_gBuffer->SetDebugName("G-Buffer");
+	}
+
+	_gBuffer->Bind();
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	if (_depthPrepass) {
+		GpuProfiler::Scope scope("G-Buffer Depth Pre-pass");
+		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+		_SubmitBatches(true, true);
+		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	}
+
+	{
+		GpuProfiler::Scope scope("G-Buffer");
+		_SubmitBatches(false, true);
+	}
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+
+	// The forward batches need to be depth tested against the deferred ones
+	Framebuffer::Blit(_gBuffer, _primaryFBO, BufferFlags::Depth, MagFilter::Nearest);
+	_primaryFBO->Bind();
+
+	// Shade every pixel that was written to the G-buffer, the rest keeps the clear color
+	const ShaderProgram::Sptr& variant = _deferredLightingShader->GetVariant(_shaderDefines);
+	const ShaderProgram::Sptr& shader = variant != nullptr ? variant : _deferredLightingShader;
+	{
+		GpuProfiler::Scope scope("Deferred Lighting");
+		glDisable(GL_DEPTH_TEST);
+		glDepthMask(GL_FALSE);
+
+		shader->Bind();
+		shader->SetUniformMatrix("u_InverseViewProjection", glm::inverse(viewProj));
+		_gBuffer->BindAttachment(RenderTargetAttachment::Color0, 0);
+		_gBuffer->BindAttachment(RenderTargetAttachment::Color1, 1);
+		_gBuffer->BindAttachment(RenderTargetAttachment::Color2, 2);
+		_gBuffer->BindAttachment(RenderTargetAttachment::DepthStencil, 3);
+
+		_fullscreenTriangle->Bind();
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		VertexArrayObject::Unbind();
+		_renderStats.DrawCalls++;
+
+		glDepthMask(GL_TRUE);
+		glEnable(GL_DEPTH_TEST);
+	}
+}
+
+void RenderLayer::_SubmitBatches(bool depthOnly, bool deferred)
+{
+	using namespace Gameplay;
+
+	// The current shader and material that are bound for rendering
+	const ShaderProgram* shader = nullptr;
+	const Material* currentMat = nullptr;
+	// Whether the depth test is currently set up for batches that were in the pre-pass
+	bool depthEqual = false;
+
+	for (size_t batchIx = 0; batchIx < _drawBatches.size(); batchIx++) {
+		const DrawBatch& batch = _drawBatches[batchIx];
+		if ((depthOnly && !batch.DepthPrepass) || batch.Deferred != deferred) {
+			continue;
+		}
+
+		const DrawCommand& first = _drawQueue[batch.FirstCommand];
+		const Material::Sptr& material = first.Renderable->GetMaterial();
+
+		// Batches from the pre-pass already have their depth, so we only need to shade the fragments
+		// that match it. Everything else still needs the regular depth test
+		if (!depthOnly && batch.DepthPrepass != depthEqual) {
+			depthEqual = batch.DepthPrepass;
+			glDepthFunc(depthEqual ? GL_EQUAL : GL_LESS);
+			glDepthMask(depthEqual ? GL_FALSE : GL_TRUE);
+		}
+
+		// Only switch programs when the shader actually changes, since the queue is sorted by
+		// shader first this will happen about once per shader
+		const ShaderProgram::Sptr& batchShader = _GetBatchShader(batch, depthOnly);
+		if (batchShader.get() != shader) {
+			shader = batchShader.get();
+			shader->Bind();
+			currentMat = nullptr;
+		}
+
+		// If the material has changed, we need to set up our material data. Materials that only
+		// differ by texture array layer share a batch ID, so they only get applied once
+		if (currentMat == nullptr || material->GetBatchId() != currentMat->GetBatchId()) {
+			currentMat = material.get();
+			material->Apply(batchShader);
+		}
+
+		// Pooled batches are consecutive in the indirect buffer, and sorting keeps a material's
+		// batches together, so we can draw every pooled mesh for this material in one call
+		if (batch.IndirectCommand >= 0) {
+			uint32_t commandCount = 1;
+			while (batch.Pooled && batchIx + 1 < _drawBatches.size() &&
+				   _drawBatches[batchIx + 1].Pooled &&
+				   _drawQueue[_drawBatches[batchIx + 1].FirstCommand].Material->GetBatchId() == first.Material->GetBatchId()) {
+				batchIx++;
+				commandCount++;
+			}
+
+			// GPU culled batches that aren't pooled draw from their own mesh, with the command the culling shader filled in
+			_indirectBuffer->Bind();
+			_GetInstancedMesh(batch.Pooled ? _geometryPool->GetVao() : first.Renderable->GetLodMesh())->MultiDrawIndirect(commandCount, batch.IndirectCommand);
+			_renderStats.DrawCalls++;
+			continue;
+		}
+
+		// Instanced batches are a single draw, the transforms come from the instance buffer
+		if (batch.BaseInstance >= 0) {
+			_GetInstancedMesh(first.Renderable->GetLodMesh())->DrawInstanced(batch.Count, DrawMode::TriangleList, batch.BaseInstance);
+			_renderStats.DrawCalls++;
+			continue;
+		}
+
+		for (size_t ix = batch.FirstCommand; ix < batch.FirstCommand + batch.Count; ix++) {
+			// Point the instance UBO at the uniforms we wrote for this draw
+			_instanceUniforms->BindRange(INSTANCE_UBO_BINDING, _drawQueue[ix].UniformOffset);
+
+			// Draw the object, if the occlusion query isn't done the GPU will skip it if it comes back empty
+			GLuint condition = _drawQueue[ix].Condition;
+			if (condition != 0) {
+				glBeginConditionalRender(condition, GL_QUERY_NO_WAIT);
+			}
+			_drawQueue[ix].Mesh->Draw();
+			if (condition != 0) {
+				glEndConditionalRender();
+			}
+			_renderStats.DrawCalls++;
+		}
+	}
+}
+
+const ShaderProgram::Sptr& RenderLayer::_GetBatchShader(const DrawBatch& batch, bool depthOnly) const
+{
+	const ShaderProgram::Sptr& shader = _GetFlagVariant(_drawQueue[batch.FirstCommand].Material);
+	const ShaderProgram::Sptr& variant = batch.BaseInstance >= 0 ? shader->GetInstancedVariant() : shader;
+	if (depthOnly) {
+		return variant->GetDepthOnlyVariant();
+	}
+	return batch.Deferred ? variant->GetDeferredVariant() : variant;
+}
+
+const ShaderProgram::Sptr& RenderLayer::_GetFlagVariant(const Gameplay::Material* material) const
+{
+	const ShaderProgram::Sptr& shader = material->GetShader();
+	const ShaderProgram::Sptr& variant = shader->GetVariant(material->GetTextureLayer() >= 0 ? _textureArrayDefines : _shaderDefines);
+	return variant != nullptr ? variant : shader;
+}
+
+const VertexArrayObject::Sptr& RenderLayer::_GetInstancedMesh(const VertexArrayObject::Sptr& mesh)
+{
+	auto it = _instancedMeshes.find(mesh.get());
+	if (it != _instancedMeshes.end() && it->second.Source.lock() == mesh) {
+		return it->second.Mesh;
+	}
+
+	// Drop copies of any meshes that have been deleted since we last looked
+	for (auto cached = _instancedMeshes.begin(); cached != _instancedMeshes.end(); ) {
+		cached = cached->second.Source.expired() ? _instancedMeshes.erase(cached) : std::next(cached);
+	}
+
+	// Per-instance transforms, matching the INSTANCED inputs in vs_common.glsl
+	static const std::vector<BufferAttribute> instanceAttribs ={
+		BufferAttribute(8,  4, AttributeType::Float, sizeof(InstanceData), 0,                 AttribUsage::User0),
+		BufferAttribute(9,  4, AttributeType::Float, sizeof(InstanceData), 4 * sizeof(float),  AttribUsage::User0),
+		BufferAttribute(10, 4, AttributeType::Float, sizeof(InstanceData), 8 * sizeof(float),  AttribUsage::User0),
+		BufferAttribute(11, 4, AttributeType::Float, sizeof(InstanceData), 12 * sizeof(float), AttribUsage::User0),
+
+		BufferAttribute(12, 3, AttributeType::Float, sizeof(InstanceData), 16 * sizeof(float), AttribUsage::User0),
+		BufferAttribute(13, 3, AttributeType::Float, sizeof(InstanceData), 20 * sizeof(float), AttribUsage::User0),
+		BufferAttribute(14, 3, AttributeType::Float, sizeof(InstanceData), 24 * sizeof(float), AttribUsage::User0),
+
+		BufferAttribute(15, 1, AttributeType::Float, sizeof(InstanceData), 32 * sizeof(float), AttribUsage::User0),
+
+		BufferAttribute(7,  4, AttributeType::Float, sizeof(InstanceData), 36 * sizeof(float), AttribUsage::User0),
+	};
+
+	// The copy shares the mesh's buffers, so it stays in sync with the original
+	InstancedMesh& result = _instancedMeshes[mesh.get()];
+	result.Source = mesh;
+	result.Mesh = mesh->Clone();
+	result.Mesh->AddVertexBuffer(_instanceBuffer, instanceAttribs, true);
+	return result.Mesh;
+}
+
+bool RenderLayer::_IsInFrustum(const Frustum& frustum, const MeshBounds& bounds, const glm::mat4& transform)
+{
+	// Meshes without bounds are always drawn
+	if (!bounds.Box.IsValid()) {
+		return true;
+	}
+	// The sphere test is cheap and rejects most objects, the box test catches long thin meshes
+	return frustum.Intersects(bounds.Sphere.Transform(transform)) && frustum.Intersects(bounds.Box.Transform(transform));
+}
+
+int RenderLayer::_SelectLod(int current, int lodCount, float screenSize) const
+{
+	// Meshes with more LODs than we have thresholds for keep using the last threshold
+	const int thresholdCount = static_cast<int>(sizeof(LOD_SCREEN_SIZES) / sizeof(float));
+	auto threshold = [&](int level) { return LOD_SCREEN_SIZES[glm::min(level, thresholdCount - 1)]; };
+
+	int level = glm::clamp(current, 0, lodCount - 1);
+	while (level < lodCount - 1 && screenSize < threshold(level) * (1.0f - LOD_HYSTERESIS)) {
+		level++;
+	}
+	while (level > 0 && screenSize > threshold(level - 1) * (1.0f + LOD_HYSTERESIS)) {
+		level--;
+	}
+	return level;
+}
+
+uint64_t RenderLayer::_MakeSortKey(const RenderComponent* renderable, float viewDepth)
+{
+	const Gameplay::Material::Sptr& material = renderable->GetMaterial();
+
+	// Key layout, from most to least significant:
+	// [63-52] shader handle, [51-40] material batch ID, [39-24] VAO handle, [23-0] depth
+	// IDs wider than their fields will simply wrap, which only costs us some extra state changes
+	uint64_t shaderId   = material->GetShader() != nullptr ? material->GetShader()->GetHandle() : 0;
+	uint64_t materialId = material->GetBatchId();
+	uint64_t meshId     = renderable->GetLodMesh()->GetHandle();
+
+	// Positive floats sort the same as their bit patterns, so we can take the top
+	// 24 bits of the depth to get a front-to-back ordering without knowing the far plane
+	float depth = glm::max(viewDepth, 0.0f);
+	uint32_t depthBits;
+	memcpy(&depthBits, &depth, sizeof(float));
+	uint64_t depthKey = depthBits >> 8;
+
+	return
+		((shaderId   & 0xFFF)  << 52) |
+		((materialId & 0xFFF)  << 40) |
+		((meshId     & 0xFFFF) << 24) |
+		 (depthKey   & 0xFFFFFF);
+}
+
+void RenderLayer::_SortDrawQueue()
+{
+	// Small queues aren't worth the fixed cost of the radix passes
+	if (_drawQueue.size() < 2) {
+		return;
+	}
+
+	_drawQueueScratch.resize(_drawQueue.size());
+
+	// LSD radix sort, 8 bits per pass. Each pass is stable, so after the final pass
+	// the queue is ordered by the full 64 bit key
+	for (int shift = 0; shift < 64; shift += 8) {
+		size_t counts[257] ={ 0 };
+		for (const DrawCommand& command : _drawQueue) {
+			counts[((command.SortKey >> shift) & 0xFF) + 1]++;
+		}
+
+		// If every key has the same byte here, this pass won't change anything
+		if (counts[((_drawQueue[0].SortKey >> shift) & 0xFF) + 1] == _drawQueue.size()) {
+			continue;
+		}
+
+		// Prefix sum to turn the counts into output offsets
+		for (int ix = 1; ix < 257; ix++) {
+			counts[ix] += counts[ix - 1];
+		}
+
+		for (const DrawCommand& command : _drawQueue) {
+			_drawQueueScratch[counts[(command.SortKey >> shift) & 0xFF]++] = command;
+		}
+		_drawQueue.swap(_drawQueueScratch);
+	}
 }
 
 const Framebuffer::Sptr& RenderLayer::GetPrimaryFBO() const {
 	return _primaryFBO;
 }
 
+const RenderTargetPool::Sptr& RenderLayer::GetRenderTargetPool() const {
+	return _targetPool;
+}
+
 bool RenderLayer::IsBlitEnabled() const {
 	return _blitFbo;
 }
@@ -218,10 +975,147 @@ void RenderLayer::SetClearColor(const glm::vec4 & value) {
 	_clearColor = value;
 }
 
+bool RenderLayer::IsFrustumCullingEnabled() const {
+	return _frustumCulling;
+}
+
+void RenderLayer::SetFrustumCullingEnabled(bool value) {
+	_frustumCulling = value;
+}
+
+bool RenderLayer::IsGpuCullingEnabled() const {
+	return _gpuCulling;
+}
+
+void RenderLayer::SetGpuCullingEnabled(bool value) {
+	_gpuCulling = value;
+}
+
+bool RenderLayer::IsGeometryPoolEnabled() const {
+	return _geometryPoolEnabled;
+}
+
+void RenderLayer::SetGeometryPoolEnabled(bool value) {
+	_geometryPoolEnabled = value;
+}
+
+bool RenderLayer::IsOcclusionCullingEnabled() const {
+	return _occlusionCulling;
+}
+
+void RenderLayer::SetOcclusionCullingEnabled(bool value) {
+	_occlusionCulling = value;
+}
+
+bool RenderLayer::IsDepthPrepassEnabled() const {
+	return _depthPrepass;
+}
+
+void RenderLayer::SetDepthPrepassEnabled(bool value) {
+	_depthPrepass = value;
+}
+
+bool RenderLayer::IsPvsCullingEnabled() const {
+	return _pvsCulling;
+}
+
+void RenderLayer::SetPvsCullingEnabled(bool value) {
+	_pvsCulling = value;
+}
+
+bool RenderLayer::IsPerObjectLightsEnabled() const {
+	return _perObjectLights;
+}
+
+void RenderLayer::SetPerObjectLightsEnabled(bool value) {
+	_perObjectLights = value;
+	_UpdateShaderDefines();
+}
+
+bool RenderLayer::IsDeferredShadingEnabled() const {
+	return _deferredShading;
+}
+
+void RenderLayer::SetDeferredShadingEnabled(bool value) {
+	_deferredShading = value;
+	// The G-buffer is a lot of memory to keep around, we'll make a new one if we're turned back on
+	if (!_deferredShading) {
+		_gBuffer = nullptr;
+	}
+}
+
+bool RenderLayer::IsLodSelectionEnabled() const {
+	return _lodSelection;
+}
+
+void RenderLayer::SetLodSelectionEnabled(bool value) {
+	_lodSelection = value;
+}
+
+bool RenderLayer::IsDynamicResolutionEnabled() const {
+	return _dynamicResolution;
+}
+
+void RenderLayer::SetDynamicResolutionEnabled(bool value) {
+	_dynamicResolution = value;
+}
+
+float RenderLayer::GetTargetFrameTime() const {
+	return _targetFrameTime;
+}
+
+void RenderLayer::SetTargetFrameTime(float value) {
+	_targetFrameTime = glm::max(value, 0.1f);
+}
+
+void RenderLayer::SetResolutionScaleBounds(float min, float max) {
+	_minResolutionScale = glm::clamp(min, 0.1f, 1.0f);
+	_maxResolutionScale = glm::clamp(max, _minResolutionScale, 1.0f);
+}
+
+float RenderLayer::GetResolutionScale() const {
+	return _resolutionScale;
+}
+
+float RenderLayer::GetGpuFrameTime() const {
+	return _gpuFrameTime;
+}
+
+UpscaleFilter RenderLayer::GetUpscaleFilter() const {
+	return _upscaleFilter;
+}
+
+void RenderLayer::SetUpscaleFilter(UpscaleFilter value) {
+	_upscaleFilter = value;
+}
+
+bool RenderLayer::IsParallelExtractEnabled() const {
+	return _parallelExtract;
+}
+
+void RenderLayer::SetParallelExtractEnabled(bool value) {
+	_parallelExtract = value;
+}
+
+const RenderLayer::RenderStats& RenderLayer::GetRenderStats() const {
+	return _renderStats;
+}
+
 void RenderLayer::SetRenderFlags(RenderFlags value) {
 	_renderFlags = value;
+	_UpdateShaderDefines();
 }
 
 RenderFlags RenderLayer::GetRenderFlags() const {
 	return _renderFlags;
 }
+
+void RenderLayer::_UpdateShaderDefines() {
+	// Unsigned suffix so the value has the same type as the flags in the shader
+	_shaderDefines ={ "STATIC_RENDER_FLAGS " + std::to_string(*_renderFlags) + "u" };
+	if (_perObjectLights) {
+		_shaderDefines.push_back("PER_OBJECT_LIGHTS");
+	}
+	_textureArrayDefines = _shaderDefines;
+	_textureArrayDefines.push_back(Gameplay::Material::TEXTURE_ARRAY_DEFINE);
+}
@@ -1,7 +1,23 @@
 #pragma once
 #include "../ApplicationLayer.h"
 #include "Graphics/Framebuffer.h"
+#include "Graphics/RenderTargetPool.h"
 #include "Graphics/Buffers/UniformBuffer.h"
+#include "Graphics/Buffers/UniformRingBuffer.h"
+#include "Graphics/Buffers/IndirectBuffer.h"
+#include "Graphics/VertexArrayObject.h"
+#include "Graphics/GeometryPool.h"
+#include "Graphics/OcclusionCuller.h"
+#include "Graphics/GpuCuller.h"
+#include "Graphics/ClusteredLighting.h"
+#include "Graphics/BoundingVolume.h"
+#include "Utils/ThreadPool.h"
+#include <unordered_set>
+
+class RenderComponent;
+namespace Gameplay {
+	class Material;
+}
 
 ENUM_FLAGS(RenderFlags, uint32_t,
 	None = 0,
@@ -17,6 +33,16 @@ ENUM_FLAGS(RenderFlags, uint32_t,
 	Diffuse = 1 << 9
 );
 
+/// <summary>
+/// How the render layer's output gets scaled up to the window when rendering below the window's
+/// resolution, see RenderLayer::IsDynamicResolutionEnabled
+/// </summary>
+ENUM(UpscaleFilter, uint32_t,
+	Nearest = 0,
+	Linear  = 1,
+	Sharpen = 2
+);
+
 class RenderLayer final : public ApplicationLayer {
 public:
 	MAKE_PTRS(RenderLayer); 
@@ -43,7 +69,7 @@ public:
 
 	// Structure for our instance-level uniforms, matches layout from
 	// fragments/frame_uniforms.glsl
-	// For use with a UBO.
+	// Written once per draw into a ring buffer, see _instanceUniforms
 	struct InstanceLevelUniforms {
 		// Complete MVP
 		glm::mat4 u_ModelViewProjection;
@@ -51,6 +77,106 @@ public:
 		glm::mat4 u_Model;
 		// Normal Matrix for transforming normals
 		glm::mat4 u_NormalMatrix;
+		// Layer of the material's texture array, padded out to a vec4 like std140 does
+		float     u_TextureLayer;
+		float     _padding[3];
+		// Indices of the lights picked for the object, see IsPerObjectLightsEnabled
+		glm::vec4 u_ObjectLights;
+	};
+
+	// Per-instance data for batched draws, matches the INSTANCED attributes
+	// in fragments/vs_common.glsl
+	struct InstanceData {
+		// The model transform of the instance
+		glm::mat4 Model;
+		// Normal matrix, only the upper 3x3 is used but we keep the columns vec4 aligned
+		glm::mat4 NormalMatrix;
+		// Layer of the material's texture array, lets materials that only differ by layer share a batch
+		float     TextureLayer;
+		float     _padding[3];
+		// Indices of the lights picked for the instance, stored as floats since our attributes are all float
+		glm::vec4 ObjectLights;
+	};
+
+	// A single entry in the render queue, sorted by key before submission
+	// Pointers are only valid for the frame the command was queued in
+	struct DrawCommand {
+		// Packed shader | material | mesh | depth key, see _MakeSortKey
+		uint64_t            SortKey;
+		// The component to draw
+		RenderComponent*    Renderable;
+		// Cached from the renderable so we can compare without touching ref counts
+		Gameplay::Material* Material;
+		VertexArrayObject*  Mesh;
+		// Occlusion query to draw the command under with conditional rendering, or 0 for none
+		GLuint              Condition;
+		// Offset of the draw's block in the instance uniform ring, unused for instanced draws
+		uint32_t            UniformOffset;
+		// Index of the draw's matrices in _drawTransforms, kept out of the command so sorting stays cheap
+		uint32_t            Transform;
+	};
+
+	// The matrices for a draw, calculated during extraction so the GL thread only has to copy them
+	struct DrawTransform {
+		glm::mat4 Model;
+		glm::mat4 ModelViewProjection;
+		// Normal matrix, only the upper 3x3 is used but we keep the columns vec4 aligned
+		glm::mat4 NormalMatrix;
+		// The lights picked for the object, -1 for unused slots
+		glm::vec4 ObjectLights;
+	};
+
+	// A run of sorted draws that share a mesh and material
+	struct DrawBatch {
+		// Index of the first command in the draw queue
+		size_t   FirstCommand;
+		// Number of commands in the batch
+		uint32_t Count;
+		// Offset of the batch in the instance buffer, or -1 if it is drawn without instancing
+		int32_t  BaseInstance;
+		// Index of the batch's command in the indirect buffer, or -1 if it is drawn directly
+		int32_t  IndirectCommand;
+		// True if the batch's mesh is in the geometry pool, so it's indirect command draws from the pool's VAO
+		bool     Pooled;
+		// True if the batch's instances are frustum culled on the GPU, which fills in it's indirect command
+		bool     GpuCulled;
+		// True if the batch is drawn in the depth pre-pass, and shaded with GL_EQUAL in the color pass
+		bool     DepthPrepass;
+		// True if the batch is drawn to the G-buffer and lit by the deferred lighting pass
+		bool     Deferred;
+	};
+
+	// Counters for the most recent frame, useful for checking how effective culling and batching are
+	struct RenderStats {
+		// Objects that the scene's spatial tree found in the view frustum (or every object with frustum culling off)
+		uint32_t ObjectsVisited = 0;
+		// Objects that made it into the render queue
+		uint32_t ObjectsDrawn = 0;
+		// Objects that were rejected by frustum culling
+		uint32_t ObjectsCulled = 0;
+		// Static chunks that the scene's potentially visible set says can't be seen from the camera's cell
+		uint32_t ObjectsPvsCulled = 0;
+		// Objects that were skipped because last frame's occlusion query found them hidden
+		uint32_t ObjectsOccluded = 0;
+		// Objects drawn with conditional rendering since their query result wasn't ready
+		uint32_t ObjectsConditional = 0;
+		// The number of occlusion queries issued
+		uint32_t OcclusionQueries = 0;
+		// The number of draw calls issued for the render queue
+		uint32_t DrawCalls = 0;
+		// The number of lights sent to the GPU
+		uint32_t Lights = 0;
+		// The total number of lights across all light clusters
+		uint32_t LightClusterEntries = 0;
+		// The total number of lights picked for objects that made it through culling, when using per-object lights
+		uint32_t ObjectLightEntries = 0;
+		// Objects drawn with one of their mesh's lower detail LODs
+		uint32_t ObjectsReducedLod = 0;
+		// Objects that were drawn to the G-buffer, when using deferred shading
+		uint32_t ObjectsDeferred = 0;
+		// Objects that were sent to the GPU to be frustum culled, these are included in ObjectsDrawn since
+		// the CPU never finds out which of them were visible
+		uint32_t ObjectsGpuTested = 0;
 	};
 
 	RenderLayer();
@@ -60,6 +186,11 @@ public:
 	/// Gets the primary framebuffer that is being rendered to
 	/// </summary>
 	const Framebuffer::Sptr& GetPrimaryFBO() const;
+	/// <summary>
+	/// Gets the pool that passes running after the scene has been drawn (ex: post processing) should
+	/// get their intermediate render targets from. The pool starts a new frame at the start of OnRender
+	/// </summary>
+	const RenderTargetPool::Sptr& GetRenderTargetPool() const;
 
 	bool IsBlitEnabled() const;
 	void SetBlitEnabled(bool value);
@@ -67,25 +198,360 @@ public:
 	const glm::vec4& GetClearColor() const;
 	void SetClearColor(const glm::vec4& value);
 
+	/// <summary>
+	/// Sets the render flags, objects in the render queue are drawn with shader variants that have
+	/// the flags compiled in as STATIC_RENDER_FLAGS (see frame_uniforms.glsl). Variants are compiled
+	/// the first time each set of flags is used
+	/// </summary>
 	void SetRenderFlags(RenderFlags value);
 	RenderFlags GetRenderFlags() const;
 
+	bool IsFrustumCullingEnabled() const;
+	void SetFrustumCullingEnabled(bool value);
+
+	/// <summary>
+	/// When enabled along with frustum culling, objects that can be drawn instanced from an indexed mesh skip
+	/// the CPU's frustum tests. Instead each of their batches gets an indirect command, and a compute shader
+	/// tests every instance against the frustum and fills in the commands (see GpuCuller). Anything that can't
+	/// be drawn that way (ex: shaders without an instanced variant) is still culled on the CPU
+	/// Can be set with "gpu_culling" in the Rendering section of the app settings
+	/// </summary>
+	bool IsGpuCullingEnabled() const;
+	void SetGpuCullingEnabled(bool value);
+
+	/// <summary>
+	/// When enabled and the scene has a baked potentially visible set, static chunks that can't be seen
+	/// from the camera's view cell are skipped before any other culling
+	/// Can be set with "pvs_culling" in the Rendering section of the app settings
+	/// </summary>
+	bool IsPvsCullingEnabled() const;
+	void SetPvsCullingEnabled(bool value);
+
+	/// <summary>
+	/// When enabled, the few brightest lights around each object are picked on the CPU and passed along
+	/// with it's transform, and shaders only loop over those instead of the lights in their cluster. This
+	/// caps the per-fragment cost no matter how many lights overlap, but big objects may miss some lights
+	/// Can be set with "per_object_lights" in the Rendering section of the app settings
+	/// </summary>
+	bool IsPerObjectLightsEnabled() const;
+	void SetPerObjectLightsEnabled(bool value);
+
+	/// <summary>
+	/// When enabled, materials whose shader supports it (see ShaderProgram::GetDeferredVariant) write their
+	/// albedo, normal and specular to a G-buffer instead of being shaded, and the lights are evaluated once
+	/// per pixel in a full screen pass. Everything else (ex: alpha tested or transparent materials) is still
+	/// shaded forward afterwards. Surfaces in the G-buffer always use the light clusters, even with per-object
+	/// lights enabled
+	/// Can be set with "deferred_shading" in the Rendering section of the app settings
+	/// </summary>
+	bool IsDeferredShadingEnabled() const;
+	void SetDeferredShadingEnabled(bool value);
+
+	/// <summary>
+	/// When enabled, meshes that match the geometry pool's vertex layout are copied into a shared
+	/// vertex and index buffer, and each material's pooled draws are submitted with a single
+	/// glMultiDrawElementsIndirect
+	/// </summary>
+	bool IsGeometryPoolEnabled() const;
+	void SetGeometryPoolEnabled(bool value);
+
+	/// <summary>
+	/// When enabled, the bounding boxes of large objects are tested against the depth buffer
+	/// with occlusion queries, and objects found to be hidden are skipped the next frame
+	/// </summary>
+	bool IsOcclusionCullingEnabled() const;
+	void SetOcclusionCullingEnabled(bool value);
+
+	/// <summary>
+	/// When enabled, the render queue is drawn depth only first, then drawn again with the depth
+	/// test set to GL_EQUAL so that each pixel is only shaded once. Helps scenes with a lot of overdraw
+	/// or expensive fragment shaders, but doubles the vertex work. Materials that discard fragments
+	/// are left out of the pre-pass
+	/// Can be set with "depth_prepass" in the Rendering section of the app settings
+	/// </summary>
+	bool IsDepthPrepassEnabled() const;
+	void SetDepthPrepassEnabled(bool value);
+
+	/// <summary>
+	/// When enabled, objects whose mesh has LODs are drawn with a lower detail LOD as their bounding
+	/// sphere gets smaller on screen. When disabled, everything is drawn at full detail
+	/// Can be set with "mesh_lods" in the Rendering section of the app settings
+	/// </summary>
+	bool IsLodSelectionEnabled() const;
+	void SetLodSelectionEnabled(bool value);
+
+	/// <summary>
+	/// When enabled, the per-object work of building the render queue (culling, LOD selection, sort keys
+	/// and matrices) is split across a pool of worker threads, and the GL thread only merges the results
+	/// and issues GL calls. When disabled, the same work runs on the GL thread
+	/// Can be set with "parallel_extract" in the Rendering section of the app settings
+	/// </summary>
+	bool IsParallelExtractEnabled() const;
+	void SetParallelExtractEnabled(bool value);
+
+	/// <summary>
+	/// When enabled, the scene is drawn at a fraction of the window's resolution, which is adjusted every
+	/// frame to keep the GPU time for the scene under the target frame time. When disabled, the scene is
+	/// always drawn at the window's resolution
+	/// Can be set with "dynamic_resolution" in the Rendering section of the app settings, along with
+	/// "target_frame_time", "min_resolution_scale" and "max_resolution_scale"
+	/// </summary>
+	bool IsDynamicResolutionEnabled() const;
+	void SetDynamicResolutionEnabled(bool value);
+	/// <summary>
+	/// Gets or sets the GPU time in milliseconds that dynamic resolution tries to stay under
+	/// </summary>
+	float GetTargetFrameTime() const;
+	void SetTargetFrameTime(float value);
+	/// <summary>
+	/// Sets the range that dynamic resolution may scale the resolution within, as fractions of the window size
+	/// </summary>
+	void SetResolutionScaleBounds(float min, float max);
+	/// <summary>
+	/// Gets the fraction of the window's resolution that the scene is currently drawn at
+	/// </summary>
+	float GetResolutionScale() const;
+	/// <summary>
+	/// Gets the most recent GPU time for drawing the scene in milliseconds. Timings are read back a
+	/// few frames late so we never have to wait on the GPU
+	/// </summary>
+	float GetGpuFrameTime() const;
+	/// <summary>
+	/// Gets or sets the filter the application uses to scale our output up to the window
+	/// Can be set with "upscale_filter" in the Rendering section of the app settings
+	/// </summary>
+	UpscaleFilter GetUpscaleFilter() const;
+	void SetUpscaleFilter(UpscaleFilter value);
+
+	/// <summary>
+	/// Gets the object and draw call counters from the most recently rendered frame
+	/// </summary>
+	const RenderStats& GetRenderStats() const;
+
 	// Inherited from ApplicationLayer
 
 	virtual void OnAppLoad(const nlohmann::json& config) override;
 	virtual void OnRender(const Framebuffer::Sptr& prevLayer) override;
 	virtual void OnWindowResize(const glm::ivec2& oldSize, const glm::ivec2& newSize) override;
 	virtual Framebuffer::Sptr GetRenderOutput() override;
+	virtual nlohmann::json GetDefaultConfig() override;
 
 protected:
 	Framebuffer::Sptr _primaryFBO;
+	RenderTargetPool::Sptr _targetPool;
 	bool              _blitFbo;
 	glm::vec4         _clearColor;
 	RenderFlags       _renderFlags;
+	// Defines for the shader variants matching the current render flags
+	std::vector<std::string> _shaderDefines;
+	// Same as _shaderDefines, for materials that sample from a texture array
+	std::vector<std::string> _textureArrayDefines;
+	bool              _frustumCulling;
+	bool              _gpuCulling;
+	bool              _pvsCulling;
+	bool              _perObjectLights;
+	bool              _deferredShading;
+	bool              _geometryPoolEnabled;
+	bool              _occlusionCulling;
+	bool              _depthPrepass;
+	bool              _lodSelection;
+	bool              _parallelExtract;
+	bool              _dynamicResolution;
+	UpscaleFilter     _upscaleFilter;
+	RenderStats       _renderStats;
+
+	// Dynamic resolution state, see _UpdateResolutionScale
+	float    _resolutionScale;
+	float    _minResolutionScale;
+	float    _maxResolutionScale;
+	float    _targetFrameTime;
+	float    _gpuFrameTime;
+	float    _smoothedFrameTime;
+	uint32_t _resolutionCooldown;
+
+	// The version of our GpuProfiler scope's stats that we last sampled, so each result is only used once
+	uint64_t _gpuTimeVersion;
+
+	// Scales are snapped to multiples of this, so small changes in frame time don't resize our targets
+	const float    RESOLUTION_SCALE_STEP = 0.05f;
+	// The most the scale can change by in one step
+	const float    MAX_RESOLUTION_CHANGE = 0.15f;
+	// How far under the target the frame time has to be before we raise the resolution again
+	const float    RESOLUTION_HYSTERESIS = 0.15f;
+	// The number of frames to wait after changing the scale, so the new timings can come in
+	const uint32_t RESOLUTION_COOLDOWN_FRAMES = 30;
+	// How much of each new GPU timing goes into the smoothed frame time
+	const float    FRAME_TIME_SMOOTHING = 0.1f;
 
 	const int FRAME_UBO_BINDING = 0;
 	UniformBuffer<FrameLevelUniforms>::Sptr _frameUniforms;
 
 	const int INSTANCE_UBO_BINDING = 1;
-	UniformBuffer<InstanceLevelUniforms>::Sptr _instanceUniforms;
+	// Per-draw uniforms are pushed into a persistently mapped ring, so each draw only costs
+	// a memcpy and a glBindBufferRange instead of a buffer update
+	UniformRingBuffer::Sptr _instanceUniforms;
+
+	// The draws for the current frame, and scratch space for sorting them
+	std::vector<DrawCommand>   _drawQueue;
+	std::vector<DrawCommand>   _drawQueueScratch;
+	std::vector<DrawTransform> _drawTransforms;
+	std::vector<DrawBatch>     _drawBatches;
+
+	// Everything about the camera that extraction needs, so the workers never touch the scene's camera
+	struct ExtractContext {
+		glm::mat4 ViewProjection;
+		glm::mat4 View;
+		Frustum   ViewFrustum;
+		// Scales a view space radius into a fraction of half the screen height, for picking LODs
+		float     ProjectionScale;
+		float     NearPlane;
+		bool      Orthographic;
+		std::shared_ptr<Gameplay::Material> DefaultMaterial;
+	};
+	// A draw that made it through culling, before it's occlusion query (if any) has been checked
+	struct ExtractedDraw {
+		DrawCommand   Command;
+		DrawTransform Transform;
+		// The world space bounds to test against the depth buffer, if TestOcclusion is set
+		AABB          WorldBox;
+		bool          TestOcclusion;
+	};
+	// Output for one chunk of the scene's render components, each chunk is written by a single thread
+	struct ExtractBuffer {
+		std::vector<ExtractedDraw> Draws;
+		uint32_t                   Culled;
+		uint32_t                   PvsCulled;
+		uint32_t                   ObjectLights;
+	};
+
+	// Render components are extracted in chunks of this many, small scenes end up in a single chunk and never leave the GL thread
+	const size_t EXTRACT_CHUNK_SIZE = 256;
+	std::vector<RenderComponent*> _renderables;
+	// Chunks hidden by the scene's PVS this frame, only read from while extracting
+	std::unordered_set<const RenderComponent*> _pvsHidden;
+	std::vector<RenderComponent*>              _pvsBatchMembers;
+	std::vector<ExtractBuffer>    _extractBuffers;
+	ThreadPool::Uptr              _extractPool;
+
+	// Batches with at least this many draws get drawn with instancing
+	const uint32_t MIN_INSTANCED_BATCH = 4;
+	std::vector<InstanceData> _instanceData;
+	VertexBuffer::Sptr        _instanceBuffer;
+
+	// Copies of mesh VAOs with the instance buffer attached, keyed by the source VAO
+	struct InstancedMesh {
+		VertexArrayObject::Wptr Source;
+		VertexArrayObject::Sptr Mesh;
+	};
+	std::unordered_map<VertexArrayObject*, InstancedMesh> _instancedMeshes;
+
+	// Only objects with a world space bounding radius at least this big get occlusion queries,
+	// small objects are cheaper to just draw than to test
+	const float MIN_OCCLUDEE_RADIUS = 2.0f;
+	OcclusionCuller::Sptr _occlusionCuller;
+
+	// An object switches to the next LOD once it's bounding sphere's projected radius (as a fraction of half
+	// the screen height) drops below the threshold for it's current LOD. Switching back needs the object to
+	// be a bit bigger than the threshold, so objects sitting right on it don't flicker between LODs
+	const float LOD_SCREEN_SIZES[3] ={ 0.25f, 0.12f, 0.05f };
+	const float LOD_HYSTERESIS = 0.1f;
+
+	// Sorts the scene's lights into clusters each frame, so shaders only evaluate nearby lights
+	ClusteredLighting::Sptr _lightClusters;
+
+	// Albedo, normal and lighting targets for deferred shading (see gbuffer_outputs.glsl), sharing the primary
+	// FBO's size. Only allocated while deferred shading is enabled
+	Framebuffer::Sptr       _gBuffer;
+	ShaderProgram::Sptr     _deferredLightingShader;
+	VertexArrayObject::Sptr _fullscreenTriangle;
+
+	// Shared buffers for static meshes, and the indirect commands that draw from them
+	GeometryPool::Sptr                       _geometryPool;
+	std::vector<DrawElementsIndirectCommand> _indirectCommands;
+	IndirectBuffer::Sptr                     _indirectBuffer;
+
+	// The instances to frustum cull on the GPU, and the bounds to test them with. The visible instances
+	// are written to _instanceBuffer, so these are never mixed with _instanceData
+	GpuCuller::Sptr                          _gpuCuller;
+	std::vector<InstanceData>                _cullInstances;
+	std::vector<GpuCuller::InstanceBounds>   _cullBounds;
+
+	/// <summary>
+	/// Gets a copy of the given mesh with our instance buffer attached, creating it if needed
+	/// </summary>
+	/// <param name="mesh">The mesh to get the instanced copy of</param>
+	const VertexArrayObject::Sptr& _GetInstancedMesh(const VertexArrayObject::Sptr& mesh);
+
+	/// <summary>
+	/// Culls a range of _renderables and writes draws for whatever is left into the given buffer. Only reads from
+	/// the scene (besides each object's material fallback and LOD), so ranges can be extracted on different threads
+	/// </summary>
+	/// <param name="context">The camera data for the frame</param>
+	/// <param name="first">The index of the first renderable to extract</param>
+	/// <param name="end">One past the index of the last renderable to extract</param>
+	/// <param name="buffer">The buffer to write the draws to</param>
+	void _ExtractDraws(const ExtractContext& context, size_t first, size_t end, ExtractBuffer& buffer);
+	/// <summary>
+	/// Rebuilds the defines for our shader variants from the render flags and lighting mode
+	/// </summary>
+	void _UpdateShaderDefines();
+
+	/// <summary>
+	/// Reads back the GPU timings, and adjusts the resolution scale to bring the frame time towards the target
+	/// </summary>
+	void _UpdateResolutionScale();
+	/// <summary>
+	/// Resizes the primary framebuffer to the window size multiplied by the resolution scale
+	/// </summary>
+	void _ResizePrimaryFBO(const glm::ivec2& windowSize);
+
+	/// <summary>
+	/// Draws all the batches in the render queue, assumes the instance uniforms have already been pushed
+	/// </summary>
+	/// <param name="depthOnly">True to draw only batches in the depth pre-pass, with their depth only shaders</param>
+	/// <param name="deferred">True to draw the batches that go to the G-buffer, false for the forward shaded ones</param>
+	void _SubmitBatches(bool depthOnly, bool deferred);
+	/// <summary>
+	/// Draws the deferred batches to the G-buffer, then lights them into the primary FBO and copies their
+	/// depth over, so the forward shaded batches can be drawn on top
+	/// </summary>
+	/// <param name="viewProj">The camera's view projection, for rebuilding world positions from depth</param>
+	void _RenderDeferred(const glm::mat4& viewProj);
+	/// <summary>
+	/// Gets the variant of a material's shader with the current render flags compiled in (and texture
+	/// array support if the material needs it), or the shader itself if the variant failed to compile
+	/// </summary>
+	const ShaderProgram::Sptr& _GetFlagVariant(const Gameplay::Material* material) const;
+	/// <summary>
+	/// Gets the shader variant to draw a batch with
+	/// </summary>
+	/// <param name="batch">The batch to get the shader for</param>
+	/// <param name="depthOnly">True to get the depth only variant, which may be nullptr</param>
+	const ShaderProgram::Sptr& _GetBatchShader(const DrawBatch& batch, bool depthOnly) const;
+
+	/// <summary>
+	/// Returns true if a mesh's bounds are at least partially inside the frustum, meshes without bounds are always inside
+	/// </summary>
+	/// <param name="frustum">The frustum to test against</param>
+	/// <param name="bounds">The mesh's local space bounds</param>
+	/// <param name="transform">The transform to move the bounds into world space with</param>
+	static bool _IsInFrustum(const Frustum& frustum, const MeshBounds& bounds, const glm::mat4& transform);
+	/// <summary>
+	/// Picks the mesh LOD for an object, stepping from it's current LOD so that the hysteresis is applied
+	/// </summary>
+	/// <param name="current">The LOD the object was drawn with last frame</param>
+	/// <param name="lodCount">The number of LODs the object's mesh has, including full detail</param>
+	/// <param name="screenSize">The projected radius of the object's bounding sphere, as a fraction of half the screen height</param>
+	int _SelectLod(int current, int lodCount, float screenSize) const;
+
+	/// <summary>
+	/// Builds a sort key for a draw, ordering by shader, then material, then mesh, then front-to-back depth
+	/// </summary>
+	/// <param name="renderable">The component being drawn</param>
+	/// <param name="viewDepth">The distance along the camera's forward axis to the object</param>
+	static uint64_t _MakeSortKey(const RenderComponent* renderable, float viewDepth);
+	/// <summary>
+	/// Sorts the draw queue by key using an LSD radix sort, stable and linear in the number of draws
+	/// </summary>
+	void _SortDrawQueue();
 };
\ No newline at end of file
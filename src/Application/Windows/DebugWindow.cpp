@@ -2,6 +2,9 @@
 #include "Application/Application.h"
 #include "Application/ApplicationLayer.h"
 #include "Application/Layers/RenderLayer.h"
+#include "Graphics/GpuProfiler.h"
+#include "Utils/DynamicAabbTree.h"
+#include "Utils/DynamicAabbTreeBenchmark.h"
 
 DebugWindow::DebugWindow() :
 	IEditorWindow()
@@ -37,4 +40,124 @@ void DebugWindow::RenderMenuBar()
 	if (changed) {
 		renderLayer->SetRenderFlags(flags);
 	}
+
+	ImGui::Separator();
+
+	bool culling = renderLayer->IsFrustumCullingEnabled();
+	if (ImGui::Checkbox("Frustum Culling", &culling)) {
+		renderLayer->SetFrustumCullingEnabled(culling);
+	}
+	bool gpuCulling = renderLayer->IsGpuCullingEnabled();
+	if (ImGui::Checkbox("GPU Culling", &gpuCulling)) {
+		renderLayer->SetGpuCullingEnabled(gpuCulling);
+	}
+	bool pvsCulling = renderLayer->IsPvsCullingEnabled();
+	if (ImGui::Checkbox("PVS Culling", &pvsCulling)) {
+		renderLayer->SetPvsCullingEnabled(pvsCulling);
+	}
+	bool perObjectLights = renderLayer->IsPerObjectLightsEnabled();
+	if (ImGui::Checkbox("Per-Object Lights", &perObjectLights)) {
+		renderLayer->SetPerObjectLightsEnabled(perObjectLights);
+	}
+	bool deferredShading = renderLayer->IsDeferredShadingEnabled();
+	if (ImGui::Checkbox("Deferred Shading", &deferredShading)) {
+		renderLayer->SetDeferredShadingEnabled(deferredShading);
+	}
+	bool geometryPool = renderLayer->IsGeometryPoolEnabled();
+	if (ImGui::Checkbox("Geometry Pool (MDI)", &geometryPool)) {
+		renderLayer->SetGeometryPoolEnabled(geometryPool);
+	}
+	bool occlusion = renderLayer->IsOcclusionCullingEnabled();
+	if (ImGui::Checkbox("Occlusion Culling", &occlusion)) {
+		renderLayer->SetOcclusionCullingEnabled(occlusion);
+	}
+	bool depthPrepass = renderLayer->IsDepthPrepassEnabled();
+	if (ImGui::Checkbox("Depth Pre-pass", &depthPrepass)) {
+		renderLayer->SetDepthPrepassEnabled(depthPrepass);
+	}
+	bool lodSelection = renderLayer->IsLodSelectionEnabled();
+	if (ImGui::Checkbox("Mesh LODs", &lodSelection)) {
+		renderLayer->SetLodSelectionEnabled(lodSelection);
+	}
+	bool parallelExtract = renderLayer->IsParallelExtractEnabled();
+	if (ImGui::Checkbox("Parallel Extract", &parallelExtract)) {
+		renderLayer->SetParallelExtractEnabled(parallelExtract);
+	}
+
+	ImGui::Separator();
+
+	bool dynamicResolution = renderLayer->IsDynamicResolutionEnabled();
+	if (ImGui::Checkbox("Dynamic Resolution", &dynamicResolution)) {
+		renderLayer->SetDynamicResolutionEnabled(dynamicResolution);
+	}
+	float targetFrameTime = renderLayer->GetTargetFrameTime();
+	if (ImGui::DragFloat("Target GPU Time (ms)", &targetFrameTime, 0.1f, 1.0f, 100.0f)) {
+		renderLayer->SetTargetFrameTime(targetFrameTime);
+	}
+	UpscaleFilter upscaleFilter = renderLayer->GetUpscaleFilter();
+	if (ImGui::BeginCombo("Upscale Filter", (~upscaleFilter).c_str())) {
+		for (UpscaleFilter option : { UpscaleFilter::Nearest, UpscaleFilter::Linear, UpscaleFilter::Sharpen }) {
+			if (ImGui::Selectable((~option).c_str(), option == upscaleFilter)) {
+				renderLayer->SetUpscaleFilter(option);
+			}
+		}
+		ImGui::EndCombo();
+	}
+	glm::ivec2 renderSize = renderLayer->GetPrimaryFBO()->GetSize();
+	ImGui::Text("Resolution Scale: %.2f (%dx%d)  GPU: %.2fms", renderLayer->GetResolutionScale(), renderSize.x, renderSize.y, renderLayer->GetGpuFrameTime());
+
+	ImGui::Separator();
+
+	const RenderLayer::RenderStats& stats = renderLayer->GetRenderStats();
+	ImGui::Text("Drawn: %u  Culled: %u  Draw Calls: %u", stats.ObjectsDrawn, stats.ObjectsCulled, stats.DrawCalls);
+	ImGui::Text("PVS Culled: %u  GPU Tested: %u", stats.ObjectsPvsCulled, stats.ObjectsGpuTested);
+	ImGui::Text("Occluded: %u  Conditional: %u  Queries: %u", stats.ObjectsOccluded, stats.ObjectsConditional, stats.OcclusionQueries);
+	ImGui::Text("Lights: %u  Cluster Entries: %u  Object Entries: %u", stats.Lights, stats.LightClusterEntries, stats.ObjectLightEntries);
+	ImGui::Text("Reduced LOD: %u  Deferred: %u", stats.ObjectsReducedLod, stats.ObjectsDeferred);
+	ImGui::Text("Transient Targets: %u  Allocated: %u", renderLayer->GetRenderTargetPool()->GetTargetCount(), renderLayer->GetRenderTargetPool()->GetAllocationsLastFrame());
+	if (app.CurrentScene() != nullptr) {
+		const Gameplay::StaticBatcher::Sptr& batcher = app.CurrentScene()->GetStaticBatcher();
+		ImGui::Text("Static Batches: %u  Merged Objects: %u", static_cast<uint32_t>(batcher->GetRenderables().size()), batcher->GetMergedCount());
+
+		// Baking casts a lot of rays, so this will hang for a bit on big levels
+		if (ImGui::Button("Bake PVS")) {
+			Gameplay::PotentiallyVisibleSet::Sptr pvs = Gameplay::PotentiallyVisibleSet::Bake(*app.CurrentScene());
+			app.CurrentScene()->SetPotentiallyVisibleSet(pvs);
+			if (pvs != nullptr && !app.CurrentScene()->GetFilePath().empty()) {
+				pvs->Save(Gameplay::PotentiallyVisibleSet::GetPathForScene(app.CurrentScene()->GetFilePath()));
+			}
+		}
+		const Gameplay::PotentiallyVisibleSet::Sptr& pvs = app.CurrentScene()->GetPotentiallyVisibleSet();
+		if (pvs != nullptr) {
+			// Chunk draws submitted per cell with the PVS, compared to every chunk without it
+			const Gameplay::PotentiallyVisibleSet::Stats& pvsStats = pvs->GetStats();
+			ImGui::SameLine();
+			ImGui::Text("%u cells, %u sets, %.1f / %u chunks per cell", pvsStats.Cells, pvsStats.UniqueSets, pvsStats.AverageVisible, pvsStats.Chunks);
+		}
+	}
+
+	ImGui::Separator();
+
+	if (app.CurrentScene() != nullptr) {
+		const DynamicAabbTree::Sptr& tree = app.CurrentScene()->GetSpatialTree();
+		ImGui::Text("Spatial Tree: %u objects, height %d, %u in view", tree->GetProxyCount(), tree->GetHeight(), stats.ObjectsVisited);
+	}
+	if (ImGui::Button("Benchmark Spatial Tree (10k)")) {
+		_spatialBenchmark = DynamicAabbTreeBenchmark::Run(10000);
+	}
+	for (const std::string& line : _spatialBenchmark) {
+		ImGui::TextUnformatted(line.c_str());
+	}
+
+	ImGui::Separator();
+
+	// GPU time per layer and sub pass, averaged over the last few frames
+	GpuProfiler& profiler = GpuProfiler::Get();
+	ImGui::Text("GPU Timings (avg / max ms), dropped frames: %u", profiler.GetDroppedFrames());
+	for (const GpuProfiler::ScopeStats& scope : profiler.GetScopes()) {
+		ImGui::Text("  %-40s %6.3f / %6.3f", scope.Name.c_str(), scope.Average, scope.Max);
+	}
+	if (ImGui::Button("Reset GPU Timings")) {
+		profiler.ResetStats();
+	}
 }
@@ -1,4 +1,6 @@
 #pragma once
+#include <vector>
+#include <string>
 #include "Application/IEditorWindow.h"
 
 /**
@@ -15,4 +17,6 @@ public:
 	virtual void RenderMenuBar() override;
 
 protected:
+	// The results of the last spatial tree benchmark, see DynamicAabbTreeBenchmark
+	std::vector<std::string> _spatialBenchmark;
 };
\ No newline at end of file
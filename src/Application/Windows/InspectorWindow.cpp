@@ -37,16 +37,19 @@ void InspectorWindow::Render()
 		ImGui::Separator();
 
 		// Render position label
-		selection->_isLocalTransformDirty |= LABEL_LEFT(ImGui::DragFloat3, "Position", &selection->_position.x, 0.01f);
+		glm::vec3 position = selection->GetPosition();
+		if (LABEL_LEFT(ImGui::DragFloat3, "Position", &position.x, 0.01f)) {
+			selection->SetPostion(position);
+		}
 
 		// Get the ImGui storage state so we can avoid gimbal locking issues by storing euler angles in the editor
 		glm::vec3 euler = selection->GetRotationEuler();
 		ImGuiStorage* guiStore = ImGui::GetStateStorage();
 
-		// Extract the angles from the storage, note that we're only using the address of the position for unique IDs
-		euler.x = guiStore->GetFloat(ImGui::GetID(&selection->_position.x), euler.x);
-		euler.y = guiStore->GetFloat(ImGui::GetID(&selection->_position.y), euler.y);
-		euler.z = guiStore->GetFloat(ImGui::GetID(&selection->_position.z), euler.z);
+		// Extract the angles from the storage, the IDs are unique since we're inside the selection's ID scope
+		euler.x = guiStore->GetFloat(ImGui::GetID("##euler_x"), euler.x);
+		euler.y = guiStore->GetFloat(ImGui::GetID("##euler_y"), euler.y);
+		euler.z = guiStore->GetFloat(ImGui::GetID("##euler_z"), euler.z);
 
 		//Draw the slider for angles
 		if (LABEL_LEFT(ImGui::DragFloat3, "Rotation", &euler.x, 1.0f)) {
@@ -54,20 +57,19 @@ void InspectorWindow::Render()
 			euler = Wrap(euler, -180.0f, 180.0f);
 
 			// Update the editor state with our new values
-			guiStore->SetFloat(ImGui::GetID(&selection->_position.x), euler.x);
-			guiStore->SetFloat(ImGui::GetID(&selection->_position.y), euler.y);
-			guiStore->SetFloat(ImGui::GetID(&selection->_position.z), euler.z);
+			guiStore->SetFloat(ImGui::GetID("##euler_x"), euler.x);
+			guiStore->SetFloat(ImGui::GetID("##euler_y"), euler.y);
+			guiStore->SetFloat(ImGui::GetID("##euler_z"), euler.z);
 
 			//Send new rotation to the gameobject
 			selection->SetRotation(euler);
 		}
 
 		// Draw the scale
-		selection->_isLocalTransformDirty |= LABEL_LEFT(ImGui::DragFloat3, "Scale   ", &selection->_scale.x, 0.01f, 0.0f);
-
-		// For if we're not in play mode
-		selection->_RecalcLocalTransform();
-		selection->_RecalcWorldTransform();
+		glm::vec3 scale = selection->GetScale();
+		if (LABEL_LEFT(ImGui::DragFloat3, "Scale   ", &scale.x, 0.01f, 0.0f)) {
+			selection->SetScale(scale);
+		}
 
 		ImGui::Separator();
 
@@ -67,6 +67,14 @@ namespace Gameplay {
 		/// Gets whether this camera is in orthographic mode
 		/// </summary>
 		bool GetOrthoEnabled() const { return _isOrtho; }
+		/// <summary>
+		/// Gets the distance to the camera's near clipping plane
+		/// </summary>
+		float GetNearPlane() const { return _nearPlane; }
+		/// <summary>
+		/// Gets the distance to the camera's far clipping plane
+		/// </summary>
+		float GetFarPlane() const { return _farPlane; }
 
 		/// <summary>
 		/// Gets the view matrix for this camera
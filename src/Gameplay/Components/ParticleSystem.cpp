@@ -3,6 +3,7 @@
 #include "Application/Timing.h"
 #include "Application/Application.h"
 #include "Utils/ImGuiHelper.h"
+#include "Graphics/VertexArrayObject.h"
 
 ParticleSystem::ParticleSystem() :
 	IComponent(),
@@ -73,7 +74,7 @@ void ParticleSystem::Update()
 	glEnable(GL_RASTERIZER_DISCARD);
 
 	// Make sure no VAOs are bound
-	glBindVertexArray(0);
+	VertexArrayObject::Unbind();
 
 	// Bind the buffer and transform feedback
 	glBindBuffer(GL_ARRAY_BUFFER, _particleBuffers[_currentVertexBuffer]);
@@ -152,7 +153,7 @@ void ParticleSystem::Render()
 		_renderShader->Bind();
 
 		// Make sure no VAOs are bound
-		glBindVertexArray(0);
+		VertexArrayObject::Unbind();
 
 		// Bind the current feedback buffer as our drawing buffer
 		glBindBuffer(GL_ARRAY_BUFFER, _particleBuffers[_currentVertexBuffer]);
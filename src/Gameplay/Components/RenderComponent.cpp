@@ -1,23 +1,39 @@
 #include "Gameplay/Components/RenderComponent.h"
+#include "Gameplay/GameObject.h"
 
 #include "Utils/ResourceManager/ResourceManager.h"
 #include "Utils/ImGuiHelper.h"
+#include "Utils/JsonGlmHelpers.h"
 
 
 RenderComponent::RenderComponent(const Gameplay::MeshResource::Sptr& mesh, const Gameplay::Material::Sptr& material) :
 	_mesh(mesh), 
 	_material(material), 
+	_lodLevel(0),
+	_isStatic(false),
+	_staticBatched(false),
 	_meshBuilderParams(std::vector<MeshBuilderParam>()) 
 { }
 
 RenderComponent::RenderComponent() : 
 	_mesh(nullptr), 
 	_material(nullptr), 
+	_lodLevel(0),
+	_isStatic(false),
+	_staticBatched(false),
 	_meshBuilderParams(std::vector<MeshBuilderParam>())
 { }
 
 void RenderComponent::SetMesh(const Gameplay::MeshResource::Sptr& mesh) {
 	_mesh = mesh;
+	// The object's bounds come from our mesh
+	if (GetGameObject() != nullptr) {
+		GetGameObject()->UpdateBounds();
+	}
+}
+
+void RenderComponent::OnLoad() {
+	GetGameObject()->UpdateBounds();
 }
 
 const Gameplay::MeshResource::Sptr& RenderComponent::GetMeshResource() const {
@@ -28,6 +44,10 @@ VertexArrayObject::Sptr RenderComponent::GetMesh() const {
 	return _mesh ? _mesh->Mesh : nullptr;
 }
 
+VertexArrayObject::Sptr RenderComponent::GetLodMesh() const {
+	return _mesh ? _mesh->GetLod(_lodLevel) : nullptr;
+}
+
 void RenderComponent::SetMaterial(const Gameplay::Material::Sptr& mat) {
 	_material = mat;
 }
@@ -36,10 +56,31 @@ const Gameplay::Material::Sptr& RenderComponent::GetMaterial() const {
 	return _material;
 }
 
+int RenderComponent::GetLodLevel() const {
+	return _lodLevel;
+}
+
+void RenderComponent::SetLodLevel(int level) {
+	_lodLevel = level;
+}
+
+bool RenderComponent::IsStatic() const {
+	return _isStatic;
+}
+
+void RenderComponent::SetStatic(bool value) {
+	_isStatic = value;
+}
+
+bool RenderComponent::IsStaticBatched() const {
+	return _staticBatched;
+}
+
 nlohmann::json RenderComponent::ToJson() const {
 	nlohmann::json result;
 	result["mesh"] = _mesh ? _mesh->GetGUID().str() : "null";
 	result["material"] = _material ? _material->GetGUID().str() : "null";
+	result["static"] = _isStatic;
 	return result;
 }
 
@@ -47,6 +88,7 @@ RenderComponent::Sptr RenderComponent::FromJson(const nlohmann::json& data) {
 	RenderComponent::Sptr result = std::make_shared<RenderComponent>();
 	result->_mesh = ResourceManager::Get<Gameplay::MeshResource>(Guid(data["mesh"].get<std::string>()));
 	result->_material = ResourceManager::Get<Gameplay::Material>(Guid(data["material"].get<std::string>()));
+	result->_isStatic = JsonGet(data, "static", false);
 
 	return result;
 }
@@ -54,7 +96,13 @@ RenderComponent::Sptr RenderComponent::FromJson(const nlohmann::json& data) {
 void RenderComponent::RenderImGui() {
 	ImGui::Text("Indexed:   %s", GetMesh() != nullptr ? (_mesh->Mesh->GetIndexBuffer() != nullptr ? "true" : "false") : "N/A");
 	ImGui::Text("Triangles: %d", GetMesh() != nullptr ? (_mesh->Mesh->GetElementCount() / 3) : 0);
+	ImGui::Text("LOD:       %d / %d", _lodLevel, _mesh != nullptr ? _mesh->GetLodCount() - 1 : 0);
 	ImGui::Text("Source:    %s", (_mesh == nullptr || _mesh->Filename.empty()) ? "Generated" : _mesh->Filename.c_str());
+	ImGui::Checkbox("Static", &_isStatic);
+	if (_staticBatched) {
+		ImGui::SameLine();
+		ImGui::Text("(batched)");
+	}
 	ImGui::Separator();
 	ImGui::Text("Material:  %s", _material != nullptr ? _material->Name.c_str() : "NULL");
 	ImGuiHelper::ResourceDragTarget<Gameplay::Material>(_material);
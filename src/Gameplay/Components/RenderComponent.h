@@ -4,6 +4,10 @@
 #include "Gameplay/Material.h"
 #include "Utils/MeshFactory.h"
 
+namespace Gameplay {
+	class StaticBatcher;
+}
+
 /// <summary>
 /// Provides information for a object to be rendered
 /// 
@@ -26,6 +30,10 @@ public:
 	/// </summary>
 	VertexArrayObject::Sptr GetMesh() const;
 	/// <summary>
+	/// Gets the VAO for the detail level the renderer last picked for this object
+	/// </summary>
+	VertexArrayObject::Sptr GetLodMesh() const;
+	/// <summary>
 	/// Gets the material that this renderer is using
 	/// </summary>
 	const Gameplay::Material::Sptr& GetMaterial() const;
@@ -42,18 +50,55 @@ public:
 	/// <param name="mat">The material for this object</param>
 	void SetMaterial(const Gameplay::Material::Sptr& mat);
 
+	/// <summary>
+	/// Gets the mesh detail level that this object is drawn with, where 0 is full detail
+	/// </summary>
+	int GetLodLevel() const;
+	/// <summary>
+	/// Sets the mesh detail level that this object is drawn with, this is updated by the renderer
+	/// every frame based on how big the object is on screen
+	/// </summary>
+	/// <param name="level">The new detail level, levels past the end of the mesh's LOD chain will use the least detailed LOD</param>
+	void SetLodLevel(int level);
+
+	/// <summary>
+	/// Gets whether this object has been marked as never moving or changing, which lets the scene
+	/// merge it with other static objects that share it's material
+	/// </summary>
+	bool IsStatic() const;
+	/// <summary>
+	/// Marks this object as static, static objects are merged when the scene wakes up. Clearing the
+	/// flag on an object that was merged will pull it back out of it's batch on the next frame
+	/// </summary>
+	/// <param name="value">True if the object will never move or change it's mesh or material</param>
+	void SetStatic(bool value);
+	/// <summary>
+	/// Gets whether this object is currently being drawn as part of a merged static batch, in
+	/// which case the renderer should skip it
+	/// </summary>
+	bool IsStaticBatched() const;
+
 	// Inherited from IComponent
 
+	virtual void OnLoad() override;
 	virtual void RenderImGui() override;
 	virtual nlohmann::json ToJson() const override;
 	static RenderComponent::Sptr FromJson(const nlohmann::json& data);
 	MAKE_TYPENAME(RenderComponent);
 
 protected:
+	friend class Gameplay::StaticBatcher;
+
 	// The object's mesh
 	Gameplay::MeshResource::Sptr _mesh;
 	// The object's material
 	Gameplay::Material::Sptr      _material;
+	// The mesh LOD that the renderer picked for us last frame, kept so that the choice can lag a bit and not flicker
+	int                           _lodLevel;
+	// True if the object has been marked as never moving
+	bool                          _isStatic;
+	// Set by the scene's static batcher while this object is merged into a batch
+	bool                          _staticBatched;
 
 	// If we want to use MeshFactory, we can populate this list
 	std::vector<MeshBuilderParam> _meshBuilderParams;
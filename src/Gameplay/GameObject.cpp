@@ -7,71 +7,39 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include "GLM/gtc/matrix_transform.hpp"
 #include "GLM/gtc/quaternion.hpp"
+#include "GLM/gtc/matrix_inverse.hpp"
 #include "GLM/glm.hpp"
 #include "Utils/GlmDefines.h"
 #include "Utils/ImGuiHelper.h"
 
 #include "Gameplay/Scene.h"
+#include "Gameplay/Components/RenderComponent.h"
 
 namespace Gameplay {
-	GameObject::GameObject() :
+	GameObject::GameObject(Scene* scene) :
 		IResource(),
 		Name("Unknown"),
 		HideInHierarchy(false),
 		_components(std::vector<IComponent::Sptr>()),
-		_scene(nullptr),
-		_position(ZERO),
-		_rotation(glm::quat(glm::vec3(0.0f))),
-		_scale(ONE),
-		_localTransform(MAT4_IDENTITY),
-		_inverseLocalTransform(MAT4_IDENTITY),
-		_isLocalTransformDirty(true),
-		_worldTransform(MAT4_IDENTITY),
-		_inverseWorldTransform(MAT4_IDENTITY),
-		_isWorldTransformDirty(true),
+		_scene(scene),
+		_transforms(scene->GetTransforms()),
+		_transformHandle(TransformStore::INVALID_HANDLE),
+		_spatialTree(scene->GetSpatialTree()),
+		_spatialProxy(DynamicAabbTree::NULL_PROXY),
+		_worldBounds(glm::vec3(0.0f), glm::vec3(0.0f)),
+		_unbounded(false),
 		_parent(WeakRef()),
 		_children(std::vector<WeakRef>())
-	{ }
-
-	void GameObject::_RecalcLocalTransform() const
 	{
-		if (_isLocalTransformDirty) {
-			_localTransform = glm::translate(MAT4_IDENTITY, _position) * glm::mat4_cast(_rotation) * glm::scale(MAT4_IDENTITY, _scale);
-			_inverseLocalTransform = glm::inverse(_localTransform);
-			_isLocalTransformDirty = false;
-			_isWorldTransformDirty = true;
-
-			// Dirty all the child objects world transforms
-			for (const auto& childPtr : _children) {
-				GameObject::Sptr childSptr = childPtr;
-				if (childSptr != nullptr) {
-					childSptr->_isWorldTransformDirty = true;
-				}
-			}
-		}
+		_transformHandle = _transforms->Allocate();
+		// New transforms start out dirty, so the scene will fit our proper bounds on it's next update
+		_spatialProxy = _spatialTree->CreateProxy(_worldBounds, this);
+		scene->_SetTransformOwner(_transformHandle, this);
 	}
 
-	void GameObject::_RecalcWorldTransform() const {
-		// Start by determining our local transform if required
-		_RecalcLocalTransform();
-
-		// If our world transform has been marked as dirty, we need to recalculate it!
-		if (_isWorldTransformDirty) {
-			GameObject::Sptr parent = _parent;
-
-			// If out parent exists, we apply our local transformation relative to the parent's world transformation
-			if (parent != nullptr) {
-				_worldTransform = parent->GetTransform() * _localTransform;
-				_inverseWorldTransform = glm::inverse(_worldTransform);
-			}
-
-			// If our parent is null, we can simply use the local transform as the world transform
-			else {
-				_worldTransform = _localTransform;
-				_inverseWorldTransform = _inverseLocalTransform;
-			}
-			_isWorldTransformDirty = false;
-		}
+	GameObject::~GameObject() {
+		_spatialTree->DestroyProxy(_spatialProxy);
+		_transforms->Release(_transformHandle);
 	}
 
 	void GameObject::_PurgeDeletedChildren() {
@@ -82,7 +50,7 @@ namespace Gameplay {
 	}
 
 	void GameObject::LookAt(const glm::vec3& point) {
-		glm::mat4 rot = glm::lookAt(_position, point, glm::vec3(0.0f, 0.0f, 1.0f));
+		glm::mat4 rot = glm::lookAt(GetPosition(), point, glm::vec3(0.0f, 0.0f, 1.0f));
 		// Take the conjugate of the quaternion, as lookAt returns the *inverse* rotation
 		SetRotation(glm::conjugate(glm::quat_cast(rot)));
 	}
@@ -112,60 +80,77 @@ namespace Gameplay {
 	}
 
 	void GameObject::SetPostion(const glm::vec3& position) {
-		_position = position;
-		_isLocalTransformDirty = true;
+		_transforms->SetPosition(_transformHandle, position);
 	}
 
 	const glm::vec3& GameObject::GetPosition() const {
-		return _position;
+		return _transforms->GetPosition(_transformHandle);
 	}
 
 	void GameObject::SetRotation(const glm::quat& value) {
-		_rotation = value;
-		_isLocalTransformDirty = true;
+		_transforms->SetRotation(_transformHandle, value);
 	}
 
 	const glm::quat& GameObject::GetRotation() const {
-		return _rotation;
+		return _transforms->GetRotation(_transformHandle);
 	}
 
 	void GameObject::SetRotation(const glm::vec3& eulerAngles) {
-		_rotation = glm::quat(glm::radians(eulerAngles));
-		_isLocalTransformDirty = true;
+		_transforms->SetRotation(_transformHandle, glm::quat(glm::radians(eulerAngles)));
 	}
 
 	glm::vec3 GameObject::GetRotationEuler() const {
-		return glm::degrees(glm::eulerAngles(_rotation));
+		return glm::degrees(glm::eulerAngles(GetRotation()));
 	}
 
 	void GameObject::SetScale(const glm::vec3& value) {
-		_scale = value;
-		_isLocalTransformDirty = true;
+		_transforms->SetScale(_transformHandle, value);
 	}
 
 	const glm::vec3& GameObject::GetScale() const {
-		return _scale;
+		return _transforms->GetScale(_transformHandle);
 	}
 
 	const glm::mat4& GameObject::GetTransform() const {
-		_RecalcWorldTransform();
-		return _worldTransform;
+		return _transforms->GetWorldTransform(_transformHandle);
 	}
 
 	const glm::mat4& GameObject::GetInverseTransform() const {
-		_RecalcWorldTransform();
-		return _inverseWorldTransform;
+		return _transforms->GetInverseWorldTransform(_transformHandle);
+	}
+
+	const glm::mat3& GameObject::GetNormalMatrix() const {
+		return _transforms->GetNormalMatrix(_transformHandle);
 	}
 
 	const glm::mat4& GameObject::GetLocalTransform() const
 	{
-		_RecalcLocalTransform();
-		return _localTransform;
+		return _transforms->GetLocalTransform(_transformHandle);
 	}
 
-	const glm::mat4& GameObject::GetInverseLocalTransform() const {
-		_RecalcLocalTransform();
-		return _inverseLocalTransform;
+	glm::mat4 GameObject::GetInverseLocalTransform() const {
+		return glm::affineInverse(GetLocalTransform());
+	}
+
+	void GameObject::UpdateBounds() {
+		// Big enough to pass any query, but small enough that the tree's surface area math won't overflow
+		static constexpr float UNBOUNDED_EXTENT = 1.0e6f;
+
+		RenderComponent::Sptr renderer = Get<RenderComponent>();
+		VertexArrayObject::Sptr mesh = renderer != nullptr ? renderer->GetMesh() : nullptr;
+		if (mesh != nullptr && mesh->GetBounds().Box.IsValid()) {
+			_worldBounds = mesh->GetBounds().Box.Transform(GetTransform());
+			_unbounded = false;
+		} else if (renderer != nullptr) {
+			// The renderer doesn't cull meshes without bounds, so spatial queries shouldn't either
+			_worldBounds = AABB(glm::vec3(-UNBOUNDED_EXTENT), glm::vec3(UNBOUNDED_EXTENT));
+			_unbounded = true;
+		} else {
+			glm::vec3 position = glm::vec3(GetTransform()[3]);
+			_worldBounds = AABB(position, position);
+			_unbounded = false;
+		}
+		_spatialTree->MoveProxy(_spatialProxy, _worldBounds);
 	}
 
 	void GameObject::RenderGUI() {
@@ -212,8 +197,6 @@ namespace Gameplay {
 			}
 		}
 
-		_RecalcLocalTransform();
-		_RecalcWorldTransform();
 		_PurgeDeletedChildren();
 	}
 
@@ -275,7 +258,7 @@ namespace Gameplay {
 			// applies to the child
 			_children.push_back(child);
 			child->_parent = _selfRef.lock();
-			child->_isWorldTransformDirty = true;
+			_transforms->SetParent(child->_transformHandle, _transformHandle);
 		} else {
 			LOG_WARN("Attempting to add same child twice, ignoring: {}", child->Name);
 		}
@@ -288,6 +271,7 @@ namespace Gameplay {
 		if (it != _children.end()) { 
 			// Clear the object's parent and remove from our list of children
 			child->_parent.Reset();
+			_transforms->SetParent(child->_transformHandle, TransformStore::INVALID_HANDLE);
 			_children.erase(it);
 			return true;
 		} else {
@@ -350,16 +334,19 @@ namespace Gameplay {
 			}
 
 			// Render position label
-			_isLocalTransformDirty |= LABEL_LEFT(ImGui::DragFloat3, "Position", &_position.x, 0.01f);
+			glm::vec3 position = GetPosition();
+			if (LABEL_LEFT(ImGui::DragFloat3, "Position", &position.x, 0.01f)) {
+				SetPostion(position);
+			}
 			
 			// Get the ImGui storage state so we can avoid gimbal locking issues by storing euler angles in the editor
 			glm::vec3 euler = GetRotationEuler();
 			ImGuiStorage* guiStore = ImGui::GetStateStorage();
 
-			// Extract the angles from the storage, note that we're only using the address of the position for unique IDs
-			euler.x = guiStore->GetFloat(ImGui::GetID(&_position.x), euler.x);
-			euler.y = guiStore->GetFloat(ImGui::GetID(&_position.y), euler.y);
-			euler.z = guiStore->GetFloat(ImGui::GetID(&_position.z), euler.z);
+			// Extract the angles from the storage, the IDs are unique since we're inside this object's ID scope
+			euler.x = guiStore->GetFloat(ImGui::GetID("##euler_x"), euler.x);
+			euler.y = guiStore->GetFloat(ImGui::GetID("##euler_y"), euler.y);
+			euler.z = guiStore->GetFloat(ImGui::GetID("##euler_z"), euler.z);
 
 			//Draw the slider for angles
 			if (LABEL_LEFT(ImGui::DragFloat3, "Rotation", &euler.x, 1.0f)) {
@@ -367,16 +354,19 @@ namespace Gameplay {
 				euler = Wrap(euler, -180.0f, 180.0f);
 
 				// Update the editor state with our new values
-				guiStore->SetFloat(ImGui::GetID(&_position.x), euler.x);
-				guiStore->SetFloat(ImGui::GetID(&_position.y), euler.y);
-				guiStore->SetFloat(ImGui::GetID(&_position.z), euler.z);
+				guiStore->SetFloat(ImGui::GetID("##euler_x"), euler.x);
+				guiStore->SetFloat(ImGui::GetID("##euler_y"), euler.y);
+				guiStore->SetFloat(ImGui::GetID("##euler_z"), euler.z);
 
 				//Send new rotation to the gameobject
 				SetRotation(euler);
 			}
 			
 			// Draw the scale
-			_isLocalTransformDirty |= LABEL_LEFT(ImGui::DragFloat3, "Scale   ", &_scale.x, 0.01f, 0.0f);
+			glm::vec3 scale = GetScale();
+			if (LABEL_LEFT(ImGui::DragFloat3, "Scale   ", &scale.x, 0.01f, 0.0f)) {
+				SetScale(scale);
+			}
 
 			ImGui::Separator();
 			ImGui::TextUnformatted("Components");
@@ -434,10 +424,6 @@ namespace Gameplay {
 			ImGui::Unindent();
 		}
 		ImGui::PopID(); // Pop the ImGui ID scope for the object
-
-		// For if we're not in play mode
-		_RecalcLocalTransform();
-		_RecalcWorldTransform();
 	}
 
 	std::shared_ptr<GameObject> GameObject::SelfRef() {
@@ -448,19 +434,16 @@ namespace Gameplay {
 	{
 		// We need to manually construct since the GameObject constructor is
 		// protected. We can call it here since Scene is a friend class of GameObjects
-		GameObject::Sptr result(new GameObject());
-		result->_scene = scene;
+		GameObject::Sptr result(new GameObject(scene));
 
 		// Load in basic info
 		result->Name = data["name"];
 		result->_guid = Guid(data["guid"]);
 		result->_parent = WeakRef(Guid(data.contains("parent") ? data["parent"] : "null"), nullptr);
-		result->_position = (data["position"]);
-		result->_rotation = (data["rotation"]);
-		result->_scale    = (data["scale"]);
+		result->SetPostion(data["position"].get<glm::vec3>());
+		result->SetRotation(data["rotation"].get<glm::quat>());
+		result->SetScale(data["scale"].get<glm::vec3>());
 		result->HideInHierarchy = JsonGet(data, "hide_in_inspector", false);
-		result->_isLocalTransformDirty = true;
-		result->_isWorldTransformDirty = true;
 
 		// Since our components are stored based on the type name, we iterate
 		// on the keys and values from the components object
@@ -485,9 +468,9 @@ namespace Gameplay {
 		nlohmann::json result = {
 			{ "name", Name },
 			{ "guid", _guid.str() },
-			{ "position", _position },
-			{ "rotation", _rotation },
-			{ "scale",    _scale },
+			{ "position", GetPosition() },
+			{ "rotation", GetRotation() },
+			{ "scale",    GetScale() },
 			{ "parent",   parent == nullptr ? "null" : parent->_guid.str() },
 			{ "hide_in_inspector", HideInHierarchy }
 		};
@@ -12,6 +12,8 @@
 #include "Gameplay/Components/IComponent.h"
 #include "Gameplay/Components/ComponentManager.h"
 #include "Utils/ResourceManager/IResource.h"
+#include "Gameplay/TransformStore.h"
+#include "Utils/DynamicAabbTree.h"
 
 class InspectorWindow;
 class HierarchyWindow;
@@ -133,6 +135,8 @@ namespace Gameplay {
 			void Reset();
 		};
 
+		virtual ~GameObject();
+
 		// Human readable name for the object
 		std::string             Name;
 
@@ -220,9 +224,30 @@ namespace Gameplay {
 		/// This matrix transforms points from world space to local space
 		/// </summary>
 		const glm::mat4& GetInverseTransform() const;
+		/// <summary>
+		/// Gets the matrix for transforming normals from local space to world space
+		/// </summary>
+		const glm::mat3& GetNormalMatrix() const;
 
 		const glm::mat4& GetLocalTransform() const;
-		const glm::mat4& GetInverseLocalTransform() const;
+		glm::mat4 GetInverseLocalTransform() const;
+
+		/// <summary>
+		/// Gets the world space box around this object that the scene's spatial queries use. This is the
+		/// render component's mesh bounds if there is one, otherwise just the object's position
+		/// </summary>
+		const AABB& GetWorldBounds() const { return _worldBounds; }
+		/// <summary>
+		/// Returns false if the object draws a mesh that has no bounds, in which case it's world bounds
+		/// are made big enough to pass every query
+		/// </summary>
+		bool HasBounds() const { return !_unbounded; }
+		/// <summary>
+		/// Recalculates the world bounds and moves this object in the scene's spatial tree. The scene
+		/// does this for anything who's transform changed, but this needs to be called by hand when
+		/// the bounds change some other way (ex: the render component's mesh is swapped)
+		/// </summary>
+		void UpdateBounds();
 
 		/// <summary>
 		/// Allows components to render GUI elements to the screen
@@ -281,6 +306,22 @@ namespace Gameplay {
 
 		std::shared_ptr<IComponent> Get(const std::type_index& type);
 
+		/// <summary>
+		/// Invokes a callback for every component of the given type on this gameobject. Components loaded
+		/// from a scene file are not limited to one per type, so use this instead of Get when every
+		/// instance matters
+		/// </summary>
+		/// <typeparam name="T">The type of component to search for</typeparam>
+		/// <param name="callback">The callback to invoke, taking a const std::shared_ptr<T>&</param>
+		template <typename T, typename TCallback, typename = typename std::enable_if<std::is_base_of<IComponent, T>::value>::type>
+		void Each(TCallback&& callback) {
+			for (const auto& ptr : _components) {
+				if (std::type_index(typeid(*ptr.get())) == std::type_index(typeid(T))) {
+					callback(std::static_pointer_cast<T>(ptr));
+				}
+			}
+		}
+
 		/// <summary>
 		/// Adds a component of the given type to this gameobject. Note that only one component
 		/// of a given type may be attached to a gameobject
@@ -337,21 +378,16 @@ namespace Gameplay {
 		friend class InspectorWindow;
 		friend class HierarchyWindow;
 
-		// Rotation of the object as a quaternion
-		glm::quat _rotation;
-		// Position of the object
-		glm::vec3 _position;
-		// The scale of the object
-		glm::vec3 _scale;
+		// The object's position, rotation, scale and cached matrices live in the scene's
+		// transform store, so they can be updated in one pass for the whole scene
+		TransformStore::Sptr   _transforms;
+		TransformStore::Handle _transformHandle;
 
-		// The object's world transform
-		mutable glm::mat4 _localTransform;
-		mutable glm::mat4 _inverseLocalTransform;
-		mutable bool _isLocalTransformDirty;
-
-		mutable glm::mat4 _worldTransform;
-		mutable glm::mat4 _inverseWorldTransform;
-		mutable bool _isWorldTransformDirty;
+		// Our entry in the scene's spatial tree, along with the tight bounds the fat box was made from
+		DynamicAabbTree::Sptr    _spatialTree;
+		DynamicAabbTree::ProxyId _spatialProxy;
+		AABB                     _worldBounds;
+		bool                     _unbounded;
 
 		// For the hierarchy
 		WeakRef _parent;
@@ -369,11 +405,8 @@ namespace Gameplay {
 		/// <summary>
 		/// Only scenes will be allowed to create gameobjects
 		/// </summary>
-		GameObject();
-
-		// Recalculates the transform matrix for the object when required
-		void _RecalcLocalTransform() const;
-		void _RecalcWorldTransform() const;
+		/// <param name="scene">The scene that the object belongs to</param>
+		GameObject(Scene* scene);
 
 		void _PurgeDeletedChildren();
 	};
@@ -8,11 +8,26 @@
 #include "Graphics/Textures/Texture1D.h"
 #include "Graphics/Textures/Texture3D.h"
 
+#include <map>
+#include <algorithm>
+
 namespace Gameplay {
 	Material::Material(const ShaderProgram::Sptr& shader) :
 		IResource(),
 		_shader(shader),
-		_uniforms(std::unordered_map<std::string, UniformData>())
+		_uniforms(std::unordered_map<std::string, UniformData>()),
+		_renderId(__NextRenderId++),
+		_textureArrayUniform(""),
+		_textureLayer(-1),
+		_batchId(0),
+		_batchIdDirty(true),
+		_blockData(std::vector<uint8_t>()),
+		_uniformBlock(nullptr),
+		_textureBindings(std::vector<TextureBinding>()),
+		_looseUniforms(std::vector<UniformData*>()),
+		_programBindings(std::vector<ProgramBinding>()),
+		_bindingsDirty(true),
+		_blockDirty(true)
 	{
 		_PopulateUniforms();
 	}
@@ -20,13 +35,37 @@ namespace Gameplay {
 	Material::Material() :
 		IResource(),
 		_shader(nullptr),
-		_uniforms(std::unordered_map<std::string, UniformData>())
+		_uniforms(std::unordered_map<std::string, UniformData>()),
+		_renderId(__NextRenderId++),
+		_textureArrayUniform(""),
+		_textureLayer(-1),
+		_batchId(0),
+		_batchIdDirty(true),
+		_blockData(std::vector<uint8_t>()),
+		_uniformBlock(nullptr),
+		_textureBindings(std::vector<TextureBinding>()),
+		_looseUniforms(std::vector<UniformData*>()),
+		_programBindings(std::vector<ProgramBinding>()),
+		_bindingsDirty(true),
+		_blockDirty(true)
 	{ }
 
+	Material::~Material() {
+		std::lock_guard<std::mutex> lock(_batchIdMutex);
+		_ReleaseBatchId();
+	}
+
 	void Material::Set(const std::string& name, ShaderDataType type, const void* value, size_t arraySize)
 	{
 		// Try and find the matching uniform
 		UniformData& uniform = _GetUniform(name);
+		_batchIdDirty = true;
+
+		// Setting a regular value replaces any texture array we were using
+		if (name == _textureArrayUniform) {
+			_textureArrayUniform.clear();
+			_textureLayer = -1;
+		}
 
 		// We have a uniform, let's see if we can update it
 		if (uniform.Location != -2) {
@@ -48,6 +87,7 @@ namespace Gameplay {
 				else {
 					memcpy(uniform.Value, value, ShaderDataTypeSize(type));
 				}
+				_blockDirty |= uniform.BlockOffset >= 0;
 			}
 		}
 		// We couldn't find that uniform, log a warning
@@ -60,40 +100,95 @@ namespace Gameplay {
 		return _shader;
 	}
 
-	void Material::Apply() {
-		if (_shader != nullptr) {
-			// Skip the reserved # of texture slots
-			int textureSlot = 0;
-			
-			// Iterate over the uniforms map
-			for (auto&[name, data] : _uniforms) {
-				// The typecode is basically the underlying type of the uniform
-				// ex: float, matrix, texture, etc...
-				ShaderDataTypecode typeCode = GetShaderDataTypeCode(data.Type);
-
-				// If the uniform is a texture, we try and bind it, then move to the next slot
-				if (typeCode == ShaderDataTypecode::Texture) {
-					if (textureSlot >= MAX_TEXTURE_SLOTS) {
-						LOG_WARN("Ignoring material binding, exceeds allowed number of textures");
-					}
-					else {
-						ITexture::Sptr texture = data.TextureAsset;
-						if (texture != nullptr) {
-							texture->Bind(textureSlot);
-						}
-						else {
-							ITexture::Unbind(textureSlot);
-						}
-						// Send the slot to the shader
-						_shader->SetUniform(data.Location, data.Type, &textureSlot);
-						textureSlot++;
-					}
-				}
-				// The uniform is a plain ol' value type, send it in
-				else {
-					_shader->SetUniform(data.Location, data.Type, data.ArraySize > 1 ? data.ArrayBlock : data.Value, data.ArraySize);
+	uint32_t Material::GetRenderId() const {
+		return _renderId;
+	}
+
+	uint32_t Material::GetBatchId() const {
+		if (_batchIdDirty) {
+			std::lock_guard<std::mutex> lock(_batchIdMutex);
+			// Another thread may have gotten here first
+			if (!_batchIdDirty) {
+				return _batchId;
+			}
+
+			// The serialized parameters already cover everything Apply sends to the shader, and texture
+			// arrays are stored by GUID, so materials on different layers of the same array still match
+			std::string key = std::to_string(reinterpret_cast<uintptr_t>(_shader.get())) + ToJson()["parameters"].dump();
+			if (key != _batchKey) {
+				_ReleaseBatchId();
+				auto it = _batchIdTable.find(key);
+				if (it == _batchIdTable.end()) {
+					it = _batchIdTable.emplace(key, BatchIdEntry{ _nextBatchId++, 0 }).first;
 				}
+				it->second.Users++;
+				_batchId = it->second.Id;
+				_batchKey = std::move(key);
 			}
+			_batchIdDirty = false;
+		}
+		return _batchId;
+	}
+
+	void Material::_ReleaseBatchId() const {
+		if (_batchKey.empty()) {
+			return;
+		}
+		auto it = _batchIdTable.find(_batchKey);
+		if (it != _batchIdTable.end() && --it->second.Users == 0) {
+			_batchIdTable.erase(it);
+		}
+		_batchKey.clear();
+	}
+
+	void Material::SetTextureArray(const std::string& name, const Texture2DArray::Sptr& texture, int layer) {
+		UniformData& uniform = _GetUniform(name);
+		if (uniform.Location < 0 || !uniform.IsTextureResource()) {
+			LOG_WARN("Failed to set texture array \"{}\" in material \"{}\", shader texture not found", name, Name);
+			return;
+		}
+
+		uniform.TextureAsset = texture;
+		_textureArrayUniform = texture != nullptr ? name : "";
+		_textureLayer = texture != nullptr ? layer : -1;
+		_batchIdDirty = true;
+	}
+
+	void Material::Apply() {
+		Apply(_shader);
+	}
+
+	void Material::Apply(const ShaderProgram::Sptr& shader) {
+		if (shader == nullptr) {
+			return;
+		}
+
+		if (_bindingsDirty) {
+			_CompileBindings();
+		}
+		if (_blockDirty) {
+			_UploadBlock();
+		}
+
+		// All our value parameters go out with a single bind
+		if (_uniformBlock != nullptr) {
+			_uniformBlock->Bind(UNIFORM_BLOCK_BINDING);
+		}
+
+		// The program remembers which unit each sampler reads from, so we only need to bind the textures
+		const ProgramBinding& program = _GetProgramBinding(shader);
+		for (const TextureBinding& binding : _textureBindings) {
+			if (binding.Data->TextureAsset != nullptr) {
+				binding.Data->TextureAsset->Bind(binding.Slot);
+			} else {
+				ITexture::Unbind(binding.Slot);
+			}
+		}
+
+		// Anything that isn't in the uniform block is program state that other materials may have changed
+		for (size_t ix = 0; ix < _looseUniforms.size(); ix++) {
+			UniformData* data = _looseUniforms[ix];
+			shader->SetUniform(program.Locations[ix], data->Type, data->ArraySize > 1 ? data->ArrayBlock : data->Value, data->ArraySize);
 		}
 	}
 
@@ -106,10 +201,16 @@ namespace Gameplay {
 
 		if (open) {
 			ImGui::Text("Shader: %s", _shader != nullptr ? _shader->GetDebugName().c_str() : "null");
+			if (_textureLayer >= 0) {
+				ImGui::Text("Texture Array: %s (layer %d)", _textureArrayUniform.c_str(), _textureLayer);
+			}
 			// Draw all of our valid uniforms
 			for (auto&[key, value] : _uniforms) {
 				if (value.Location != -2 && value.Location != -1) {
-					value.RenderImGui();
+					if (value.RenderImGui()) {
+						_batchIdDirty = true;
+						_blockDirty |= value.BlockOffset >= 0;
+					}
 				}
 			}
 
@@ -138,13 +239,33 @@ namespace Gameplay {
 		if (data.contains("parameters") && data["parameters"].is_object()) {
 			// Iterate over all objects
 			for (auto& [key, value] : data["parameters"].items()) {
+				// Materials saved before their shader moved to the uniform block still have their textures under
+				// the block's instance name (ex: u_Material.Diffuse), so we point those at the texture struct
+				std::string name = key;
+				ShaderProgram::UniformInfo info;
+				int blockOffset = -1;
+				if (!_FindUniform(result->_shader, name, info, blockOffset) && name.compare(0, UNIFORM_BLOCK_INSTANCE.size() + 1, UNIFORM_BLOCK_INSTANCE + ".") == 0) {
+					name = TEXTURE_STRUCT_INSTANCE + name.substr(UNIFORM_BLOCK_INSTANCE.size());
+				}
+
 				// Try loading a uniform from the blob, if successful, store it
-				Material::UniformData uniform = Material::UniformData::FromJson(value, key, result->_shader);
+				Material::UniformData uniform = Material::UniformData::FromJson(value, name, result->_shader);
 				if (uniform.Location != -2) {
-					result->_uniforms[key] = uniform;
+					result->_uniforms[name] = uniform;
 				}
 			}
 		}
+		result->_bindingsDirty = true;
+
+		// Texture arrays are stored like any other texture parameter, we just need to know which layer to use
+		if (data.contains("texture_array") && data["texture_array"].is_object()) {
+			std::string uniform = JsonGet<std::string>(data["texture_array"], "uniform", "");
+			int layer = JsonGet(data["texture_array"], "layer", -1);
+			if (layer >= 0 && data["parameters"].contains(uniform)) {
+				Texture2DArray::Sptr texture = ResourceManager::Get<Texture2DArray>(Guid(data["parameters"][uniform]["value"].get<std::string>()));
+				result->SetTextureArray(uniform, texture, layer);
+			}
+		}
 		return result;
 	}
 
@@ -163,6 +284,129 @@ namespace Gameplay {
 			}
 		}
 
+		if (_textureLayer >= 0) {
+			result["texture_array"] ={
+				{ "uniform", _textureArrayUniform },
+				{ "layer",   _textureLayer }
+			};
+		}
+
+		return result;
+	}
+
+	std::vector<Texture2DArray::Sptr> Material::PackTextureArrays(const std::vector<Material::Sptr>& materials) {
+		struct Candidate {
+			Material*       Target;
+			std::string     Uniform;
+			Texture2D::Sptr Texture;
+		};
+
+		// Group the materials by everything that needs to match for their textures to share an array
+		std::map<std::string, std::vector<Candidate>> groups;
+		for (const Material::Sptr& material : materials) {
+			if (material == nullptr || material->_shader == nullptr || material->_textureLayer >= 0) {
+				continue;
+			}
+
+			// A material can only have one layer, so we can only pack materials with a single 2D texture
+			const UniformData* textureUniform = nullptr;
+			int textureCount = 0;
+			for (auto& [name, data] : material->_uniforms) {
+				if (data.Location >= 0 && data.Type == ShaderDataType::Tex2D) {
+					textureUniform = &data;
+					textureCount++;
+				}
+			}
+			Texture2D::Sptr texture = textureUniform != nullptr ? std::dynamic_pointer_cast<Texture2D>(textureUniform->TextureAsset) : nullptr;
+			if (textureCount != 1 || texture == nullptr || texture->GetFormat() == InternalFormat::Unknown || texture->GetDescription().MultisampleCount > 1) {
+				continue;
+			}
+
+			// Make sure the shader actually knows how to sample the texture as an array
+			const ShaderProgram::Sptr& variant = material->_shader->GetVariant({ TEXTURE_ARRAY_DEFINE });
+			ShaderProgram::UniformInfo info;
+			if (variant == nullptr || !variant->FindUniform(textureUniform->Name, &info) || info.Type != ShaderDataType::Tex2D_Array) {
+				continue;
+			}
+
+			const Texture2DDescription& descr = texture->GetDescription();
+			std::string key =
+				std::to_string(reinterpret_cast<uintptr_t>(material->_shader.get())) + "|" + textureUniform->Name + "|" +
+				std::to_string(descr.Width) + "x" + std::to_string(descr.Height) + "|" + ~descr.Format + "|" +
+				~descr.HorizontalWrap + "|" + ~descr.VerticalWrap + "|" + ~descr.MinificationFilter + "|" +
+				~descr.MagnificationFilter + "|" + std::to_string(descr.MaxAnisotropic) + "|" + (descr.GenerateMipMaps ? "mips" : "");
+			groups[key].push_back({ material.get(), textureUniform->Name, texture });
+		}
+
+		std::vector<Texture2DArray::Sptr> result;
+		const size_t maxLayers = static_cast<size_t>(glm::max(ITexture::GetLimits().MAX_ARRAY_TEXTURE_LAYERS, 1));
+		for (auto& [key, candidates] : groups) {
+			// Materials sharing a texture can share a layer too
+			std::vector<Texture2D::Sptr> textures;
+			std::unordered_map<Texture2D*, size_t> textureIndices;
+			for (const Candidate& candidate : candidates) {
+				if (textureIndices.find(candidate.Texture.get()) == textureIndices.end()) {
+					textureIndices[candidate.Texture.get()] = textures.size();
+					textures.push_back(candidate.Texture);
+				}
+			}
+
+			// There's nothing to gain from an array with a single layer
+			if (textures.size() < 2) {
+				continue;
+			}
+
+			// Split into multiple arrays if we have more textures than the renderer allows layers
+			std::vector<Texture2DArray::Sptr> arrays;
+			for (size_t first = 0; first < textures.size(); first += maxLayers) {
+				size_t count = glm::min(textures.size() - first, maxLayers);
+				const Texture2DDescription& source = textures[first]->GetDescription();
+
+				Texture2DArrayDescription descr;
+				descr.Width               = source.Width;
+				descr.Height              = source.Height;
+				descr.Layers              = static_cast<uint32_t>(count);
+				descr.Format              = source.Format;
+				descr.HorizontalWrap      = source.HorizontalWrap;
+				descr.VerticalWrap        = source.VerticalWrap;
+				descr.MinificationFilter  = source.MinificationFilter;
+				descr.MagnificationFilter = source.MagnificationFilter;
+				descr.MaxAnisotropic      = source.MaxAnisotropic;
+				descr.GenerateMipMaps     = source.GenerateMipMaps;
+				descr.FormatHint          = source.FormatHint;
+
+				// Layers that came from files get loaded from them, so the array can be re-created from the manifest
+				bool needsCopy = false;
+				for (size_t ix = first; ix < first + count; ix++) {
+					descr.Filenames.push_back(textures[ix]->GetDescription().Filename);
+					needsCopy |= descr.Filenames.back().empty();
+				}
+
+				Texture2DArray::Sptr array = ResourceManager::CreateAsset<Texture2DArray>(descr);
+				array->SetDebugName("Texture Array (" + key + ")");
+
+				// Generated textures don't have a file, so they get copied straight from the GPU
+				if (needsCopy) {
+					for (size_t ix = first; ix < first + count; ix++) {
+						if (descr.Filenames[ix - first].empty()) {
+							array->CopyLayer(static_cast<uint32_t>(ix - first), textures[ix]);
+						}
+					}
+					array->UpdateMipMaps();
+				}
+
+				arrays.push_back(array);
+				result.push_back(array);
+			}
+
+			for (const Candidate& candidate : candidates) {
+				size_t index = textureIndices[candidate.Texture.get()];
+				candidate.Target->SetTextureArray(candidate.Uniform, arrays[index / maxLayers], static_cast<int>(index % maxLayers));
+			}
+
+			LOG_INFO("Packed {} textures for {} materials into {} texture array(s)", textures.size(), candidates.size(), arrays.size());
+		}
+
 		return result;
 	}
 
@@ -170,8 +414,11 @@ namespace Gameplay {
 	{
 		UniformData& data = _uniforms[name];
 		if (data.Location == -2) {
+			_bindingsDirty = true;
+
 			ShaderProgram::UniformInfo uniform;
-			if (_shader->FindUniform(name, &uniform)) {
+			int blockOffset = -1;
+			if (_FindUniform(_shader, name, uniform, blockOffset)) {
 				// Ignoring our reserved textures
 				if (GetShaderDataTypeCode(uniform.Type) == ShaderDataTypecode::Texture && uniform.Binding >= MAX_TEXTURE_SLOTS) {
 					data.Location = -1;
@@ -192,6 +439,169 @@ namespace Gameplay {
 		for (const auto& [key, value] : uniforms) {
 			_uniforms[key] = _GetUniform(key);
 		}
+
+		// Members of the uniform block go by the block's instance name instead
+		auto block = _shader->GetUniformBlocks().find(UNIFORM_BLOCK_NAME);
+		if (block != _shader->GetUniformBlocks().end()) {
+			for (const ShaderProgram::UniformInfo& member : block->second.SubUniforms) {
+				std::string name = UNIFORM_BLOCK_INSTANCE + member.Name.substr(UNIFORM_BLOCK_NAME.size());
+				_uniforms[name] = _GetUniform(name);
+			}
+		}
+		_bindingsDirty = true;
+	}
+
+	bool Material::_FindUniform(const ShaderProgram::Sptr& shader, const std::string& name, ShaderProgram::UniformInfo& info, int& blockOffset) {
+		blockOffset = -1;
+		if (shader == nullptr) {
+			return false;
+		}
+		if (shader->FindUniform(name, &info)) {
+			return true;
+		}
+
+		// The shader reports block members by the block's name (ex: b_Material.Shininess), but we set them by the
+		// instance name (ex: u_Material.Shininess) so they read the same as they do in GLSL
+		const std::string prefix = UNIFORM_BLOCK_INSTANCE + ".";
+		if (name.compare(0, prefix.size(), prefix) != 0) {
+			return false;
+		}
+		auto block = shader->GetUniformBlocks().find(UNIFORM_BLOCK_NAME);
+		if (block == shader->GetUniformBlocks().end()) {
+			return false;
+		}
+		const std::string memberName = UNIFORM_BLOCK_NAME + "." + name.substr(prefix.size());
+		for (const ShaderProgram::UniformInfo& member : block->second.SubUniforms) {
+			if (member.Name == memberName) {
+				info = member;
+				blockOffset = member.Location;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/// <summary>
+	/// Copies a value into a std140 uniform block, where array elements and matrix columns are each padded out to a vec4
+	/// </summary>
+	static void WriteStd140(uint8_t* dest, ShaderDataType type, const void* value, size_t arraySize) {
+		ShaderDataTypecode typeCode = GetShaderDataTypeCode(type);
+		uint32_t rows = (uint32_t)type & ShaderDataType_Size1Mask;
+		uint32_t columns = typeCode == ShaderDataTypecode::Matrix ? ((uint32_t)type & ShaderDataType_Size2Mask) >> 3 : 1;
+		if (typeCode != ShaderDataTypecode::Float && typeCode != ShaderDataTypecode::Int && typeCode != ShaderDataTypecode::Uint &&
+			typeCode != ShaderDataTypecode::Matrix && typeCode != ShaderDataTypecode::Bool) {
+			LOG_WARN("Cannot store {} in a material uniform block", ~type);
+			return;
+		}
+
+		const uint8_t* source = reinterpret_cast<const uint8_t*>(value);
+		const bool padded = columns > 1 || arraySize > 1;
+		for (size_t element = 0; element < arraySize; element++) {
+			for (uint32_t column = 0; column < columns; column++) {
+				// GLSL bools take up 4 bytes each in a block
+				if (typeCode == ShaderDataTypecode::Bool) {
+					for (uint32_t row = 0; row < rows; row++) {
+						reinterpret_cast<uint32_t*>(dest)[row] = source[row] ? 1 : 0;
+					}
+					source += rows;
+				} else {
+					memcpy(dest, source, rows * 4);
+					source += rows * 4;
+				}
+				dest += padded ? 16 : rows * 4;
+			}
+		}
+	}
+
+	void Material::_CompileBindings() {
+		_textureBindings.clear();
+		_looseUniforms.clear();
+		_programBindings.clear();
+		_blockDirty = true;
+		if (_shader == nullptr) {
+			return;
+		}
+
+		auto block = _shader->GetUniformBlocks().find(UNIFORM_BLOCK_NAME);
+		if (block != _shader->GetUniformBlocks().end()) {
+			size_t size = static_cast<size_t>(block->second.SizeInBytes);
+			if (_uniformBlock == nullptr || _blockData.size() != size) {
+				_blockData.assign(size, 0);
+				_uniformBlock = std::make_shared<AbstractUniformBuffer>(static_cast<uint32_t>(size));
+			}
+		} else {
+			_blockData.clear();
+			_uniformBlock = nullptr;
+		}
+
+		// Texture units come from the shader's samplers rather than our parameters, so that every material
+		// using the shader hands out the same units, sorted so it doesn't depend on hash order
+		std::vector<std::string> samplers;
+		for (const auto& [name, info] : _shader->GetUniforms()) {
+			if (GetShaderDataTypeCode(info.Type) == ShaderDataTypecode::Texture && info.Binding < MAX_TEXTURE_SLOTS) {
+				samplers.push_back(name);
+			}
+		}
+		std::sort(samplers.begin(), samplers.end());
+		if (samplers.size() > MAX_TEXTURE_SLOTS) {
+			LOG_WARN("Ignoring {} textures in material \"{}\", exceeds allowed number of textures", samplers.size() - MAX_TEXTURE_SLOTS, Name);
+			samplers.resize(MAX_TEXTURE_SLOTS);
+		}
+		for (const std::string& name : samplers) {
+			UniformData& data = _GetUniform(name);
+			_textureBindings.push_back({ &data, static_cast<int>(_textureBindings.size()) });
+		}
+
+		for (auto& [name, data] : _uniforms) {
+			if (data.Location >= 0 && data.BlockOffset < 0 && !data.IsTextureResource()) {
+				_looseUniforms.push_back(&data);
+			}
+		}
+
+		// Looking up our samplers may have added uniforms, we already have pointers to them so that's fine
+		_bindingsDirty = false;
+	}
+
+	void Material::_UploadBlock() {
+		_blockDirty = false;
+		if (_uniformBlock == nullptr) {
+			return;
+		}
+
+		for (const auto& [name, data] : _uniforms) {
+			if (data.Location >= 0 && data.BlockOffset >= 0 && static_cast<size_t>(data.BlockOffset) < _blockData.size()) {
+				WriteStd140(&_blockData[data.BlockOffset], data.Type, data.ArraySize > 1 ? data.ArrayBlock : data.Value, glm::max(data.ArraySize, (size_t)1));
+			}
+		}
+		_uniformBlock->LoadData(_blockData.data(), static_cast<uint32_t>(_blockData.size()), 1);
+	}
+
+	const Material::ProgramBinding& Material::_GetProgramBinding(const ShaderProgram::Sptr& shader) {
+		for (const ProgramBinding& binding : _programBindings) {
+			if (binding.Program == shader.get()) {
+				return binding;
+			}
+		}
+
+		// Variants are built from the same source, but the linker is free to move uniforms around
+		auto locationOf = [&](const UniformData* data) {
+			if (shader == _shader) {
+				return data->Location;
+			}
+			ShaderProgram::UniformInfo info;
+			return shader->FindUniform(data->Name, &info) ? info.Location : -1;
+		};
+
+		ProgramBinding& result = _programBindings.emplace_back();
+		result.Program = shader.get();
+		for (const TextureBinding& binding : _textureBindings) {
+			int slot = binding.Slot;
+			shader->SetUniform(locationOf(binding.Data), binding.Data->Type, &slot);
+		}
+		for (const UniformData* data : _looseUniforms) {
+			result.Locations.push_back(locationOf(data));
+		}
+		return result;
 	}
 
 	bool Material::UniformData::RenderImGui() {
@@ -304,6 +714,7 @@ namespace Gameplay {
 							ImGui::Image((ImTextureID)tex->GetHandle(), ImVec2(ImGui::GetTextLineHeight() * 2, ImGui::GetTextLineHeight() * 2));
 							if (ImGuiHelper::ResourceDragTarget<Texture2D>(tex)) {
 								TextureAsset = tex;
+								modified = true;
 							}
 						}
 					}
@@ -403,9 +814,11 @@ namespace Gameplay {
 	{
 		// We extract the uniform info from the shader to populate our info
 		ShaderProgram::UniformInfo uniform;
-		if (shader != nullptr && shader->FindUniform(uniformName, &uniform)) {
+		int blockOffset = -1;
+		if (Material::_FindUniform(shader, uniformName, uniform, blockOffset)) {
 			Name = uniformName;
 			Location = uniform.Location;
+			BlockOffset = blockOffset;
 			Type = uniform.Type;
 			ArraySize = uniform.ArraySize;
 			BindingSlot = uniform.Binding;
@@ -422,6 +835,7 @@ namespace Gameplay {
 	{
 		Name = other.Name;
 		Location = other.Location;
+		BlockOffset = other.BlockOffset;
 		ArraySize = other.ArraySize;
 		Type = other.Type;
 
@@ -440,9 +854,10 @@ namespace Gameplay {
 	Material::UniformData::UniformData(UniformData&& other) :
 		TextureAsset(nullptr) 
 	{
-		Name      = other.Name;
-		Location  = other.Location;
-		ArraySize = other.ArraySize;
+		Name        = other.Name;
+		Location    = other.Location;
+		BlockOffset = other.BlockOffset;
+		ArraySize   = other.ArraySize;
 		Type      = other.Type;
 
 		if (GetShaderDataTypeCode(Type) == ShaderDataTypecode::Texture) {
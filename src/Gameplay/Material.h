@@ -1,7 +1,11 @@
 #pragma once
 #include <memory>
+#include <atomic>
+#include <mutex>
 #include "Graphics/ShaderProgram.h"
+#include "Graphics/Buffers/UniformBuffer.h"
 #include "Graphics/Textures/ITexture.h"
+#include "Graphics/Textures/Texture2DArray.h"
 
 namespace Gameplay {
 	/// <summary>
@@ -12,6 +16,9 @@ namespace Gameplay {
 	public:
 		typedef std::shared_ptr<Material> Sptr;
 		typedef std::weak_ptr<Material>   Wptr;
+		// Each material holds a reference to it's batch ID, see GetBatchId
+		NO_COPY(Material);
+		NO_MOVE(Material);
 
 		/// <summary>
 		/// We'll sometimes want to reserve some texture slots for shared textures, such
@@ -19,6 +26,26 @@ namespace Gameplay {
 		/// </summary>
 		static const int MAX_TEXTURE_SLOTS = 14;
 
+		/// <summary>
+		/// The define that switches a shader's material texture over to a sampler2DArray, with the
+		/// layer coming from the instance data (see frag_blinn_phong_textured.glsl)
+		/// </summary>
+		inline static const std::string TEXTURE_ARRAY_DEFINE = "TEXTURE_ARRAY";
+
+		/// <summary>
+		/// The std140 uniform block that holds a material's non-texture parameters, see Apply. The block should be
+		/// declared with UNIFORM_BLOCK_INSTANCE as it's instance name, and it's members are set the same way they are
+		/// accessed in GLSL (ex: "u_Material.Shininess"). Shaders without the block have their parameters set one at a time
+		/// </summary>
+		inline static const std::string UNIFORM_BLOCK_NAME = "b_Material";
+		inline static const std::string UNIFORM_BLOCK_INSTANCE = "u_Material";
+		static const int UNIFORM_BLOCK_BINDING = 4;
+		/// <summary>
+		/// Samplers can't live in the uniform block, so shaders with the block keep their textures in a struct
+		/// with this instance name (ex: "u_Textures.Diffuse")
+		/// </summary>
+		inline static const std::string TEXTURE_STRUCT_INSTANCE = "u_Textures";
+
 		/// <summary>
 		/// A human readable name for the material
 		/// </summary>
@@ -33,6 +60,7 @@ namespace Gameplay {
 		/// </summary>
 		/// <param name="shader">The shader for the material</param>
 		Material(const ShaderProgram::Sptr& shader);
+		virtual ~Material();
 
 		/// <summary>
 		/// Sets a material parameter with the given name and type
@@ -60,11 +88,42 @@ namespace Gameplay {
 		/// </summary>
 		const ShaderProgram::Sptr& GetShader() const;
 
+		/// <summary>
+		/// Gets a small runtime identifier for this material, used when building render
+		/// sort keys. Not persistent between runs, use the GUID for serialization
+		/// </summary>
+		uint32_t GetRenderId() const;
+		/// <summary>
+		/// Gets an identifier shared by all materials with the same shader and parameters, the renderer
+		/// only needs to apply one of them for the whole group. Materials that only differ by their texture
+		/// array layer share a batch ID, since the layer is sent per draw
+		/// </summary>
+		uint32_t GetBatchId() const;
+
+		/// <summary>
+		/// Points a texture parameter at a layer of a texture array. The material must be drawn with
+		/// it's shader's TEXTURE_ARRAY_DEFINE variant, which the render layer handles automatically
+		/// </summary>
+		/// <param name="name">The name of the texture parameter</param>
+		/// <param name="texture">The texture array to use</param>
+		/// <param name="layer">The layer within the array that this material samples from</param>
+		void SetTextureArray(const std::string& name, const Texture2DArray::Sptr& texture, int layer);
+		/// <summary>
+		/// Gets the texture array layer this material samples from, or -1 if it does not use a texture array
+		/// </summary>
+		int GetTextureLayer() const { return _textureLayer; }
+
 		/// <summary>
 		/// Handles applying this material's state to the OpenGL pipeline
-		/// Will bind the shader, update material uniforms, and bind textures
+		/// Will bind the material's uniform block and textures, re-uploading the block if any parameters have changed
 		/// </summary>
 		virtual void Apply();
+		/// <summary>
+		/// Applies this material's state to a variant of it's shader (ex: the instanced variant)
+		/// Uniform locations are looked up by name the first time a variant is used, since variants may be linked differently
+		/// </summary>
+		/// <param name="shader">The shader variant to apply the material parameters to</param>
+		void Apply(const ShaderProgram::Sptr& shader);
 
 		/// <summary>
 		/// Renders some UI controls for manipulating a material at runtime
@@ -86,6 +145,16 @@ namespace Gameplay {
 		/// </summary>
 		nlohmann::json ToJson() const;
 
+		/// <summary>
+		/// Packs the textures of the given materials into texture arrays, and points the materials at their layers.
+		/// Materials are packed if they have a single 2D texture, and their shader supports TEXTURE_ARRAY_DEFINE.
+		/// Textures are grouped by shader, parameter, size, format and sampler settings, so each group
+		/// gets it's own array. Textures that would end up alone in an array are left as they are
+		/// </summary>
+		/// <param name="materials">The materials to pack</param>
+		/// <returns>The texture arrays that were created, which are also added to the resource manager</returns>
+		static std::vector<Texture2DArray::Sptr> PackTextureArrays(const std::vector<Material::Sptr>& materials);
+
 	protected:
 		/// <summary>
 		/// Represents a single uniform that the material will control
@@ -95,6 +164,8 @@ namespace Gameplay {
 			std::string    Name;
 			// Location of the uniform within the shader
 			int            Location = -2;
+			// Offset of the uniform within the material's uniform block, or -1 if it is a regular uniform
+			int            BlockOffset = -1;
 			union {
 				// A space to store non-array values, can store up to a dmat4
 				uint8_t        Value[128];
@@ -115,6 +186,7 @@ namespace Gameplay {
 			UniformData() :
 				Name("<unknown>"),
 				Location(-2),
+				BlockOffset(-1),
 				TextureAsset(nullptr),
 				ArraySize(0),
 				BindingSlot(-1),
@@ -174,8 +246,96 @@ namespace Gameplay {
 		/// The uniforms that the material will be modifying
 		/// </summary>
 		std::unordered_map<std::string, UniformData> _uniforms;
+		/// <summary>
+		/// Runtime ID for render sorting, see GetRenderId
+		/// </summary>
+		uint32_t               _renderId;
+		/// <summary>
+		/// The texture parameter that is using a texture array, and the layer it samples from (-1 for none)
+		/// </summary>
+		std::string            _textureArrayUniform;
+		int                    _textureLayer;
+		/// <summary>
+		/// Cached batch ID, recalculated when a parameter changes, see GetBatchId
+		/// The render layer reads it from worker threads, so the dirty flag is atomic
+		/// </summary>
+		mutable uint32_t          _batchId;
+		mutable std::atomic<bool> _batchIdDirty;
+		// The key our batch ID is stored under in _batchIdTable, empty if we don't have one yet
+		mutable std::string       _batchKey;
+
+		/// <summary>
+		/// A batch ID, and the number of materials that are currently using it
+		/// </summary>
+		struct BatchIdEntry {
+			uint32_t Id;
+			uint32_t Users;
+		};
+
+		/// <summary>
+		/// A texture parameter and the texture unit it is bound to. Units are assigned in order of the shader's
+		/// sampler names, so every material using a shader agrees on them
+		/// </summary>
+		struct TextureBinding {
+			UniformData* Data;
+			int          Slot;
+		};
+		/// <summary>
+		/// Where a shader (or one of it's variants) put the parameters that aren't in the uniform block
+		/// </summary>
+		struct ProgramBinding {
+			const ShaderProgram* Program;
+			std::vector<int>     Locations;
+		};
+
+		/// <summary>
+		/// The parameters in the uniform block, laid out as std140, and the buffer they are uploaded to
+		/// </summary>
+		std::vector<uint8_t>            _blockData;
+		AbstractUniformBuffer::Sptr     _uniformBlock;
+		std::vector<TextureBinding>     _textureBindings;
+		// Value parameters that aren't in the uniform block, and have to be sent with glProgramUniform
+		std::vector<UniformData*>       _looseUniforms;
+		std::vector<ProgramBinding>     _programBindings;
+		// True when the bindings above need to be rebuilt (ex: the shader has changed)
+		bool                            _bindingsDirty;
+		// True when a parameter in the uniform block has changed since it was last uploaded
+		bool                            _blockDirty;
+
+		inline static uint32_t __NextRenderId = 1;
+		// Maps a material's shader and parameters to the batch ID for them. Entries are removed once no
+		// material is using them, so this only ever holds the parameter sets of live materials
+		inline static std::unordered_map<std::string, BatchIdEntry> _batchIdTable;
+		inline static uint32_t _nextBatchId = 1;
+		// Guards _batchIdTable and recalculating a material's batch ID
+		inline static std::mutex _batchIdMutex;
 
 		UniformData& _GetUniform(const std::string& name);
 		void _PopulateUniforms();
+		/// <summary>
+		/// Drops our reference to our batch ID's entry in _batchIdTable, removing the entry if we were the last user.
+		/// The caller must hold _batchIdMutex
+		/// </summary>
+		void _ReleaseBatchId() const;
+		/// <summary>
+		/// Finds a uniform in the shader, including members of the material's uniform block
+		/// </summary>
+		/// <param name="shader">The shader to search</param>
+		/// <param name="name">The name of the parameter</param>
+		/// <param name="info">Receives the uniform info, for block members the location is it's offset in the block</param>
+		/// <param name="blockOffset">Receives the offset in the uniform block, or -1 if it is a regular uniform</param>
+		static bool _FindUniform(const ShaderProgram::Sptr& shader, const std::string& name, ShaderProgram::UniformInfo& info, int& blockOffset);
+		/// <summary>
+		/// Builds the uniform block and texture binding tables from the shader and our parameters
+		/// </summary>
+		void _CompileBindings();
+		/// <summary>
+		/// Copies all the uniform block parameters into the block, and uploads it
+		/// </summary>
+		void _UploadBlock();
+		/// <summary>
+		/// Gets the locations of our loose parameters in the given program, setting up it's texture units the first time it is seen
+		/// </summary>
+		const ProgramBinding& _GetProgramBinding(const ShaderProgram::Sptr& shader);
 	};
 }
\ No newline at end of file
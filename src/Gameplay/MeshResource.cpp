@@ -1,7 +1,11 @@
 #include "MeshResource.h"
 #include <filesystem>
+#include <algorithm>
 
 #include "Utils/ObjLoader.h"
+#ifdef OPTIMIZED_OBJ_LOADER
+#include "Utils/OptimizedObjLoader.h"
+#endif
 
 namespace Gameplay {
 	MeshResource::MeshResource() :
@@ -9,6 +13,7 @@ namespace Gameplay {
 		Filename(""),
 		MeshBuilderParams(std::vector<MeshBuilderParam>()),
 		Mesh(nullptr),
+		Lods(std::vector<VertexArrayObject::Sptr>()),
 		BulletTriMesh(nullptr)
 	{ }
 
@@ -17,9 +22,21 @@ namespace Gameplay {
 		Filename(filename),
 		MeshBuilderParams(std::vector<MeshBuilderParam>()),
 		Mesh(nullptr),
+		Lods(std::vector<VertexArrayObject::Sptr>()),
 		BulletTriMesh(nullptr)
 	{
+		#ifdef OPTIMIZED_OBJ_LOADER
+		Mesh = OptimizedObjLoader::LoadFromFile(filename, &Lods);
+		#else
 		Mesh = ObjLoader::LoadFromFile(filename);
+		#endif
+	}
+
+	const VertexArrayObject::Sptr& MeshResource::GetLod(int level) const {
+		if (level <= 0 || Lods.empty()) {
+			return Mesh;
+		}
+		return Lods[std::min(level, static_cast<int>(Lods.size())) - 1];
 	}
 
 	MeshResource::~MeshResource() = default;
@@ -56,7 +73,7 @@ namespace Gameplay {
 			result->Filename = JsonGet<std::string>(blob, "filename", "null");
 			if (result->Filename != "null" && std::filesystem::exists(result->Filename)) {
 				#ifdef OPTIMIZED_OBJ_LOADER
-				result->Mesh = OptimizedObjLoader::LoadFromFile(result->Filename);
+				result->Mesh = OptimizedObjLoader::LoadFromFile(result->Filename, &result->Lods);
 				#else
 				result->Mesh = ObjLoader::LoadFromFile(result->Filename);
 				#endif
@@ -73,6 +90,7 @@ namespace Gameplay {
 		}
 		MeshFactory::CalculateTBN(mesh);
 		Mesh = mesh.Bake();
+		Lods.clear();
 	}
 
 	void MeshResource::AddParam(const MeshBuilderParam & param) {
@@ -40,7 +40,12 @@ namespace Gameplay {
 		/// The VAO for rendering this mesh in OpenGL
 		/// </summary>
 		VertexArrayObject::Sptr         Mesh;
-
+		/// <summary>
+		/// Lower detail versions of the mesh, from most to least detailed. These share the vertex
+		/// buffer with Mesh and only have their own index buffers. Only meshes loaded from binary
+		/// files have LODs, for everything else this is empty
+		/// </summary>
+		std::vector<VertexArrayObject::Sptr> Lods;
 
 		/// <summary>
 		/// The optional mesh resource for generating colliders from this mesh
@@ -61,6 +66,17 @@ namespace Gameplay {
 		/// <param name="param">The parameter to add</param>
 		void AddParam(const MeshBuilderParam& param);
 
+		/// <summary>
+		/// Gets the number of detail levels for this mesh, including the full detail mesh
+		/// </summary>
+		int GetLodCount() const { return static_cast<int>(Lods.size()) + 1; }
+		/// <summary>
+		/// Gets the VAO for the given detail level, where 0 is the full detail mesh. Levels past
+		/// the end of the chain will return the least detailed LOD
+		/// </summary>
+		/// <param name="level">The detail level to get</param>
+		const VertexArrayObject::Sptr& GetLod(int level) const;
+
 		// Inherited from IResource
 
 		virtual nlohmann::json ToJson() const override;
@@ -0,0 +1,443 @@
+#include "PotentiallyVisibleSet.h"
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <map>
+#include <limits>
+#include <cstring>
+#include <Logging.h>
+#include <GLM/gtc/constants.hpp>
+
+#include "Gameplay/Scene.h"
+#include "Gameplay/GameObject.h"
+#include "Gameplay/Components/RenderComponent.h"
+
+#include "Graphics/VertexArrayObject.h"
+#include "Graphics/BoundingVolume.h"
+
+#include "Utils/ThreadPool.h"
+#include "Utils/FileHelpers.h"
+#include "Utils/JsonGlmHelpers.h"
+#include "Utils/Base64.h"
+
+namespace Gameplay {
+	namespace {
+		// A world space triangle, stored ready for ray intersection
+		struct BakeTriangle {
+			glm::vec3 V0;
+			glm::vec3 Edge1;
+			glm::vec3 Edge2;
+			uint32_t  Chunk;
+		};
+
+		/// <summary>
+		/// Reads a mesh back from the GPU and appends it's triangles in world space
+		/// </summary>
+		void ReadTriangles(VertexArrayObject& mesh, const glm::mat4& transform, uint32_t chunk, std::vector<BakeTriangle>& triangles) {
+			const VertexArrayObject::VertexDeclaration& vDecl = mesh.GetVDecl();
+			auto it = std::find_if(vDecl.begin(), vDecl.end(), [](const BufferAttribute& attrib) {
+				return attrib.Usage == AttribUsage::Position;
+			});
+			const VertexArrayObject::VertexBufferBinding* binding = mesh.GetBufferBinding(AttribUsage::Position);
+			if (it == vDecl.end() || binding == nullptr) {
+				return;
+			}
+			const BufferAttribute& posAttrib = *it;
+			const VertexBuffer::Sptr& vertexBuff = binding->GetBuffer();
+
+			std::vector<uint8_t> vertexStore(vertexBuff->GetTotalSize());
+			glGetNamedBufferSubData(vertexBuff->GetHandle(), 0, vertexBuff->GetTotalSize(), vertexStore.data());
+			auto getPosition = [&](uint32_t index) {
+				glm::vec3 pos = *reinterpret_cast<const glm::vec3*>(vertexStore.data() + (posAttrib.Stride * index) + posAttrib.Offset);
+				return glm::vec3(transform * glm::vec4(pos, 1.0f));
+			};
+
+			std::vector<uint32_t> indices;
+			IndexBuffer::Sptr indexBuff = mesh.GetIndexBuffer();
+			if (indexBuff != nullptr) {
+				std::vector<uint8_t> indexStore(indexBuff->GetTotalSize());
+				glGetNamedBufferSubData(indexBuff->GetHandle(), 0, indexBuff->GetTotalSize(), indexStore.data());
+				indices.reserve(indexBuff->GetElementCount());
+				for (uint32_t ix = 0; ix < indexBuff->GetElementCount(); ix++) {
+					switch (indexBuff->GetElementType()) {
+						case IndexType::UByte:
+							indices.push_back(indexStore[ix]);
+							break;
+						case IndexType::UShort:
+							indices.push_back(reinterpret_cast<const uint16_t*>(indexStore.data())[ix]);
+							break;
+						case IndexType::UInt:
+							indices.push_back(reinterpret_cast<const uint32_t*>(indexStore.data())[ix]);
+							break;
+						case IndexType::Unknown:
+						default:
+							indices.push_back(0);
+							break;
+					}
+				}
+			} else {
+				for (uint32_t ix = 0; ix < vertexBuff->GetElementCount(); ix++) {
+					indices.push_back(ix);
+				}
+			}
+
+			for (size_t ix = 0; ix + 2 < indices.size(); ix += 3) {
+				glm::vec3 p0 = getPosition(indices[ix]);
+				glm::vec3 p1 = getPosition(indices[ix + 1]);
+				glm::vec3 p2 = getPosition(indices[ix + 2]);
+				triangles.push_back({ p0, p1 - p0, p2 - p0, chunk });
+			}
+		}
+
+		/// <summary>
+		/// Moller-Trumbore ray/triangle intersection, returns the distance along the ray or a negative number on a miss.
+		/// Both sides of the triangle are hit, since we don't know which way chunks face
+		/// </summary>
+		float IntersectTriangle(const BakeTriangle& tri, const glm::vec3& origin, const glm::vec3& dir) {
+			const float EPSILON = 1e-7f;
+			glm::vec3 p = glm::cross(dir, tri.Edge2);
+			float det = glm::dot(tri.Edge1, p);
+			if (glm::abs(det) < EPSILON) {
+				return -1.0f;
+			}
+			float invDet = 1.0f / det;
+			glm::vec3 s = origin - tri.V0;
+			float u = glm::dot(s, p) * invDet;
+			if (u < 0.0f || u > 1.0f) {
+				return -1.0f;
+			}
+			glm::vec3 q = glm::cross(s, tri.Edge1);
+			float v = glm::dot(dir, q) * invDet;
+			if (v < 0.0f || u + v > 1.0f) {
+				return -1.0f;
+			}
+			return glm::dot(tri.Edge2, q) * invDet;
+		}
+	}
+
+	PotentiallyVisibleSet::PotentiallyVisibleSet() :
+		_origin(glm::vec3(0.0f)),
+		_cellSize(1.0f),
+		_dimensions(glm::ivec3(0)),
+		_chunks(std::vector<Guid>()),
+		_wordsPerSet(0),
+		_setWords(std::vector<uint32_t>()),
+		_cellSets(std::vector<uint32_t>()),
+		_stats(Stats()),
+		_chunkRenderables(std::vector<std::weak_ptr<RenderComponent>>()),
+		_chunksResolved(false)
+	{ }
+
+	PotentiallyVisibleSet::Sptr PotentiallyVisibleSet::Bake(Scene& scene, const BakeSettings& settings) {
+		Sptr result = std::make_shared<PotentiallyVisibleSet>();
+
+		// Every static object with a mesh is a chunk, pull their triangles into world space
+		std::vector<BakeTriangle> triangles;
+		scene.Components().Each<RenderComponent>([&](const RenderComponent::Sptr& renderable) {
+			if (!renderable->IsStatic() || renderable->GetGameObject() == nullptr || renderable->GetMesh() == nullptr) {
+				return;
+			}
+			uint32_t chunk = static_cast<uint32_t>(result->_chunks.size());
+			result->_chunks.push_back(renderable->GetGameObject()->GetGUID());
+			ReadTriangles(*renderable->GetMesh(), renderable->GetGameObject()->GetTransform(), chunk, triangles);
+		});
+		if (triangles.empty()) {
+			LOG_WARN("Scene has no static geometry, not baking a PVS");
+			return nullptr;
+		}
+
+		// Fit the grid around the geometry, with a cell of padding so cameras just outside the level still get culling
+		AABB bounds;
+		for (const BakeTriangle& tri : triangles) {
+			bounds.Encapsulate(tri.V0);
+			bounds.Encapsulate(tri.V0 + tri.Edge1);
+			bounds.Encapsulate(tri.V0 + tri.Edge2);
+		}
+		glm::vec3 size = bounds.Max - bounds.Min;
+		float longestAxis = glm::max(glm::max(size.x, size.y), glm::max(size.z, 0.0001f));
+		result->_cellSize = longestAxis / static_cast<float>(glm::max(settings.CellsPerAxis, 1u));
+		result->_origin = bounds.Min - glm::vec3(result->_cellSize);
+		result->_dimensions = glm::ivec3(glm::ceil(size / result->_cellSize)) + glm::ivec3(2);
+		const glm::ivec3 dims = result->_dimensions;
+		const float cellSize = result->_cellSize;
+		const glm::vec3 origin = result->_origin;
+		const uint32_t cellCount = static_cast<uint32_t>(dims.x * dims.y * dims.z);
+		auto toCell = [&](const glm::vec3& point) {
+			return glm::clamp(glm::ivec3(glm::floor((point - origin) / cellSize)), glm::ivec3(0), dims - 1);
+		};
+		auto cellIndex = [&](const glm::ivec3& cell) {
+			return static_cast<uint32_t>(cell.x + dims.x * (cell.y + dims.y * cell.z));
+		};
+
+		// Voxelize the triangles into the cells their bounds touch, so rays only test the triangles in cells they pass through
+		std::vector<std::vector<uint32_t>> cellTriangles(cellCount);
+		for (uint32_t ix = 0; ix < triangles.size(); ix++) {
+			const BakeTriangle& tri = triangles[ix];
+			glm::vec3 p1 = tri.V0 + tri.Edge1;
+			glm::vec3 p2 = tri.V0 + tri.Edge2;
+			glm::ivec3 min = toCell(glm::min(tri.V0, glm::min(p1, p2)));
+			glm::ivec3 max = toCell(glm::max(tri.V0, glm::max(p1, p2)));
+			for (int z = min.z; z <= max.z; z++) {
+				for (int y = min.y; y <= max.y; y++) {
+					for (int x = min.x; x <= max.x; x++) {
+						cellTriangles[cellIndex({ x, y, z })].push_back(ix);
+					}
+				}
+			}
+		}
+
+		// Walks the grid from the origin along the ray, returning the chunk of the first triangle hit or -1
+		auto castRay = [&](const glm::vec3& rayOrigin, const glm::vec3& dir) {
+			glm::ivec3 cell = toCell(rayOrigin);
+			glm::ivec3 step;
+			glm::vec3 tMax, tDelta;
+			for (int axis = 0; axis < 3; axis++) {
+				if (dir[axis] > 0.0f) {
+					step[axis] = 1;
+					tMax[axis] = (origin[axis] + (cell[axis] + 1) * cellSize - rayOrigin[axis]) / dir[axis];
+					tDelta[axis] = cellSize / dir[axis];
+				} else if (dir[axis] < 0.0f) {
+					step[axis] = -1;
+					tMax[axis] = (origin[axis] + cell[axis] * cellSize - rayOrigin[axis]) / dir[axis];
+					tDelta[axis] = -cellSize / dir[axis];
+				} else {
+					step[axis] = 0;
+					tMax[axis] = std::numeric_limits<float>::infinity();
+					tDelta[axis] = std::numeric_limits<float>::infinity();
+				}
+			}
+
+			while (true) {
+				float tExit = glm::min(tMax.x, glm::min(tMax.y, tMax.z));
+
+				// Triangles can span several cells, so only accept hits inside this one, anything further is found later on
+				float nearest = std::numeric_limits<float>::infinity();
+				int hit = -1;
+				for (uint32_t triIx : cellTriangles[cellIndex(cell)]) {
+					float t = IntersectTriangle(triangles[triIx], rayOrigin, dir);
+					if (t >= 0.0f && t < nearest && t <= tExit) {
+						nearest = t;
+						hit = static_cast<int>(triangles[triIx].Chunk);
+					}
+				}
+				if (hit >= 0) {
+					return hit;
+				}
+
+				int axis = (tMax.x < tMax.y) ? (tMax.x < tMax.z ? 0 : 2) : (tMax.y < tMax.z ? 1 : 2);
+				cell[axis] += step[axis];
+				if (cell[axis] < 0 || cell[axis] >= dims[axis]) {
+					return -1;
+				}
+				tMax[axis] += tDelta[axis];
+			}
+		};
+
+		result->_wordsPerSet = static_cast<uint32_t>((result->_chunks.size() + 31) / 32);
+		const uint32_t wordsPerSet = result->_wordsPerSet;
+		std::vector<uint32_t> cellWords(static_cast<size_t>(cellCount) * wordsPerSet, 0);
+
+		ThreadPool pool;
+		pool.ParallelFor(cellCount, [&](uint32_t cellIx) {
+			uint32_t* words = cellWords.data() + static_cast<size_t>(cellIx) * wordsPerSet;
+			auto markVisible = [&](uint32_t chunk) {
+				words[chunk / 32] |= 1u << (chunk % 32);
+			};
+
+			glm::ivec3 cell = { static_cast<int>(cellIx % dims.x), static_cast<int>((cellIx / dims.x) % dims.y), static_cast<int>(cellIx / (dims.x * dims.y)) };
+
+			// Rays easily slip past geometry right next to the camera, so anything in this cell or it's neighbours is always visible
+			for (int z = glm::max(cell.z - 1, 0); z <= glm::min(cell.z + 1, dims.z - 1); z++) {
+				for (int y = glm::max(cell.y - 1, 0); y <= glm::min(cell.y + 1, dims.y - 1); y++) {
+					for (int x = glm::max(cell.x - 1, 0); x <= glm::min(cell.x + 1, dims.x - 1); x++) {
+						for (uint32_t triIx : cellTriangles[cellIndex({ x, y, z })]) {
+							markVisible(triangles[triIx].Chunk);
+						}
+					}
+				}
+			}
+
+			// Seeded by cell so that bakes are repeatable no matter which thread picks up the cell
+			std::mt19937 random(cellIx);
+			std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+			glm::vec3 cellMin = origin + glm::vec3(cell) * cellSize;
+			for (uint32_t sample = 0; sample < settings.SamplesPerCell; sample++) {
+				glm::vec3 samplePos = cellMin + glm::vec3(unit(random), unit(random), unit(random)) * cellSize;
+				for (uint32_t ray = 0; ray < settings.RaysPerSample; ray++) {
+					// Uniformly distributed over the sphere
+					float z = unit(random) * 2.0f - 1.0f;
+					float angle = unit(random) * glm::two_pi<float>();
+					float r = glm::sqrt(glm::max(1.0f - z * z, 0.0f));
+					int chunk = castRay(samplePos, glm::vec3(r * glm::cos(angle), r * glm::sin(angle), z));
+					if (chunk >= 0) {
+						markVisible(static_cast<uint32_t>(chunk));
+					}
+				}
+			}
+		});
+
+		// Most neighbouring cells see the same chunks, so only store each distinct set once
+		std::map<std::vector<uint32_t>, uint32_t> uniqueSets;
+		result->_cellSets.resize(cellCount);
+		for (uint32_t cellIx = 0; cellIx < cellCount; cellIx++) {
+			auto begin = cellWords.begin() + static_cast<size_t>(cellIx) * wordsPerSet;
+			std::vector<uint32_t> words(begin, begin + wordsPerSet);
+			auto it = uniqueSets.find(words);
+			if (it == uniqueSets.end()) {
+				it = uniqueSets.emplace(words, static_cast<uint32_t>(uniqueSets.size())).first;
+				result->_setWords.insert(result->_setWords.end(), words.begin(), words.end());
+			}
+			result->_cellSets[cellIx] = it->second;
+		}
+
+		result->_UpdateStats();
+		const Stats& stats = result->_stats;
+		LOG_INFO("Baked PVS for {} chunks, {}x{}x{} cells, {} unique sets. Chunks drawn per cell: {:.1f} avg ({} - {}), {} without the PVS",
+			stats.Chunks, dims.x, dims.y, dims.z, stats.UniqueSets, stats.AverageVisible, stats.MinVisible, stats.MaxVisible, stats.Chunks);
+		return result;
+	}
+
+	std::string PotentiallyVisibleSet::GetPathForScene(const std::string& scenePath) {
+		// Follows the same naming as the scene's asset manifest
+		std::filesystem::path path = std::filesystem::path(scenePath);
+		return (path.parent_path() / (path.stem().string() + "-pvs.json")).string();
+	}
+
+	bool PotentiallyVisibleSet::CollectHidden(Scene& scene, const glm::vec3& point, std::unordered_set<const RenderComponent*>& hidden) const {
+		int cell = GetCellIndex(point);
+		if (cell < 0) {
+			return false;
+		}
+
+		_ResolveChunks(scene);
+		for (uint32_t chunk = 0; chunk < _chunkRenderables.size(); chunk++) {
+			if (!IsChunkVisible(cell, chunk)) {
+				if (RenderComponent::Sptr renderable = _chunkRenderables[chunk].lock()) {
+					hidden.insert(renderable.get());
+				}
+			}
+		}
+		return true;
+	}
+
+	int PotentiallyVisibleSet::GetCellIndex(const glm::vec3& point) const {
+		if (_cellSets.empty()) {
+			return -1;
+		}
+		glm::ivec3 cell = glm::ivec3(glm::floor((point - _origin) / _cellSize));
+		if (glm::any(glm::lessThan(cell, glm::ivec3(0))) || glm::any(glm::greaterThanEqual(cell, _dimensions))) {
+			return -1;
+		}
+		return cell.x + _dimensions.x * (cell.y + _dimensions.y * cell.z);
+	}
+
+	bool PotentiallyVisibleSet::IsChunkVisible(int cell, uint32_t chunk) const {
+		const uint32_t* words = _setWords.data() + static_cast<size_t>(_cellSets[cell]) * _wordsPerSet;
+		return (words[chunk / 32] & (1u << (chunk % 32))) != 0;
+	}
+
+	void PotentiallyVisibleSet::_UpdateStats() {
+		_stats = Stats();
+		_stats.Cells = static_cast<uint32_t>(_cellSets.size());
+		_stats.UniqueSets = _wordsPerSet > 0 ? static_cast<uint32_t>(_setWords.size() / _wordsPerSet) : 0;
+		_stats.Chunks = GetChunkCount();
+		if (_stats.Cells == 0) {
+			return;
+		}
+
+		// Cells share sets, so we only need to count the chunks in each set once
+		std::vector<uint32_t> setVisible(_stats.UniqueSets, 0);
+		for (uint32_t set = 0; set < _stats.UniqueSets; set++) {
+			const uint32_t* words = _setWords.data() + static_cast<size_t>(set) * _wordsPerSet;
+			for (uint32_t chunk = 0; chunk < _stats.Chunks; chunk++) {
+				setVisible[set] += (words[chunk / 32] & (1u << (chunk % 32))) != 0 ? 1 : 0;
+			}
+		}
+
+		uint64_t total = 0;
+		_stats.MinVisible = _stats.Chunks;
+		for (uint32_t set : _cellSets) {
+			uint32_t visible = setVisible[set];
+			total += visible;
+			_stats.MinVisible = glm::min(_stats.MinVisible, visible);
+			_stats.MaxVisible = glm::max(_stats.MaxVisible, visible);
+		}
+		_stats.AverageVisible = static_cast<float>(total) / static_cast<float>(_stats.Cells);
+	}
+
+	void PotentiallyVisibleSet::Save(const std::string& path) const {
+		FileHelpers::WriteContentsToFile(path, ToJson().dump(1, '\t'));
+		LOG_INFO("Saved PVS to \"{}\"", path);
+	}
+
+	PotentiallyVisibleSet::Sptr PotentiallyVisibleSet::Load(const std::string& path) {
+		if (!std::filesystem::exists(path)) {
+			return nullptr;
+		}
+		LOG_INFO("Loading PVS from \"{}\"", path);
+		return FromJson(nlohmann::json::parse(FileHelpers::ReadFile(path)));
+	}
+
+	nlohmann::json PotentiallyVisibleSet::ToJson() const {
+		nlohmann::json result;
+		result["origin"] = _origin;
+		result["cell_size"] = _cellSize;
+		result["dimensions"] = glm::vec3(_dimensions);
+		std::vector<std::string> chunks;
+		for (const Guid& chunk : _chunks) {
+			chunks.push_back(chunk.str());
+		}
+		result["chunks"] = chunks;
+		result["words_per_set"] = _wordsPerSet;
+		result["sets"] = Base64::Encode((void*)_setWords.data(), _setWords.size() * sizeof(uint32_t));
+		result["cells"] = Base64::Encode((void*)_cellSets.data(), _cellSets.size() * sizeof(uint32_t));
+		return result;
+	}
+
+	PotentiallyVisibleSet::Sptr PotentiallyVisibleSet::FromJson(const nlohmann::json& data) {
+		Sptr result = std::make_shared<PotentiallyVisibleSet>();
+		result->_origin = JsonGet(data, "origin", result->_origin);
+		result->_cellSize = JsonGet(data, "cell_size", result->_cellSize);
+		result->_dimensions = glm::ivec3(JsonGet(data, "dimensions", glm::vec3(0.0f)));
+		if (data.contains("chunks") && data["chunks"].is_array()) {
+			for (const auto& chunk : data["chunks"]) {
+				result->_chunks.push_back(Guid(chunk.get<std::string>()));
+			}
+		}
+		result->_wordsPerSet = JsonGet(data, "words_per_set", 0u);
+
+		std::string sets = Base64::Decode(JsonGet<std::string>(data, "sets", ""));
+		std::string cells = Base64::Decode(JsonGet<std::string>(data, "cells", ""));
+		result->_setWords.resize(sets.size() / sizeof(uint32_t));
+		memcpy(result->_setWords.data(), sets.data(), result->_setWords.size() * sizeof(uint32_t));
+		result->_cellSets.resize(cells.size() / sizeof(uint32_t));
+		memcpy(result->_cellSets.data(), cells.data(), result->_cellSets.size() * sizeof(uint32_t));
+
+		// Make sure the data all agrees before we start indexing into it
+		uint32_t setCount = result->_wordsPerSet > 0 ? static_cast<uint32_t>(result->_setWords.size() / result->_wordsPerSet) : 0;
+		bool valid = result->_wordsPerSet * 32 >= result->_chunks.size() &&
+			result->_cellSets.size() == static_cast<size_t>(result->_dimensions.x) * result->_dimensions.y * result->_dimensions.z &&
+			std::all_of(result->_cellSets.begin(), result->_cellSets.end(), [&](uint32_t set) { return set < setCount; });
+		if (!valid) {
+			LOG_WARN("PVS data is invalid or out of date, ignoring it");
+			return nullptr;
+		}
+		result->_UpdateStats();
+		return result;
+	}
+
+	void PotentiallyVisibleSet::_ResolveChunks(Scene& scene) const {
+		// Chunks that were deleted stay null, their bits are just ignored
+		if (_chunksResolved) {
+			return;
+		}
+		_chunkRenderables.resize(_chunks.size());
+		for (size_t ix = 0; ix < _chunks.size(); ix++) {
+			GameObject::Sptr object = scene.FindObjectByGUID(_chunks[ix]);
+			if (object != nullptr) {
+				_chunkRenderables[ix] = object->Get<RenderComponent>();
+			}
+		}
+		_chunksResolved = true;
+	}
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <cstdint>
+#include <GLM/glm.hpp>
+#include <json.hpp>
+
+#include "Utils/Macros.h"
+#include "Utils/GUID.hpp"
+
+class RenderComponent;
+
+namespace Gameplay {
+	class Scene;
+
+	/// <summary>
+	/// Precomputed visibility between the open space around a scene's static geometry and the static
+	/// objects themselves (the level chunks)
+	///
+	/// The bounds of the static geometry are split into a grid of view cells. When baking, rays are cast
+	/// from sample points in every cell against the static triangles, and every chunk a ray hits is
+	/// added to that cell's set. At runtime the renderer finds the camera's cell, and skips any chunk
+	/// that isn't in the set. The camera being outside the grid disables the culling entirely
+	///
+	/// Baking is slow, so it's meant to be done from the editor and saved next to the scene. Chunks
+	/// are stored by game object GUID, so the set stays valid across saving and loading the scene as
+	/// long as the chunks don't move
+	/// </summary>
+	class PotentiallyVisibleSet final {
+	public:
+		MAKE_PTRS(PotentiallyVisibleSet);
+
+		struct BakeSettings {
+			// The number of cells along the longest axis of the static geometry's bounds
+			uint32_t CellsPerAxis = 32;
+			// The number of points in each cell that rays are cast from
+			uint32_t SamplesPerCell = 8;
+			// The number of rays cast from each sample point
+			uint32_t RaysPerSample = 256;
+		};
+
+		// Summarizes how much the set culls, see GetStats
+		struct Stats {
+			uint32_t Cells = 0;
+			uint32_t UniqueSets = 0;
+			uint32_t Chunks = 0;
+			// The average number of chunks visible from a cell, ie: the number of chunk draws submitted
+			// per frame with the set, compared to Chunks without it
+			float    AverageVisible = 0.0f;
+			// The fewest and most chunks visible from any cell
+			uint32_t MinVisible = 0;
+			uint32_t MaxVisible = 0;
+		};
+
+		PotentiallyVisibleSet();
+
+		/// <summary>
+		/// Bakes a set for all the static render components in the scene. Blocks until it's done
+		/// </summary>
+		/// <param name="scene">The scene to bake the set for</param>
+		/// <param name="settings">The resolution and sample counts to bake with</param>
+		/// <returns>The new set, or nullptr if the scene has no static geometry</returns>
+		static Sptr Bake(Scene& scene, const BakeSettings& settings = BakeSettings());
+
+		/// <summary>
+		/// Gets the path that the set for the scene at the given path is stored at
+		/// </summary>
+		static std::string GetPathForScene(const std::string& scenePath);
+
+		/// <summary>
+		/// Finds the chunks that can't be seen from the given point
+		/// </summary>
+		/// <param name="scene">The scene that the set was baked for, used to look up the chunks</param>
+		/// <param name="point">The world space point to look from, usually the camera position</param>
+		/// <param name="hidden">The set to add the hidden chunks' render components to</param>
+		/// <returns>True if the point was inside the grid, false if nothing could be culled</returns>
+		bool CollectHidden(Scene& scene, const glm::vec3& point, std::unordered_set<const RenderComponent*>& hidden) const;
+
+		/// <summary>
+		/// Gets the index of the cell containing the given point, or -1 if the point is outside the grid
+		/// </summary>
+		int GetCellIndex(const glm::vec3& point) const;
+		/// <summary>
+		/// Returns true if the chunk can be seen from the given cell
+		/// </summary>
+		bool IsChunkVisible(int cell, uint32_t chunk) const;
+		/// <summary>
+		/// Gets the number of static objects the set was baked for
+		/// </summary>
+		uint32_t GetChunkCount() const { return static_cast<uint32_t>(_chunks.size()); }
+
+		/// <summary>
+		/// Compares the number of chunks drawn from every cell with the set to the number drawn without it.
+		/// Calculated when the set is baked or loaded, so this is cheap to call every frame
+		/// </summary>
+		const Stats& GetStats() const { return _stats; }
+
+		/// <summary>
+		/// Writes this set to a JSON file
+		/// </summary>
+		void Save(const std::string& path) const;
+		/// <summary>
+		/// Loads a set from a JSON file
+		/// </summary>
+		/// <returns>The loaded set, or nullptr if the file does not exist or is invalid</returns>
+		static Sptr Load(const std::string& path);
+
+		nlohmann::json ToJson() const;
+		static Sptr FromJson(const nlohmann::json& data);
+
+	protected:
+		// The world space position of the min corner of the grid
+		glm::vec3  _origin;
+		float      _cellSize;
+		glm::ivec3 _dimensions;
+
+		// The GUIDs of the game objects that own the chunks, a chunk's index is it's bit in the sets
+		std::vector<Guid> _chunks;
+		// Identical sets are only stored once, as _wordsPerSet words each
+		uint32_t              _wordsPerSet;
+		std::vector<uint32_t> _setWords;
+		// The index of the set for each cell
+		std::vector<uint32_t> _cellSets;
+		// Cached by _UpdateStats, see GetStats
+		Stats                 _stats;
+
+		// Lazily resolved render components for the chunks, looked up by GUID
+		mutable std::vector<std::weak_ptr<RenderComponent>> _chunkRenderables;
+		mutable bool                                        _chunksResolved;
+
+		/// <summary>
+		/// Looks up the render components for our chunks in the scene
+		/// </summary>
+		void _ResolveChunks(Scene& scene) const;
+		/// <summary>
+		/// Recalculates _stats from the sets, called once the sets are baked or loaded
+		/// </summary>
+		void _UpdateStats();
+	};
+}
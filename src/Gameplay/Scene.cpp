@@ -19,8 +19,13 @@
 
 namespace Gameplay {
 	Scene::Scene() :
+		_transforms(std::make_shared<TransformStore>()),
+		_spatialTree(std::make_shared<DynamicAabbTree>()),
+		_transformOwners(std::vector<GameObject*>()),
 		_objects(std::vector<GameObject::Sptr>()),
 		_deletionQueue(std::vector<std::weak_ptr<GameObject>>()),
+		_staticBatcher(std::make_shared<StaticBatcher>()),
+		_pvs(nullptr),
 		Lights(std::vector<Light>()),
 		IsPlaying(false),
 		MainCamera(nullptr),
@@ -51,6 +56,7 @@ namespace Gameplay {
 		_skyboxShader = nullptr;
 		_skyboxMesh = nullptr;
 		_skyboxTexture = nullptr;
+		_staticBatcher->Clear();
 		_objects.clear();
 		Lights.clear();
 		_CleanupPhysics();
@@ -116,9 +122,8 @@ namespace Gameplay {
 
 	GameObject::Sptr Scene::CreateGameObject(const std::string& name)
 	{
-		GameObject::Sptr result(new GameObject());
+		GameObject::Sptr result(new GameObject(this));
 		result->Name = name;
-		result->_scene = this;
 		result->_selfRef = result;
 		_objects.push_back(result);
 		return result;
@@ -135,6 +140,51 @@ namespace Gameplay {
 		return it == _objects.end() ? nullptr : *it;
 	}
 
+	void Scene::QueryFrustum(const Frustum& frustum, const ObjectQueryCallback& callback) const {
+		// The tree only knows about the fat boxes, so double check the real bounds before reporting anything
+		_spatialTree->QueryFrustum(frustum, [&](DynamicAabbTree::ProxyId proxy) {
+			GameObject* object = static_cast<GameObject*>(_spatialTree->GetUserData(proxy));
+			return !frustum.Intersects(object->_worldBounds) || callback(object);
+		});
+	}
+
+	void Scene::QueryBox(const AABB& box, const ObjectQueryCallback& callback) const {
+		_spatialTree->QueryBox(box, [&](DynamicAabbTree::ProxyId proxy) {
+			GameObject* object = static_cast<GameObject*>(_spatialTree->GetUserData(proxy));
+			return !object->_worldBounds.Intersects(box) || callback(object);
+		});
+	}
+
+	void Scene::QuerySphere(const BoundingSphere& sphere, const ObjectQueryCallback& callback) const {
+		_spatialTree->QuerySphere(sphere, [&](DynamicAabbTree::ProxyId proxy) {
+			GameObject* object = static_cast<GameObject*>(_spatialTree->GetUserData(proxy));
+			return !DynamicAabbTree::SphereIntersects(object->_worldBounds, sphere) || callback(object);
+		});
+	}
+
+	GameObject::Sptr Scene::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float* outDistance) const {
+		const glm::vec3 invDirection = 1.0f / direction;
+		GameObject* result = nullptr;
+		float resultDistance = maxDistance;
+		_spatialTree->RayCast(origin, direction, maxDistance, [&](DynamicAabbTree::ProxyId proxy, float entryDistance, float rayLength) {
+			// Objects without bounds would swallow every ray, so they can't be picked
+			GameObject* object = static_cast<GameObject*>(_spatialTree->GetUserData(proxy));
+			float distance;
+			if (object->_unbounded || !DynamicAabbTree::RayIntersects(object->_worldBounds, origin, invDirection, rayLength, distance)) {
+				return rayLength;
+			}
+			// Clip the ray to this hit, so only closer objects get reported from here on
+			result = object;
+			resultDistance = distance;
+			return distance;
+		});
+
+		if (outDistance != nullptr && result != nullptr) {
+			*outDistance = resultDistance;
+		}
+		return result != nullptr ? result->SelfRef() : nullptr;
+	}
+
 	GameObject::Sptr Scene::FindObjectByGUID(Guid id) const {
 		auto it = std::find_if(_objects.begin(), _objects.end(), [&](const GameObject::Sptr& obj) {
 			return obj->_guid == id;
@@ -171,6 +221,8 @@ namespace Gameplay {
 		for (auto& obj : _objects) {
 			obj->Awake();
 		}
+		// Objects may have set themselves up as static in Awake, so merge once they're all done
+		_staticBatcher->Build(*this);
 		// Set up our lighting 
 		SetupShaderAndLights();
 
@@ -213,9 +265,18 @@ namespace Gameplay {
 			}
 		}
 		_FlushDeleteQueue();
+
+		// Bring all the world matrices up to date in one pass now that everything has moved
+		_transforms->Update();
+		_RefitSpatialTree();
 	}
 
 	void Scene::PreRender() {
+		// Catches anything that was moved after the update (ex: by the editor)
+		_transforms->Update();
+		_RefitSpatialTree();
+		// Pull anything that moved or stopped being static back out of it's batch
+		_staticBatcher->Validate();
 		_lightingUbo->Bind(LIGHT_UBO_BINDING);
 	}
 
@@ -229,22 +290,6 @@ namespace Gameplay {
 		}
 	}
 
-	void Scene::SetShaderLight(int index, bool update /*= true*/) {
-		if (index >= 0 && index < Lights.size() && index < MAX_LIGHTS) {
-			// Get a reference to the light UBO data so we can update it
-			LightingUboStruct& data = _lightingUbo->GetData();
-			Light& light = Lights[index];
-
-			// Copy to the ubo data
-			data.Lights[index].Position = light.Position;
-			data.Lights[index].Color = light.Color;
-			data.Lights[index].Attenuation = 1.0f / (1.0f + light.Range);
-
-			// If requested, send the new data to the UBO
-			if (update)	_lightingUbo->Update();
-		}
-	}
-
 	void Scene::SetupShaderAndLights() {
 		// Get a reference to the light UBO data so we can update it
 		LightingUboStruct& data = _lightingUbo->GetData();
@@ -252,11 +297,6 @@ namespace Gameplay {
 		data.AmbientCol = glm::vec3(0.1f);
 		data.NumLights = static_cast<float>(Lights.size());
 
-		// Iterate over all lights that are enabled and configure them
-		for (int ix = 0; ix < Lights.size(); ix++) {
-			SetShaderLight(ix, false);
-		}
-
 		// Send updated data to OpenGL
 		_lightingUbo->Update();
 	}
@@ -355,6 +395,9 @@ namespace Gameplay {
 		// Save data to file
 		FileHelpers::WriteContentsToFile(path, ToJson().dump(1, '\t'));
 		LOG_INFO("Saved scene to \"{}\"", path);
+		if (_pvs != nullptr) {
+			_pvs->Save(PotentiallyVisibleSet::GetPathForScene(path));
+		}
 	}
 
 	Scene::Sptr Scene::Load(const std::string& path)
@@ -364,6 +407,7 @@ namespace Gameplay {
 		nlohmann::json blob = nlohmann::json::parse(content);
 		Scene::Sptr result = FromJson(blob);
 		result->_filePath = path;
+		result->_pvs = PotentiallyVisibleSet::Load(PotentiallyVisibleSet::GetPathForScene(path));
 		return result;
 	}
 
@@ -416,6 +460,19 @@ namespace Gameplay {
 		_deletionQueue.clear();
 	}
 
+	void Scene::_SetTransformOwner(TransformStore::Handle handle, GameObject* object) {
+		if (handle >= _transformOwners.size()) {
+			_transformOwners.resize(handle + 1, nullptr);
+		}
+		_transformOwners[handle] = object;
+	}
+
+	void Scene::_RefitSpatialTree() {
+		for (TransformStore::Handle handle : _transforms->GetChangedHandles()) {
+			_transformOwners[handle]->UpdateBounds();
+		}
+	}
+
 	void Scene::DrawAllGameObjectGUIs()
 	{
 		for (auto& object : _objects) {
@@ -5,6 +5,10 @@
 #include "Gameplay/Components/Camera.h"
 #include "Gameplay/GameObject.h"
 #include "Gameplay/Light.h"
+#include "Gameplay/StaticBatcher.h"
+#include "Gameplay/PotentiallyVisibleSet.h"
+
+#include "Utils/DynamicAabbTree.h"
 
 #include "Physics/BulletDebugDraw.h"
 
@@ -37,8 +41,11 @@ namespace Gameplay {
 	class Scene {
 	public:
 		typedef std::shared_ptr<Scene> Sptr;
+		/// <summary>
+		/// Invoked for every object found by a spatial query, return false to stop the query early
+		/// </summary>
+		typedef std::function<bool(GameObject* object)> ObjectQueryCallback;
 
-		static const int MAX_LIGHTS = 8;
 		static const int LIGHT_UBO_BINDING = 2;
 
 		// Stores all the lights in our scene
@@ -90,6 +97,40 @@ namespace Gameplay {
 		/// <param name="object">The gameobject to delete</param>
 		void RemoveGameObject(const GameObject::Sptr& object);
 
+		/// <summary>
+		/// Gets the store that holds the transforms for all objects in this scene. Systems that need
+		/// the transforms of many objects (ex: rendering) can read from this directly
+		/// </summary>
+		const TransformStore::Sptr& GetTransforms() const { return _transforms; }
+
+		/// <summary>
+		/// Gets the bounding volume hierarchy containing every object in the scene, the user data for
+		/// each proxy is the GameObject*. Objects are refit whenever their transforms are updated
+		/// </summary>
+		const DynamicAabbTree::Sptr& GetSpatialTree() const { return _spatialTree; }
+
+		/// <summary>
+		/// Finds all objects who's world bounds are at least partially inside the frustum
+		/// </summary>
+		void QueryFrustum(const Frustum& frustum, const ObjectQueryCallback& callback) const;
+		/// <summary>
+		/// Finds all objects who's world bounds overlap the given box
+		/// </summary>
+		void QueryBox(const AABB& box, const ObjectQueryCallback& callback) const;
+		/// <summary>
+		/// Finds all objects who's world bounds overlap the given sphere
+		/// </summary>
+		void QuerySphere(const BoundingSphere& sphere, const ObjectQueryCallback& callback) const;
+		/// <summary>
+		/// Finds the closest object who's world bounds are hit by a ray, for picking objects out of the scene
+		/// </summary>
+		/// <param name="origin">The world space start of the ray</param>
+		/// <param name="direction">The direction of the ray</param>
+		/// <param name="maxDistance">How far along the ray to look, in multiples of direction</param>
+		/// <param name="outDistance">If not null, receives the distance along the ray to the hit</param>
+		/// <returns>The closest object, or nullptr if the ray didn't hit anything</returns>
+		GameObject::Sptr Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float* outDistance = nullptr) const;
+
 		/// <summary>
 		/// Searches all objects in the scene and returns the first
 		/// one who's name matches the one given, or nullptr if no object
@@ -159,15 +200,8 @@ namespace Gameplay {
 		void RenderGUI();
 
 		/// <summary>
-		/// Handles setting the shader uniforms for our light structure in our array of lights
-		/// </summary>
-		/// <param name="shader">The pointer to the shader</param>
-		/// <param name="uniformName">The name of the uniform (ex: u_Lights)</param>
-		/// <param name="index">The index of the light to set</param>
-		/// <param name="light">The light data to copy over</param>
-		void SetShaderLight(int index, bool update = true);
-		/// <summary>
-		/// Creates the shader and sets up all the lights
+		/// Sets up the global lighting settings. The lights themselves are uploaded every frame by
+		/// the render layer, see ClusteredLighting
 		/// </summary>
 		void SetupShaderAndLights();
 
@@ -195,6 +229,21 @@ namespace Gameplay {
 		ComponentManager& Components() { return _components; }
 		const ComponentManager& Components() const { return _components; }
 
+		/// <summary>
+		/// Gets the batcher that merges this scene's static render components when the scene wakes up
+		/// </summary>
+		const StaticBatcher::Sptr& GetStaticBatcher() const { return _staticBatcher; }
+
+		/// <summary>
+		/// Gets the precomputed visibility for the scene's static chunks, or nullptr if none has been baked.
+		/// The set is loaded from and saved next to the scene file, see PotentiallyVisibleSet::GetPathForScene
+		/// </summary>
+		const PotentiallyVisibleSet::Sptr& GetPotentiallyVisibleSet() const { return _pvs; }
+		/// <summary>
+		/// Sets the precomputed visibility for the scene's static chunks, it will be saved along with the scene
+		/// </summary>
+		void SetPotentiallyVisibleSet(const PotentiallyVisibleSet::Sptr& value) { _pvs = value; }
+
 		/// <summary>
 		/// Saves this scene to an output JSON file
 		/// </summary>
@@ -239,9 +288,20 @@ namespace Gameplay {
 		// Our physics scene's global gravity, default matches earth's gravity (m/s^2)
 		glm::vec3 _gravity;
 
+		// Stores the transforms for all the objects in our scene
+		TransformStore::Sptr           _transforms;
+		// Bounding volume hierarchy over the world bounds of all our objects
+		DynamicAabbTree::Sptr          _spatialTree;
+		// The object that owns each transform handle, so we know what to refit when a transform changes.
+		// Released handles are never reported as changed, so their stale entries are never read
+		std::vector<GameObject*>       _transformOwners;
 		// Stores all the objects in our scene
 		std::vector<GameObject::Sptr>  _objects;
 		std::vector<std::weak_ptr<GameObject>>  _deletionQueue;
+		// Merges static render components that share a material into single meshes
+		StaticBatcher::Sptr            _staticBatcher;
+		// Baked visibility between view cells and the static chunks, may be null
+		PotentiallyVisibleSet::Sptr    _pvs;
 
 		// Info for rendering our skybox will be stored in the scene itself
 		std::shared_ptr<ShaderProgram>       _skyboxShader;
@@ -262,23 +322,10 @@ namespace Gameplay {
 		/// thing for packing structures to sizeof(vec4)
 		/// </summary>
 		struct LightingUboStruct {
-			struct Light {
-				// This lets us continue to access Position as a vec3, but also allocates space for the
-				// pack at the end (since objects are vec4 aligned)
-				union {
-					glm::vec3 Position;
-					glm::vec4 Position4;
-				};
-				// Since these are tightly packed, will match the vec4 in light
-				glm::vec3 Color;
-				float     Attenuation;
-			};
-
 			// Since these are tightly packed, will match the vec4 in the UBO
 			glm::vec3 AmbientCol;
 			float     NumLights;
 
-			Light     Lights[MAX_LIGHTS];
 			// NOTE: our shaders expect a mat3, but due to the STD140 layout, each column of the
 			// vec3 needs to be padded to the size of a vec4, hence the use of a mat4 here
 			glm::mat4 EnvironmentRotation;
@@ -297,5 +344,14 @@ namespace Gameplay {
 		void _CleanupPhysics();
 
 		void _FlushDeleteQueue();
+
+		/// <summary>
+		/// Records which object a transform handle belongs to
+		/// </summary>
+		void _SetTransformOwner(TransformStore::Handle handle, GameObject* object);
+		/// <summary>
+		/// Refits the spatial tree for every object who's transform changed in the last transform update
+		/// </summary>
+		void _RefitSpatialTree();
 	};
 }
\ No newline at end of file
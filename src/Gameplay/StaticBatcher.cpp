@@ -0,0 +1,244 @@
+#include "StaticBatcher.h"
+#include <algorithm>
+#include <Logging.h>
+
+#include "Gameplay/Scene.h"
+#include "Gameplay/GameObject.h"
+#include "Gameplay/MeshResource.h"
+#include "Gameplay/Material.h"
+#include "Gameplay/Components/RenderComponent.h"
+
+#include "Graphics/VertexArrayObject.h"
+#include "Graphics/VertexTypes.h"
+#include "Graphics/BoundingVolume.h"
+
+namespace Gameplay {
+	StaticBatcher::StaticBatcher() :
+		_batches(std::vector<Batch>()),
+		_renderables(std::vector<std::shared_ptr<RenderComponent>>())
+	{ }
+
+	StaticBatcher::~StaticBatcher() {
+		Clear();
+	}
+
+	void StaticBatcher::Build(Scene& scene) {
+		Clear();
+
+		// Group the static objects by material, keeping them in scene order so the batches come out the same every time
+		std::vector<std::vector<RenderComponent::Sptr>> groups;
+		scene.Components().Each<RenderComponent>([&](const RenderComponent::Sptr& renderable) {
+			if (!_CanMerge(*renderable)) {
+				return;
+			}
+			auto it = std::find_if(groups.begin(), groups.end(), [&](const std::vector<RenderComponent::Sptr>& group) {
+				return group[0]->GetMaterial() == renderable->GetMaterial();
+			});
+			if (it != groups.end()) {
+				it->push_back(renderable);
+			} else {
+				groups.push_back({ renderable });
+			}
+		});
+
+		// An object on it's own doesn't save us any draws
+		for (const auto& group : groups) {
+			if (group.size() > 1) {
+				_batches.push_back(_MergeBatch(group));
+			}
+		}
+		_UpdateRenderables();
+
+		if (!_batches.empty()) {
+			LOG_INFO("Merged {} static objects into {} batches", GetMergedCount(), _batches.size());
+		}
+	}
+
+	void StaticBatcher::Validate() {
+		bool changed = false;
+		for (size_t ix = 0; ix < _batches.size(); ix++) {
+			Batch& batch = _batches[ix];
+			bool valid = std::all_of(batch.Members.begin(), batch.Members.end(), [&](const Member& member) {
+				return _IsMemberValid(member, batch.SharedMaterial);
+			});
+			if (valid) {
+				continue;
+			}
+
+			// Pull everything back out, then re-merge whatever is still unchanged
+			std::vector<RenderComponent::Sptr> remaining;
+			for (const Member& member : batch.Members) {
+				if (_IsMemberValid(member, batch.SharedMaterial)) {
+					remaining.push_back(member.Component.lock());
+				}
+			}
+			_ReleaseBatch(batch);
+
+			if (remaining.size() > 1) {
+				batch = _MergeBatch(remaining);
+			} else {
+				_batches.erase(_batches.begin() + ix);
+				ix--;
+			}
+			changed = true;
+		}
+
+		if (changed) {
+			_UpdateRenderables();
+		}
+	}
+
+	void StaticBatcher::Clear() {
+		for (Batch& batch : _batches) {
+			_ReleaseBatch(batch);
+		}
+		_batches.clear();
+		_renderables.clear();
+	}
+
+	uint32_t StaticBatcher::GetMergedCount() const {
+		uint32_t result = 0;
+		for (const Batch& batch : _batches) {
+			result += static_cast<uint32_t>(batch.Members.size());
+		}
+		return result;
+	}
+
+	void StaticBatcher::GetMembers(size_t batch, std::vector<RenderComponent*>& members) const {
+		for (const Member& member : _batches[batch].Members) {
+			if (RenderComponent::Sptr component = member.Component.lock()) {
+				members.push_back(component.get());
+			}
+		}
+	}
+
+	bool StaticBatcher::_CanMerge(const RenderComponent& component) {
+		if (!component.IsStatic() || !component.IsEnabled || component.GetGameObject() == nullptr || component.GetMaterial() == nullptr) {
+			return false;
+		}
+
+		VertexArrayObject::Sptr mesh = component.GetMesh();
+		if (mesh == nullptr) {
+			return false;
+		}
+
+		// We only know how to merge meshes that have all their attributes in one buffer with the layout the
+		// OBJ loaders and MeshFactory use, which covers everything our scenes load
+		VertexArrayObject::VertexBufferBinding* binding = mesh->GetBufferBinding(AttribUsage::Position);
+		return binding != nullptr && !binding->IsInstanced() &&
+			binding->GetBuffer()->GetElementSize() == sizeof(VertexPosNormTexColTangents) &&
+			binding->GetAttributes().size() == VertexPosNormTexColTangents::V_DECL.size() &&
+			mesh->GetVDecl().size() == VertexPosNormTexColTangents::V_DECL.size();
+	}
+
+	bool StaticBatcher::_IsMemberValid(const Member& member, const std::shared_ptr<Material>& material) {
+		RenderComponent::Sptr component = member.Component.lock();
+		return component != nullptr &&
+			component->IsStatic() &&
+			component->IsEnabled &&
+			component->GetGameObject() != nullptr &&
+			component->GetMeshResource() == member.Mesh &&
+			component->GetMaterial() == material &&
+			component->GetGameObject()->GetTransform() == member.Transform;
+	}
+
+	StaticBatcher::Batch StaticBatcher::_MergeBatch(const std::vector<RenderComponent::Sptr>& components) {
+		Batch result;
+		result.SharedMaterial = components[0]->GetMaterial();
+
+		std::vector<VertexPosNormTexColTangents> vertices;
+		std::vector<uint32_t> indices;
+		std::vector<uint8_t> indexStore;
+
+		for (const RenderComponent::Sptr& component : components) {
+			GameObject* object = component->GetGameObject();
+			VertexArrayObject::Sptr mesh = component->GetMesh();
+			VertexBuffer::Sptr vertexBuff = mesh->GetBufferBinding(AttribUsage::Position)->GetBuffer();
+			IndexBuffer::Sptr indexBuff = mesh->GetIndexBuffer();
+
+			// The meshes only live on the GPU once they're loaded, so read them back like the convex mesh collider does
+			uint32_t baseVertex = static_cast<uint32_t>(vertices.size());
+			vertices.resize(vertices.size() + vertexBuff->GetElementCount());
+			glGetNamedBufferSubData(vertexBuff->GetHandle(), 0, vertexBuff->GetTotalSize(), vertices.data() + baseVertex);
+
+			// Bake the object's transform in, the shaders normalize after transforming so we don't have to here
+			const glm::mat4& transform = object->GetTransform();
+			const glm::mat3& normalMatrix = object->GetNormalMatrix();
+			const glm::mat3 rotation = glm::mat3(transform);
+			for (size_t ix = baseVertex; ix < vertices.size(); ix++) {
+				VertexPosNormTexColTangents& vert = vertices[ix];
+				vert.Position  = glm::vec3(transform * glm::vec4(vert.Position, 1.0f));
+				vert.Normal    = normalMatrix * vert.Normal;
+				vert.Tangent   = rotation * vert.Tangent;
+				vert.BiTangent = rotation * vert.BiTangent;
+			}
+
+			if (indexBuff != nullptr) {
+				indexStore.resize(indexBuff->GetTotalSize());
+				glGetNamedBufferSubData(indexBuff->GetHandle(), 0, indexBuff->GetTotalSize(), indexStore.data());
+				for (uint32_t ix = 0; ix < indexBuff->GetElementCount(); ix++) {
+					switch (indexBuff->GetElementType()) {
+						case IndexType::UByte:
+							indices.push_back(baseVertex + indexStore[ix]);
+							break;
+						case IndexType::UShort:
+							indices.push_back(baseVertex + reinterpret_cast<const uint16_t*>(indexStore.data())[ix]);
+							break;
+						case IndexType::UInt:
+							indices.push_back(baseVertex + reinterpret_cast<const uint32_t*>(indexStore.data())[ix]);
+							break;
+						case IndexType::Unknown:
+						default:
+							indices.push_back(baseVertex);
+							break;
+					}
+				}
+			} else {
+				for (uint32_t ix = 0; ix < vertexBuff->GetElementCount(); ix++) {
+					indices.push_back(baseVertex + ix);
+				}
+			}
+
+			Member& member = result.Members.emplace_back();
+			member.Component = component;
+			member.Mesh = component->GetMeshResource();
+			member.Transform = transform;
+			component->_staticBatched = true;
+		}
+
+		VertexBuffer::Sptr vbo = VertexBuffer::Create(BufferUsage::StaticDraw);
+		vbo->LoadData(vertices.data(), static_cast<uint32_t>(vertices.size()));
+
+		IndexBuffer::Sptr ibo = IndexBuffer::Create(BufferUsage::StaticDraw);
+		ibo->LoadData(indices.data(), sizeof(uint32_t), static_cast<uint32_t>(indices.size()), IndexType::UInt);
+
+		VertexArrayObject::Sptr vao = VertexArrayObject::Create();
+		vao->AddVertexBuffer(vbo, VertexPosNormTexColTangents::V_DECL);
+		vao->SetIndexBuffer(ibo);
+		// The vertices are in world space, so this box is the batch's world space bounds that the renderer culls with
+		vao->SetBounds(MeshBounds::FromVertices(vertices.data(), vertices.size()));
+
+		MeshResource::Sptr meshResource = std::make_shared<MeshResource>();
+		meshResource->Mesh = vao;
+		result.Renderable = std::make_shared<RenderComponent>(meshResource, result.SharedMaterial);
+
+		return result;
+	}
+
+	void StaticBatcher::_ReleaseBatch(Batch& batch) {
+		for (const Member& member : batch.Members) {
+			if (RenderComponent::Sptr component = member.Component.lock()) {
+				component->_staticBatched = false;
+			}
+		}
+		batch.Members.clear();
+		batch.Renderable = nullptr;
+	}
+
+	void StaticBatcher::_UpdateRenderables() {
+		_renderables.clear();
+		for (const Batch& batch : _batches) {
+			_renderables.push_back(batch.Renderable);
+		}
+	}
+}
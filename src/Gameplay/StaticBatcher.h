@@ -0,0 +1,109 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "GLM/glm.hpp"
+
+#include "Utils/Macros.h"
+
+class RenderComponent;
+
+namespace Gameplay {
+	class Scene;
+	class Material;
+	class MeshResource;
+
+	/// <summary>
+	/// Merges static render components that share a material into one world space mesh per
+	/// material, so that level geometry made up of many separate pieces costs a single draw
+	///
+	/// The merged meshes are drawn by render components that don't belong to any game object,
+	/// and the originals are flagged so the renderer skips them. If a merged object stops being
+	/// static, moves, is deleted, or has it's mesh or material swapped out, the batch it was in
+	/// gets rebuilt without it
+	/// </summary>
+	class StaticBatcher final {
+	public:
+		MAKE_PTRS(StaticBatcher);
+		NO_COPY(StaticBatcher);
+		NO_MOVE(StaticBatcher);
+
+		StaticBatcher();
+		~StaticBatcher();
+
+		/// <summary>
+		/// Throws away any existing batches, and merges all the static render components in the
+		/// scene that share a material with at least one other static component
+		/// </summary>
+		/// <param name="scene">The scene to collect static objects from</param>
+		void Build(Scene& scene);
+		/// <summary>
+		/// Checks that every merged object is still static and hasn't changed since it was merged,
+		/// rebuilding any batches that are out of date. Should be called once the scene's
+		/// transforms are up to date for the frame
+		/// </summary>
+		void Validate();
+		/// <summary>
+		/// Throws away all batches, the original objects will be drawn on their own again
+		/// </summary>
+		void Clear();
+
+		/// <summary>
+		/// Gets the render components that draw the merged batches, these have no game object
+		/// and their meshes are already in world space
+		/// </summary>
+		const std::vector<std::shared_ptr<RenderComponent>>& GetRenderables() const { return _renderables; }
+		/// <summary>
+		/// Gets the number of render components that are being drawn as part of a batch
+		/// </summary>
+		uint32_t GetMergedCount() const;
+		/// <summary>
+		/// Gets the components that were merged into the batch drawn by GetRenderables()[batch]
+		/// </summary>
+		/// <param name="batch">The index of the batch</param>
+		/// <param name="members">The list to add the live members of the batch to</param>
+		void GetMembers(size_t batch, std::vector<RenderComponent*>& members) const;
+
+	protected:
+		// A single object that was merged into a batch, along with what it looked like when it
+		// was merged so we can tell when it needs to be pulled back out
+		struct Member {
+			std::weak_ptr<RenderComponent>  Component;
+			std::shared_ptr<MeshResource>   Mesh;
+			glm::mat4                       Transform;
+		};
+
+		struct Batch {
+			std::shared_ptr<Material>        SharedMaterial;
+			std::vector<Member>              Members;
+			std::shared_ptr<RenderComponent> Renderable;
+		};
+
+		std::vector<Batch>                            _batches;
+		std::vector<std::shared_ptr<RenderComponent>> _renderables;
+
+		/// <summary>
+		/// Returns true if the component is static and has a mesh we know how to merge
+		/// </summary>
+		static bool _CanMerge(const RenderComponent& component);
+		/// <summary>
+		/// Returns true if the member is still static and unchanged since it was merged
+		/// </summary>
+		static bool _IsMemberValid(const Member& member, const std::shared_ptr<Material>& material);
+		/// <summary>
+		/// Pre-transforms and merges the meshes of the given components into one mesh, and
+		/// flags the components as batched
+		/// </summary>
+		/// <param name="components">The components to merge, all using the same material</param>
+		/// <returns>The merged batch</returns>
+		static Batch _MergeBatch(const std::vector<std::shared_ptr<RenderComponent>>& components);
+		/// <summary>
+		/// Un-flags all the members of a batch that are still alive
+		/// </summary>
+		static void _ReleaseBatch(Batch& batch);
+		/// <summary>
+		/// Rebuilds the list of renderables from our batches
+		/// </summary>
+		void _UpdateRenderables();
+	};
+}
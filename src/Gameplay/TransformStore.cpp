@@ -0,0 +1,295 @@
+#include "TransformStore.h"
+
+#include "GLM/gtc/matrix_inverse.hpp"
+#include "Logging.h"
+
+namespace Gameplay {
+	/// <summary>
+	/// Re-orders an array so that element ix of the result is element order[ix] of the input
+	/// </summary>
+	template <typename T>
+	static void Permute(std::vector<T>& data, const std::vector<uint32_t>& order) {
+		std::vector<T> result;
+		result.reserve(data.size());
+		for (uint32_t oldIx : order) {
+			result.push_back(data[oldIx]);
+		}
+		data.swap(result);
+	}
+
+	TransformStore::TransformStore() :
+		_positions(std::vector<glm::vec3>()),
+		_rotations(std::vector<glm::quat>()),
+		_scales(std::vector<glm::vec3>()),
+		_localTransforms(std::vector<glm::mat4>()),
+		_worldTransforms(std::vector<glm::mat4>()),
+		_inverseWorldTransforms(std::vector<glm::mat4>()),
+		_normalMatrices(std::vector<glm::mat3>()),
+		_parents(std::vector<uint32_t>()),
+		_dirty(std::vector<uint8_t>()),
+		_handles(std::vector<Handle>()),
+		_indices(std::vector<uint32_t>()),
+		_freeHandles(std::vector<Handle>()),
+		_changed(std::vector<Handle>()),
+		_orderDirty(false),
+		_anyDirty(false)
+	{ }
+
+	TransformStore::Handle TransformStore::Allocate() {
+		// Re-use old handles so the handle to index table doesn't keep growing
+		Handle handle;
+		if (!_freeHandles.empty()) {
+			handle = _freeHandles.back();
+			_freeHandles.pop_back();
+		} else {
+			handle = static_cast<Handle>(_indices.size());
+			_indices.push_back(0);
+		}
+
+		// New entries are roots, so appending them keeps parents ahead of children
+		uint32_t index = static_cast<uint32_t>(_positions.size());
+		_indices[handle] = index;
+		_handles.push_back(handle);
+
+		_positions.push_back(glm::vec3(0.0f));
+		_rotations.push_back(glm::quat(glm::vec3(0.0f)));
+		_scales.push_back(glm::vec3(1.0f));
+		_localTransforms.push_back(glm::mat4(1.0f));
+		_worldTransforms.push_back(glm::mat4(1.0f));
+		_inverseWorldTransforms.push_back(glm::mat4(1.0f));
+		_normalMatrices.push_back(glm::mat3(1.0f));
+		_parents.push_back(NO_PARENT);
+		_dirty.push_back(0);
+		_MarkDirty(index);
+
+		return handle;
+	}
+
+	void TransformStore::Release(Handle handle) {
+		LOG_ASSERT(handle < _indices.size(), "Invalid transform handle");
+
+		uint32_t index = _indices[handle];
+		uint32_t last = static_cast<uint32_t>(_positions.size()) - 1;
+
+		// Orphan our children, and point anything parented to the last entry at it's new index
+		for (uint32_t ix = 0; ix <= last; ix++) {
+			if (_parents[ix] == index) {
+				_parents[ix] = NO_PARENT;
+				_MarkDirty(ix);
+			} else if (_parents[ix] == last) {
+				_parents[ix] = index;
+			}
+		}
+
+		// Swap the last entry into the released slot, this can put children ahead of their parents
+		if (index != last) {
+			_positions[index] = _positions[last];
+			_rotations[index] = _rotations[last];
+			_scales[index] = _scales[last];
+			_localTransforms[index] = _localTransforms[last];
+			_worldTransforms[index] = _worldTransforms[last];
+			_inverseWorldTransforms[index] = _inverseWorldTransforms[last];
+			_normalMatrices[index] = _normalMatrices[last];
+			_parents[index] = _parents[last];
+			_dirty[index] = _dirty[last];
+			_handles[index] = _handles[last];
+			_indices[_handles[index]] = index;
+			_orderDirty = true;
+		}
+
+		_positions.pop_back();
+		_rotations.pop_back();
+		_scales.pop_back();
+		_localTransforms.pop_back();
+		_worldTransforms.pop_back();
+		_inverseWorldTransforms.pop_back();
+		_normalMatrices.pop_back();
+		_parents.pop_back();
+		_dirty.pop_back();
+		_handles.pop_back();
+
+		_freeHandles.push_back(handle);
+	}
+
+	void TransformStore::SetParent(Handle handle, Handle parent) {
+		uint32_t index = _indices[handle];
+		uint32_t parentIndex = parent == INVALID_HANDLE ? NO_PARENT : _indices[parent];
+		LOG_ASSERT(parentIndex != index, "Cannot parent a transform to itself");
+
+		_parents[index] = parentIndex;
+		_MarkDirty(index);
+
+		// We only need to re-sort if the parent ended up behind the child
+		if (parentIndex != NO_PARENT && parentIndex > index) {
+			_orderDirty = true;
+		}
+	}
+
+	void TransformStore::SetPosition(Handle handle, const glm::vec3& value) {
+		uint32_t index = _indices[handle];
+		_positions[index] = value;
+		_MarkDirty(index);
+	}
+
+	void TransformStore::SetRotation(Handle handle, const glm::quat& value) {
+		uint32_t index = _indices[handle];
+		_rotations[index] = value;
+		_MarkDirty(index);
+	}
+
+	void TransformStore::SetScale(Handle handle, const glm::vec3& value) {
+		uint32_t index = _indices[handle];
+		_scales[index] = value;
+		_MarkDirty(index);
+	}
+
+	const glm::mat4& TransformStore::GetLocalTransform(Handle handle) {
+		uint32_t index = _indices[handle];
+		if (_anyDirty) {
+			_Resolve(index);
+		}
+		return _localTransforms[index];
+	}
+
+	const glm::mat4& TransformStore::GetWorldTransform(Handle handle) {
+		uint32_t index = _indices[handle];
+		if (_anyDirty) {
+			_Resolve(index);
+		}
+		return _worldTransforms[index];
+	}
+
+	const glm::mat4& TransformStore::GetInverseWorldTransform(Handle handle) {
+		uint32_t index = _indices[handle];
+		if (_anyDirty) {
+			_Resolve(index);
+		}
+		return _inverseWorldTransforms[index];
+	}
+
+	const glm::mat3& TransformStore::GetNormalMatrix(Handle handle) {
+		uint32_t index = _indices[handle];
+		if (_anyDirty) {
+			_Resolve(index);
+		}
+		return _normalMatrices[index];
+	}
+
+	void TransformStore::Update() {
+		_changed.clear();
+		if (_orderDirty) {
+			_SortByDepth();
+		}
+		if (!_anyDirty) {
+			return;
+		}
+
+		// Parents always come before their children, so by the time we reach an entry it's
+		// parent's flag and matrices are final. Pulling the parent's flag down is what carries
+		// a change through every level of the hierarchy below it
+		const uint32_t count = static_cast<uint32_t>(_positions.size());
+		uint8_t* dirty = _dirty.data();
+		const uint32_t* parents = _parents.data();
+		for (uint32_t ix = 0; ix < count; ix++) {
+			if (parents[ix] != NO_PARENT) {
+				dirty[ix] |= dirty[parents[ix]];
+			}
+			if (dirty[ix]) {
+				_Calculate(ix);
+				_changed.push_back(_handles[ix]);
+			}
+		}
+
+		std::fill(_dirty.begin(), _dirty.end(), 0);
+		_anyDirty = false;
+	}
+
+	bool TransformStore::_Resolve(uint32_t index) {
+		bool stale = _parents[index] != NO_PARENT && _Resolve(_parents[index]);
+		if (stale || _dirty[index]) {
+			_Calculate(index);
+			return true;
+		}
+		return false;
+	}
+
+	void TransformStore::_Calculate(uint32_t index) {
+		// Build T * R * S directly, scaling the rotation's columns is much cheaper than
+		// multiplying out three full matrices
+		const glm::vec3& scale = _scales[index];
+		glm::mat3 rotation = glm::mat3_cast(_rotations[index]);
+		glm::mat4& local = _localTransforms[index];
+		local[0] = glm::vec4(rotation[0] * scale.x, 0.0f);
+		local[1] = glm::vec4(rotation[1] * scale.y, 0.0f);
+		local[2] = glm::vec4(rotation[2] * scale.z, 0.0f);
+		local[3] = glm::vec4(_positions[index], 1.0f);
+
+		uint32_t parent = _parents[index];
+		glm::mat4& world = _worldTransforms[index];
+		world = parent != NO_PARENT ? _worldTransforms[parent] * local : local;
+
+		// All our transforms are affine, which has a much cheaper inverse than the general case,
+		// and the normal matrix falls out of it for free
+		_inverseWorldTransforms[index] = glm::affineInverse(world);
+		_normalMatrices[index] = glm::transpose(glm::mat3(_inverseWorldTransforms[index]));
+	}
+
+	void TransformStore::_SortByDepth() {
+		const uint32_t count = static_cast<uint32_t>(_positions.size());
+
+		// Find the depth of each entry. The arrays aren't in order yet, so we just walk up the chain
+		std::vector<uint32_t> depths(count, 0);
+		uint32_t maxDepth = 0;
+		for (uint32_t ix = 0; ix < count; ix++) {
+			uint32_t depth = 0;
+			for (uint32_t parent = _parents[ix]; parent != NO_PARENT; parent = _parents[parent]) {
+				depth++;
+				LOG_ASSERT(depth <= count, "Cycle detected in transform hierarchy");
+			}
+			depths[ix] = depth;
+			maxDepth = glm::max(maxDepth, depth);
+		}
+
+		// Counting sort by depth, stable so siblings keep their relative order
+		std::vector<uint32_t> offsets(maxDepth + 2, 0);
+		for (uint32_t ix = 0; ix < count; ix++) {
+			offsets[depths[ix] + 1]++;
+		}
+		for (uint32_t ix = 1; ix < offsets.size(); ix++) {
+			offsets[ix] += offsets[ix - 1];
+		}
+		std::vector<uint32_t> order(count);
+		std::vector<uint32_t> remap(count);
+		for (uint32_t ix = 0; ix < count; ix++) {
+			uint32_t newIx = offsets[depths[ix]]++;
+			order[newIx] = ix;
+			remap[ix] = newIx;
+		}
+
+		Permute(_positions, order);
+		Permute(_rotations, order);
+		Permute(_scales, order);
+		Permute(_localTransforms, order);
+		Permute(_worldTransforms, order);
+		Permute(_inverseWorldTransforms, order);
+		Permute(_normalMatrices, order);
+		Permute(_dirty, order);
+		Permute(_handles, order);
+		Permute(_parents, order);
+
+		// Parent links still hold old indices, and the handle table needs to point at the new slots
+		for (uint32_t ix = 0; ix < count; ix++) {
+			if (_parents[ix] != NO_PARENT) {
+				_parents[ix] = remap[_parents[ix]];
+			}
+			_indices[_handles[ix]] = ix;
+		}
+
+		_orderDirty = false;
+	}
+
+	void TransformStore::_MarkDirty(uint32_t index) {
+		_dirty[index] = 1;
+		_anyDirty = true;
+	}
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+// GLM
+#define GLM_ENABLE_EXPERIMENTAL
+#include "GLM/glm.hpp"
+#include "GLM/gtc/quaternion.hpp"
+
+#include "Utils/Macros.h"
+
+namespace Gameplay {
+	/// <summary>
+	/// Stores the transforms for all the game objects in a scene as contiguous arrays (one per
+	/// property) rather than inside each object
+	///
+	/// Entries are kept sorted by their depth in the hierarchy, so parents always come before
+	/// their children. This lets Update walk the arrays once from front to back, recalculating
+	/// only dirty entries and anything below them, since a parent's world matrix is always ready
+	/// by the time we reach it's children
+	///
+	/// Objects refer to their entry with a handle, which stays the same when entries are moved
+	/// </summary>
+	class TransformStore final {
+	public:
+		MAKE_PTRS(TransformStore);
+		NO_COPY(TransformStore);
+		NO_MOVE(TransformStore);
+
+		typedef uint32_t Handle;
+		static constexpr Handle INVALID_HANDLE = UINT32_MAX;
+
+		TransformStore();
+		~TransformStore() = default;
+
+		/// <summary>
+		/// Creates a new entry with an identity transform and no parent
+		/// </summary>
+		/// <returns>The handle to the new entry</returns>
+		Handle Allocate();
+		/// <summary>
+		/// Removes an entry from the store, any children of the entry will become root entries
+		/// </summary>
+		/// <param name="handle">The handle to release, will no longer be valid after this call</param>
+		void Release(Handle handle);
+
+		/// <summary>
+		/// Sets the parent of an entry, so that it's world transform is relative to the parent's
+		/// </summary>
+		/// <param name="handle">The entry to re-parent</param>
+		/// <param name="parent">The new parent, or INVALID_HANDLE to make the entry a root</param>
+		void SetParent(Handle handle, Handle parent);
+
+		void SetPosition(Handle handle, const glm::vec3& value);
+		void SetRotation(Handle handle, const glm::quat& value);
+		void SetScale(Handle handle, const glm::vec3& value);
+
+		const glm::vec3& GetPosition(Handle handle) const { return _positions[_indices[handle]]; }
+		const glm::quat& GetRotation(Handle handle) const { return _rotations[_indices[handle]]; }
+		const glm::vec3& GetScale(Handle handle) const { return _scales[_indices[handle]]; }
+
+		/// <summary>
+		/// Gets the entry's local transform, recalculating it if it is out of date
+		/// </summary>
+		const glm::mat4& GetLocalTransform(Handle handle);
+		/// <summary>
+		/// Gets the entry's world transform, recalculating it if it or any of it's parents are out of date
+		/// Note that the reference is only valid until the next time an entry is allocated, released, or the store is updated
+		/// </summary>
+		const glm::mat4& GetWorldTransform(Handle handle);
+		/// <summary>
+		/// Gets the inverse of the entry's world transform
+		/// </summary>
+		const glm::mat4& GetInverseWorldTransform(Handle handle);
+		/// <summary>
+		/// Gets the matrix for transforming normals from local to world space (the inverse transpose of the world transform)
+		/// </summary>
+		const glm::mat3& GetNormalMatrix(Handle handle);
+
+		/// <summary>
+		/// Recalculates the matrices for every dirty entry and all of their descendants in a single
+		/// pass. Reads in between updates are still correct, but have to walk up the hierarchy to
+		/// check for dirty parents, so this should be called once a frame before rendering
+		/// </summary>
+		void Update();
+		/// <summary>
+		/// Gets the handles of every entry who's world transform was recalculated by the last call
+		/// to Update, including children that moved because a parent did
+		/// </summary>
+		const std::vector<Handle>& GetChangedHandles() const { return _changed; }
+
+		/// <summary>
+		/// Gets the number of entries in the store
+		/// </summary>
+		size_t Size() const { return _positions.size(); }
+
+	protected:
+		static constexpr uint32_t NO_PARENT = UINT32_MAX;
+
+		// Local TRS for each entry
+		std::vector<glm::vec3> _positions;
+		std::vector<glm::quat> _rotations;
+		std::vector<glm::vec3> _scales;
+
+		// Cached matrices, only valid for entries that are not dirty
+		std::vector<glm::mat4> _localTransforms;
+		std::vector<glm::mat4> _worldTransforms;
+		std::vector<glm::mat4> _inverseWorldTransforms;
+		std::vector<glm::mat3> _normalMatrices;
+
+		// The dense index of each entry's parent, or NO_PARENT for roots
+		std::vector<uint32_t>  _parents;
+		// Non-zero if the entry's TRS or hierarchy has changed since the last update
+		std::vector<uint8_t>   _dirty;
+
+		// Maps between handles and dense indices, since the arrays get re-ordered
+		std::vector<Handle>    _handles;
+		std::vector<uint32_t>  _indices;
+		std::vector<Handle>    _freeHandles;
+		// The entries that were recalculated by the last Update
+		std::vector<Handle>    _changed;
+
+		// True if the depth order of the arrays needs to be rebuilt
+		bool _orderDirty;
+		// True if any entry is dirty, lets reads skip the parent walk in the common case
+		bool _anyDirty;
+
+		/// <summary>
+		/// Recalculates an entry's matrices if it or any of it's parents are dirty, without clearing
+		/// any dirty flags (other children of the dirty parents still need to be updated)
+		/// </summary>
+		/// <returns>True if the entry's matrices were recalculated</returns>
+		bool _Resolve(uint32_t index);
+		/// <summary>
+		/// Calculates the matrices for the entry at the given index, assuming the parent's are up to date
+		/// </summary>
+		void _Calculate(uint32_t index);
+		/// <summary>
+		/// Sorts all the arrays by hierarchy depth, so that parents come before their children
+		/// </summary>
+		void _SortByDepth();
+		/// <summary>
+		/// Marks an entry as dirty
+		/// </summary>
+		void _MarkDirty(uint32_t index);
+	};
+}
@@ -0,0 +1,163 @@
+#include "BoundingVolume.h"
+#include <limits>
+
+AABB::AABB() :
+	Min(glm::vec3(std::numeric_limits<float>::max())),
+	Max(glm::vec3(std::numeric_limits<float>::lowest()))
+{ }
+
+AABB::AABB(const glm::vec3& min, const glm::vec3& max) :
+	Min(min),
+	Max(max)
+{ }
+
+bool AABB::IsValid() const {
+	return Min.x <= Max.x && Min.y <= Max.y && Min.z <= Max.z;
+}
+
+glm::vec3 AABB::GetCenter() const {
+	return (Min + Max) * 0.5f;
+}
+
+glm::vec3 AABB::GetExtents() const {
+	return (Max - Min) * 0.5f;
+}
+
+void AABB::Encapsulate(const glm::vec3& point) {
+	Min = glm::min(Min, point);
+	Max = glm::max(Max, point);
+}
+
+void AABB::Encapsulate(const AABB& other) {
+	Min = glm::min(Min, other.Min);
+	Max = glm::max(Max, other.Max);
+}
+
+bool AABB::Intersects(const AABB& other) const {
+	return
+		Min.x <= other.Max.x && Max.x >= other.Min.x &&
+		Min.y <= other.Max.y && Max.y >= other.Min.y &&
+		Min.z <= other.Max.z && Max.z >= other.Min.z;
+}
+
+bool AABB::Contains(const glm::vec3& point) const {
+	return
+		point.x >= Min.x && point.x <= Max.x &&
+		point.y >= Min.y && point.y <= Max.y &&
+		point.z >= Min.z && point.z <= Max.z;
+}
+
+AABB AABB::Transform(const glm::mat4& transform) const {
+	if (!IsValid()) {
+		return *this;
+	}
+
+	// Transform the center, then project the extents onto each world axis using the
+	// absolute value of the rotation/scale part of the matrix (Arvo's method)
+	glm::vec3 center = glm::vec3(transform * glm::vec4(GetCenter(), 1.0f));
+	glm::vec3 extents = GetExtents();
+	glm::mat3 absolute = glm::mat3(glm::abs(glm::vec3(transform[0])), glm::abs(glm::vec3(transform[1])), glm::abs(glm::vec3(transform[2])));
+	glm::vec3 worldExtents = absolute * extents;
+
+	return AABB(center - worldExtents, center + worldExtents);
+}
+
+BoundingSphere BoundingSphere::Transform(const glm::mat4& transform) const {
+	float maxScaleSq = glm::max(
+		glm::dot(glm::vec3(transform[0]), glm::vec3(transform[0])), glm::max(
+		glm::dot(glm::vec3(transform[1]), glm::vec3(transform[1])),
+		glm::dot(glm::vec3(transform[2]), glm::vec3(transform[2]))));
+
+	BoundingSphere result;
+	result.Center = glm::vec3(transform * glm::vec4(Center, 1.0f));
+	result.Radius = Radius * glm::sqrt(maxScaleSq);
+	return result;
+}
+
+MeshBounds MeshBounds::FromPositions(const void* data, size_t count, size_t stride, size_t offset) {
+	MeshBounds result;
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data) + offset;
+
+	// First pass gets the box, which we use as the center of the sphere
+	for (size_t ix = 0; ix < count; ix++) {
+		result.Box.Encapsulate(*reinterpret_cast<const glm::vec3*>(bytes + ix * stride));
+	}
+
+	if (!result.Box.IsValid()) {
+		return result;
+	}
+
+	// Second pass finds the furthest point from the center, which is tighter than
+	// just using the half-diagonal of the box
+	result.Sphere.Center = result.Box.GetCenter();
+	float maxDistSq = 0.0f;
+	for (size_t ix = 0; ix < count; ix++) {
+		glm::vec3 delta = *reinterpret_cast<const glm::vec3*>(bytes + ix * stride) - result.Sphere.Center;
+		maxDistSq = glm::max(maxDistSq, glm::dot(delta, delta));
+	}
+	result.Sphere.Radius = glm::sqrt(maxDistSq);
+
+	return result;
+}
+
+Frustum Frustum::FromViewProjection(const glm::mat4& viewProjection) {
+	// GLM is column major, so grab the rows to make the plane extraction easier to follow
+	glm::mat4 m = glm::transpose(viewProjection);
+
+	Frustum result;
+	result.Planes[Left]   = m[3] + m[0];
+	result.Planes[Right]  = m[3] - m[0];
+	result.Planes[Bottom] = m[3] + m[1];
+	result.Planes[Top]    = m[3] - m[1];
+	result.Planes[Near]   = m[3] + m[2];
+	result.Planes[Far]    = m[3] - m[2];
+
+	// Normalize so that the sphere test can compare against the radius
+	for (int ix = 0; ix < Count; ix++) {
+		result.Planes[ix] /= glm::length(glm::vec3(result.Planes[ix]));
+	}
+
+	return result;
+}
+
+bool Frustum::Intersects(const BoundingSphere& sphere) const {
+	for (int ix = 0; ix < Count; ix++) {
+		if (glm::dot(glm::vec3(Planes[ix]), sphere.Center) + Planes[ix].w < -sphere.Radius) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Frustum::Intersects(const AABB& box) const {
+	for (int ix = 0; ix < Count; ix++) {
+		// Test the corner of the box that is furthest along the plane normal, if
+		// even that is behind the plane, the whole box is outside
+		glm::vec3 normal = glm::vec3(Planes[ix]);
+		glm::vec3 positive = glm::vec3(
+			normal.x >= 0.0f ? box.Max.x : box.Min.x,
+			normal.y >= 0.0f ? box.Max.y : box.Min.y,
+			normal.z >= 0.0f ? box.Max.z : box.Min.z
+		);
+		if (glm::dot(normal, positive) + Planes[ix].w < 0.0f) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Frustum::Contains(const AABB& box) const {
+	for (int ix = 0; ix < Count; ix++) {
+		// Same as the intersection test, but with the corner that is furthest behind the plane
+		glm::vec3 normal = glm::vec3(Planes[ix]);
+		glm::vec3 negative = glm::vec3(
+			normal.x >= 0.0f ? box.Min.x : box.Max.x,
+			normal.y >= 0.0f ? box.Min.y : box.Max.y,
+			normal.z >= 0.0f ? box.Min.z : box.Max.z
+		);
+		if (glm::dot(normal, negative) + Planes[ix].w < 0.0f) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// An axis aligned bounding box, represented by it's minimum and maximum corners
+/// A default constructed box is empty, and will become valid once a point is added
+/// </summary>
+struct AABB {
+	glm::vec3 Min;
+	glm::vec3 Max;
+
+	AABB();
+	AABB(const glm::vec3& min, const glm::vec3& max);
+
+	/// <summary>
+	/// Returns true if this box contains at least one point
+	/// </summary>
+	bool IsValid() const;
+
+	/// <summary>
+	/// Gets the center point of the box
+	/// </summary>
+	glm::vec3 GetCenter() const;
+	/// <summary>
+	/// Gets the half-size of the box along each axis
+	/// </summary>
+	glm::vec3 GetExtents() const;
+
+	/// <summary>
+	/// Grows this box to contain the given point
+	/// </summary>
+	void Encapsulate(const glm::vec3& point);
+	/// <summary>
+	/// Grows this box to contain another box
+	/// </summary>
+	void Encapsulate(const AABB& other);
+
+	/// <summary>
+	/// Returns true if this box overlaps another box
+	/// </summary>
+	bool Intersects(const AABB& other) const;
+	/// <summary>
+	/// Returns true if the point is inside or on the surface of this box
+	/// </summary>
+	bool Contains(const glm::vec3& point) const;
+
+	/// <summary>
+	/// Transforms this box by a matrix, returning the axis aligned box that encloses the result
+	/// </summary>
+	/// <param name="transform">The transform to apply, usually an object's world transform</param>
+	AABB Transform(const glm::mat4& transform) const;
+};
+
+/// <summary>
+/// A sphere enclosing a set of points
+/// </summary>
+struct BoundingSphere {
+	glm::vec3 Center = glm::vec3(0.0f);
+	float     Radius = 0.0f;
+
+	/// <summary>
+	/// Transforms this sphere by a matrix, scaling the radius by the largest axis scale
+	/// </summary>
+	BoundingSphere Transform(const glm::mat4& transform) const;
+};
+
+/// <summary>
+/// The bounding volumes for a mesh, calculated when the mesh is built or loaded
+/// </summary>
+struct MeshBounds {
+	AABB           Box;
+	BoundingSphere Sphere;
+
+	/// <summary>
+	/// Calculates the bounds from an array of vertex positions
+	/// </summary>
+	/// <param name="data">Pointer to the first vertex</param>
+	/// <param name="count">The number of vertices</param>
+	/// <param name="stride">The size of a single vertex, in bytes</param>
+	/// <param name="offset">The offset of the vec3 position within a vertex, in bytes</param>
+	static MeshBounds FromPositions(const void* data, size_t count, size_t stride, size_t offset);
+
+	/// <summary>
+	/// Calculates the bounds from an array of vertices with a Position field
+	/// </summary>
+	/// <typeparam name="VertType">The type of vertex to read</typeparam>
+	template <typename VertType>
+	static MeshBounds FromVertices(const VertType* vertices, size_t count) {
+		return FromPositions(vertices, count, sizeof(VertType), offsetof(VertType, Position));
+	}
+};
+
+/// <summary>
+/// A view frustum, represented as 6 planes facing inwards (xyz is the normal, w is the distance)
+/// </summary>
+struct Frustum {
+	enum Plane : uint8_t {
+		Left = 0,
+		Right,
+		Bottom,
+		Top,
+		Near,
+		Far,
+		Count
+	};
+
+	glm::vec4 Planes[Plane::Count];
+
+	/// <summary>
+	/// Extracts the frustum planes from a view projection matrix (Gribb-Hartmann)
+	/// Planes will be in world space
+	/// </summary>
+	/// <param name="viewProjection">The camera's combined view projection matrix</param>
+	static Frustum FromViewProjection(const glm::mat4& viewProjection);
+
+	/// <summary>
+	/// Returns true if the sphere is at least partially inside the frustum
+	/// </summary>
+	bool Intersects(const BoundingSphere& sphere) const;
+	/// <summary>
+	/// Returns true if the box is at least partially inside the frustum. May return
+	/// true for some boxes near the corners of the frustum, but will never reject a visible box
+	/// </summary>
+	bool Intersects(const AABB& box) const;
+	/// <summary>
+	/// Returns true if the box is entirely inside the frustum
+	/// </summary>
+	bool Contains(const AABB& box) const;
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include "IBuffer.h"
+#include <memory>
+
+/// <summary>
+/// The layout of a single command for glMultiDrawElementsIndirect, as defined by the GL spec
+/// </summary>
+/// <see>https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glMultiDrawElementsIndirect.xhtml</see>
+struct DrawElementsIndirectCommand {
+	// The number of indices to draw
+	uint32_t Count;
+	// The number of instances to draw
+	uint32_t InstanceCount;
+	// The index of the first index to read from the index buffer
+	uint32_t FirstIndex;
+	// Value added to each index before fetching vertices
+	int32_t  BaseVertex;
+	// The first element to read from instanced vertex buffers
+	uint32_t BaseInstance;
+};
+
+/// <summary>
+/// The indirect buffer stores draw commands that are read by the GPU, rather than passed as parameters
+/// </summary>
+class IndirectBuffer : public IBuffer
+{
+public:
+	typedef std::shared_ptr<IndirectBuffer> Sptr;
+
+	static inline Sptr Create(BufferUsage usage = BufferUsage::DynamicDraw) {
+		return std::make_shared<IndirectBuffer>(usage);
+	}
+
+	/// <summary>
+	/// Creates a new indirect buffer, with the given usage. Data will still need to be uploaded before it can be used
+	/// </summary>
+	/// <param name="usage">The usage hint for the buffer, default is GL_DYNAMIC_DRAW</param>
+	IndirectBuffer(BufferUsage usage = BufferUsage::DynamicDraw) : IBuffer(BufferType::Indirect, usage) { }
+
+	/// <summary>
+	/// Unbinds the current indirect buffer
+	/// </summary>
+	static void UnBind() { IBuffer::UnBind(BufferType::Indirect); }
+};
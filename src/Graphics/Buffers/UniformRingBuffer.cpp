@@ -0,0 +1,144 @@
+#include "UniformRingBuffer.h"
+#include "Logging.h"
+
+UniformRingBuffer::UniformRingBuffer(uint32_t blockSize, uint32_t blocksPerFrame /*= 256*/, uint32_t framesInFlight /*= 3*/) :
+	IBuffer(BufferType::Uniform, BufferUsage::StreamDraw),
+	_blockSize(blockSize),
+	_alignedSize(0),
+	_blocksPerFrame(blocksPerFrame),
+	_framesInFlight(framesInFlight),
+	_frameIndex(0),
+	_cursor(0),
+	_mappedData(nullptr),
+	_fences(std::vector<GLsync>(framesInFlight, nullptr))
+{
+	// Blocks bound with glBindBufferRange must start on a multiple of the UBO offset alignment
+	GLint alignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	alignment = alignment > 0 ? alignment : 256;
+	_alignedSize = ((blockSize + alignment - 1) / alignment) * alignment;
+
+	_Allocate();
+}
+
+UniformRingBuffer::~UniformRingBuffer() {
+	for (GLsync& fence : _fences) {
+		if (fence != nullptr) {
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	}
+	if (_mappedData != nullptr) {
+		glUnmapNamedBuffer(_rendererId);
+		_mappedData = nullptr;
+	}
+}
+
+void UniformRingBuffer::BeginFrame(uint32_t requiredBlocks /*= 0*/) {
+	if (requiredBlocks > _blocksPerFrame) {
+		_Grow(requiredBlocks);
+	}
+
+	_frameIndex = (_frameIndex + 1) % _framesInFlight;
+	_cursor = 0;
+	_WaitForRegion(_frameIndex);
+}
+
+void UniformRingBuffer::EndFrame() {
+	if (_fences[_frameIndex] != nullptr) {
+		glDeleteSync(_fences[_frameIndex]);
+	}
+	_fences[_frameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+uint32_t UniformRingBuffer::Push(const void* data, uint32_t size) {
+	LOG_ASSERT(size <= _blockSize, "Data exceeds the block size of this ring buffer");
+	LOG_ASSERT(_cursor < _blocksPerFrame, "Ring buffer is full, pass the block count to BeginFrame");
+
+	uint32_t offset = (_frameIndex * _blocksPerFrame + _cursor) * _alignedSize;
+	memcpy(_mappedData + offset, data, size);
+	_cursor++;
+	return offset;
+}
+
+void UniformRingBuffer::BindRange(int slot, uint32_t offset) const {
+	glBindBufferRange(GL_UNIFORM_BUFFER, slot, _rendererId, offset, _blockSize);
+}
+
+uint32_t UniformRingBuffer::GetBlockOffset(uint32_t index) const {
+	return (_frameIndex * _blocksPerFrame + index) * _alignedSize;
+}
+
+void UniformRingBuffer::LoadData(const void* data, uint32_t elementSize, uint32_t elementCount) {
+	UpdateData(data, elementSize, elementCount, true);
+}
+
+void UniformRingBuffer::UpdateData(const void* data, uint32_t elementSize, uint32_t elementCount, bool allowResize) {
+	LOG_ASSERT(elementSize <= _blockSize, "Elements exceed the block size of this ring buffer");
+	if (elementCount > _blocksPerFrame) {
+		LOG_ASSERT(allowResize, "Attempting to write beyond the end of the buffer!");
+		_Grow(elementCount);
+	}
+
+	// Each element gets a block of it's own, so they all start on the UBO offset alignment
+	_cursor = 0;
+	const uint8_t* elements = reinterpret_cast<const uint8_t*>(data);
+	for (uint32_t ix = 0; ix < elementCount; ix++) {
+		Push(elements + static_cast<size_t>(ix) * elementSize, elementSize);
+	}
+}
+
+void UniformRingBuffer::_Allocate() {
+	_size = _alignedSize * _blocksPerFrame * _framesInFlight;
+	_elementSize = _alignedSize;
+	_elementCount = _blocksPerFrame * _framesInFlight;
+
+	// Coherent mapping means our writes are visible to the GPU without any explicit flushes,
+	// the fences are what keep us from stomping on data that is still in use
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glNamedBufferStorage(_rendererId, _size, nullptr, flags);
+	_mappedData = reinterpret_cast<uint8_t*>(glMapNamedBufferRange(_rendererId, 0, _size, flags));
+}
+
+void UniformRingBuffer::_Grow(uint32_t requiredBlocks) {
+	// Buffer storage is immutable, so growing means waiting for the GPU to be done with all of it
+	// and creating a new buffer object
+	for (uint32_t ix = 0; ix < _framesInFlight; ix++) {
+		_WaitForRegion(ix);
+	}
+
+	uint32_t newSize = _blocksPerFrame;
+	while (newSize < requiredBlocks) {
+		newSize *= 2;
+	}
+	LOG_INFO("Expanding uniform ring buffer from {} to {} blocks per frame", _blocksPerFrame, newSize);
+	_blocksPerFrame = newSize;
+
+	glUnmapNamedBuffer(_rendererId);
+	glDeleteBuffers(1, &_rendererId);
+	GLuint handle = 0;
+	glCreateBuffers(1, &handle);
+	_SetRenderId(handle);
+	_Allocate();
+}
+
+void UniformRingBuffer::_WaitForRegion(uint32_t index) {
+	GLsync& fence = _fences[index];
+	if (fence == nullptr) {
+		return;
+	}
+
+	// The first wait flushes so the fence is guaranteed to be signaled eventually, then we
+	// keep waiting in 1ms increments. In practice the region is almost always free already
+	GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	while (true) {
+		GLenum result = glClientWaitSync(fence, waitFlags, 1000000);
+		if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED) {
+			break;
+		}
+		waitFlags = 0;
+	}
+
+	glDeleteSync(fence);
+	fence = nullptr;
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include "IBuffer.h"
+#include <memory>
+#include <vector>
+
+/// <summary>
+/// A uniform buffer that is split into fixed size blocks and persistently mapped, for
+/// data that changes for every draw (ex: instance level uniforms)
+///
+/// The buffer holds a region per frame in flight. Each frame writes blocks into it's own
+/// region and binds them with glBindBufferRange, and a fence is placed at the end of the frame
+/// so that we never overwrite a region the GPU may still be reading from
+/// </summary>
+class UniformRingBuffer : public IBuffer {
+public:
+	typedef std::shared_ptr<UniformRingBuffer> Sptr;
+
+	/// <summary>
+	/// Creates a new ring buffer for blocks of the given size
+	/// </summary>
+	/// <param name="blockSize">The size of a single block in bytes, usually the size of a UBO structure</param>
+	/// <param name="blocksPerFrame">The initial number of blocks that can be written each frame, will grow as needed</param>
+	/// <param name="framesInFlight">The number of frames the CPU is allowed to run ahead of the GPU</param>
+	UniformRingBuffer(uint32_t blockSize, uint32_t blocksPerFrame = 256, uint32_t framesInFlight = 3);
+	virtual ~UniformRingBuffer();
+
+	/// <summary>
+	/// Moves to the next frame's region, waiting on the GPU if it is still reading from it
+	/// </summary>
+	/// <param name="requiredBlocks">The number of blocks that will be written this frame, the buffer will be re-allocated if it is too small</param>
+	void BeginFrame(uint32_t requiredBlocks = 0);
+	/// <summary>
+	/// Places a fence after all the commands that use the current frame's region
+	/// </summary>
+	void EndFrame();
+
+	/// <summary>
+	/// Copies a block of data into the current frame's region
+	/// </summary>
+	/// <param name="data">The data to copy, must be at most GetBlockSize bytes</param>
+	/// <param name="size">The size of the data in bytes</param>
+	/// <returns>The offset of the block in the buffer, for use with BindRange</returns>
+	uint32_t Push(const void* data, uint32_t size);
+	/// <summary>
+	/// Copies a structure into the current frame's region
+	/// </summary>
+	/// <returns>The offset of the block in the buffer, for use with BindRange</returns>
+	template <typename T>
+	uint32_t Push(const T& data) {
+		return Push(&data, sizeof(T));
+	}
+
+	/// <summary>
+	/// Binds a single block of this buffer to the given uniform binding slot
+	/// </summary>
+	/// <param name="slot">The uniform buffer binding slot</param>
+	/// <param name="offset">The offset of the block, as returned by Push</param>
+	void BindRange(int slot, uint32_t offset) const;
+
+	/// <summary>
+	/// Gets the offset of one of the current frame's blocks, for use with BindRange
+	/// </summary>
+	/// <param name="index">The index of the block within the frame's region</param>
+	uint32_t GetBlockOffset(uint32_t index) const;
+
+	/// <summary>
+	/// Gets the size of a single block, without alignment padding
+	/// </summary>
+	uint32_t GetBlockSize() const { return _blockSize; }
+	/// <summary>
+	/// Gets the number of blocks that can be written per frame
+	/// </summary>
+	uint32_t GetBlocksPerFrame() const { return _blocksPerFrame; }
+
+	/// <summary>
+	/// Replaces the blocks written so far this frame with an array of blocks, growing the buffer if
+	/// needed. Element i can then be bound with BindRange(slot, GetBlockOffset(i))
+	/// </summary>
+	/// <param name="data">The blocks to copy</param>
+	/// <param name="elementSize">The size of a single block in bytes, must be at most GetBlockSize</param>
+	/// <param name="elementCount">The number of blocks to copy</param>
+	virtual void LoadData(const void* data, uint32_t elementSize, uint32_t elementCount) override;
+	/// <summary>
+	/// Same as LoadData, but asserts instead of growing the buffer if allowResize is false
+	/// </summary>
+	virtual void UpdateData(const void* data, uint32_t elementSize, uint32_t elementCount, bool allowResize = true) override;
+	/// <summary>
+	/// Replaces the blocks written so far this frame with an array of structures, see LoadData
+	/// </summary>
+	/// <typeparam name="T">The type of block to upload</typeparam>
+	/// <param name="data">A pointer to the first block</param>
+	/// <param name="count">The number of blocks to copy</param>
+	template <typename T>
+	void LoadData(const T* data, uint32_t count) {
+		// IBuffer's version calls IBuffer::LoadData directly, which would try to re-specify our immutable storage
+		LoadData(static_cast<const void*>(data), sizeof(T), count);
+	}
+
+protected:
+	uint32_t _blockSize;       // The size of a block, in bytes
+	uint32_t _alignedSize;     // The block size, rounded up to the UBO offset alignment
+	uint32_t _blocksPerFrame;  // The number of blocks in each frame's region
+	uint32_t _framesInFlight;  // The number of regions in the buffer
+	uint32_t _frameIndex;      // The region that is currently being written to
+	uint32_t _cursor;          // The next block to write in the current region
+	uint8_t* _mappedData;      // Persistently mapped pointer to the start of the buffer
+
+	// One fence per region, nullptr if the region is not in use by the GPU
+	std::vector<GLsync> _fences;
+
+	/// <summary>
+	/// Creates the storage for the buffer and maps it
+	/// </summary>
+	void _Allocate();
+	/// <summary>
+	/// Waits for the GPU to finish with the whole buffer, then re-creates it with room for at least the given
+	/// number of blocks per frame
+	/// </summary>
+	void _Grow(uint32_t requiredBlocks);
+	/// <summary>
+	/// Blocks until the GPU is done with the given region
+	/// </summary>
+	void _WaitForRegion(uint32_t index);
+};
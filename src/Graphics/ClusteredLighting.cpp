@@ -0,0 +1,194 @@
+#include "ClusteredLighting.h"
+
+/// <summary>
+/// Finds the range of tiles covered by a view space sphere between two depths
+/// </summary>
+/// <returns>False if the sphere is entirely off screen</returns>
+static bool GetTileBounds(const glm::vec3& center, float radius, float minDepth, float maxDepth,
+						  const glm::mat4& projection, bool isOrtho, glm::uvec2& minTile, glm::uvec2& maxTile)
+{
+	static const glm::vec2 gridSize = glm::vec2(ClusteredLighting::GRID_X, ClusteredLighting::GRID_Y);
+
+	glm::vec2 minNdc, maxNdc;
+	for (int axis = 0; axis < 2; axis++) {
+		float low  = center[axis] - radius;
+		float high = center[axis] + radius;
+		float scale = projection[axis][axis];
+
+		if (isOrtho) {
+			minNdc[axis] = low * scale + projection[3][axis];
+			maxNdc[axis] = high * scale + projection[3][axis];
+		} else {
+			// Bounding the sphere with a box between the two depths, x / depth is monotonic
+			// along depth so the extremes are always at one of the two ends
+			// Note that this assumes a symmetric frustum, as made by glm::perspective
+			minNdc[axis] = scale * glm::min(low / minDepth, low / maxDepth);
+			maxNdc[axis] = scale * glm::max(high / minDepth, high / maxDepth);
+		}
+	}
+
+	if (maxNdc.x < -1.0f || maxNdc.y < -1.0f || minNdc.x > 1.0f || minNdc.y > 1.0f) {
+		return false;
+	}
+
+	glm::vec2 low  = glm::floor((glm::clamp(minNdc, -1.0f, 1.0f) * 0.5f + 0.5f) * gridSize);
+	glm::vec2 high = glm::floor((glm::clamp(maxNdc, -1.0f, 1.0f) * 0.5f + 0.5f) * gridSize);
+	minTile = glm::min(glm::uvec2(low), glm::uvec2(gridSize) - 1u);
+	maxTile = glm::min(glm::uvec2(high), glm::uvec2(gridSize) - 1u);
+	return true;
+}
+
+ClusteredLighting::ClusteredLighting() :
+	_lights(std::vector<GpuLight>()),
+	_clusters(std::vector<ClusterRange>()),
+	_indices(std::vector<uint32_t>()),
+	_spans(std::vector<LightSpan>()),
+	_lightBuffer(nullptr),
+	_clusterBuffer(nullptr),
+	_indexBuffer(nullptr),
+	_uniforms(nullptr)
+{
+	_lightBuffer = ShaderStorageBuffer::Create();
+	_lightBuffer->SetDebugName("Clustered Lights");
+	_clusterBuffer = ShaderStorageBuffer::Create();
+	_clusterBuffer->SetDebugName("Light Clusters");
+	_indexBuffer = ShaderStorageBuffer::Create();
+	_indexBuffer->SetDebugName("Light Cluster Indices");
+	_uniforms = std::make_shared<UniformBuffer<ClusterUniforms>>(BufferUsage::DynamicDraw);
+}
+
+void ClusteredLighting::Update(const std::vector<Gameplay::Light>& lights, const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane, bool isOrtho)
+{
+	// Slices are spaced evenly in log(depth), so slice = log(depth) * scale + bias. Orthographic
+	// cameras don't have a meaningful w, so they get a single slice covering the whole view
+	const uint32_t sliceCount = isOrtho ? 1 : GRID_Z;
+	const float depthScale = isOrtho ? 0.0f : GRID_Z / glm::log(farPlane / nearPlane);
+	const float depthBias  = isOrtho ? 0.0f : -glm::log(nearPlane) * depthScale;
+
+	_lights.clear();
+	_spans.clear();
+	for (uint32_t ix = 0; ix < lights.size(); ix++) {
+		const Gameplay::Light& light = lights[ix];
+		float radius = GetCutoffRadius(light);
+		_lights.push_back({ glm::vec4(light.Position, radius), glm::vec4(light.Color, 1.0f / (1.0f + light.Range)) });
+
+		// View space looks down -Z, so negate to get depths in front of the camera
+		glm::vec3 center = glm::vec3(view * glm::vec4(light.Position, 1.0f));
+		float minDepth = glm::max(-center.z - radius, nearPlane);
+		float maxDepth = glm::min(-center.z + radius, farPlane);
+		if (minDepth > maxDepth) {
+			continue;
+		}
+
+		uint32_t firstSlice = 0, lastSlice = 0;
+		if (!isOrtho) {
+			firstSlice = static_cast<uint32_t>(glm::clamp(glm::log(minDepth) * depthScale + depthBias, 0.0f, GRID_Z - 1.0f));
+			lastSlice  = static_cast<uint32_t>(glm::clamp(glm::log(maxDepth) * depthScale + depthBias, 0.0f, GRID_Z - 1.0f));
+		}
+
+		// Narrow the depth range down to each slice, since a light covers less of the screen the further it is
+		for (uint32_t slice = firstSlice; slice <= lastSlice; slice++) {
+			float sliceNear = minDepth, sliceFar = maxDepth;
+			if (!isOrtho) {
+				sliceNear = glm::max(minDepth, glm::exp((slice - depthBias) / depthScale));
+				sliceFar  = glm::min(maxDepth, glm::exp((slice + 1 - depthBias) / depthScale));
+			}
+
+			LightSpan span;
+			span.Light = ix;
+			span.Slice = slice;
+			if (GetTileBounds(center, radius, sliceNear, sliceFar, projection, isOrtho, span.Min, span.Max)) {
+				_spans.push_back(span);
+			}
+		}
+	}
+
+	// Count the lights in each cluster, then turn the counts into offsets so the index list is packed
+	_clusters.assign(GRID_X * GRID_Y * sliceCount, { 0, 0 });
+	for (const LightSpan& span : _spans) {
+		for (uint32_t y = span.Min.y; y <= span.Max.y; y++) {
+			for (uint32_t x = span.Min.x; x <= span.Max.x; x++) {
+				_clusters[x + GRID_X * (y + GRID_Y * span.Slice)].Count++;
+			}
+		}
+	}
+	uint32_t total = 0;
+	for (ClusterRange& cluster : _clusters) {
+		cluster.Offset = total;
+		total += cluster.Count;
+		cluster.Count = 0;
+	}
+	_indices.resize(total);
+	for (const LightSpan& span : _spans) {
+		for (uint32_t y = span.Min.y; y <= span.Max.y; y++) {
+			for (uint32_t x = span.Min.x; x <= span.Max.x; x++) {
+				ClusterRange& cluster = _clusters[x + GRID_X * (y + GRID_Y * span.Slice)];
+				_indices[cluster.Offset + cluster.Count++] = span.Light;
+			}
+		}
+	}
+
+	// Empty buffers can't be bound, so we always upload at least one element
+	static const GpuLight noLight ={ glm::vec4(0.0f), glm::vec4(0.0f) };
+	static const uint32_t noIndex = 0;
+	_lightBuffer->LoadData(_lights.empty() ? &noLight : _lights.data(), glm::max(static_cast<uint32_t>(_lights.size()), 1u));
+	_clusterBuffer->LoadData(_clusters.data(), static_cast<uint32_t>(_clusters.size()));
+	_indexBuffer->LoadData(_indices.empty() ? &noIndex : _indices.data(), glm::max(total, 1u));
+
+	ClusterUniforms& data = _uniforms->GetData();
+	data.ViewProjection = projection * view;
+	data.GridSize = glm::uvec4(GRID_X, GRID_Y, sliceCount, 0);
+	data.DepthParams = glm::vec4(depthScale, depthBias, 0.0f, 0.0f);
+	_uniforms->Update();
+}
+
+void ClusteredLighting::Bind() const
+{
+	_uniforms->Bind(CLUSTER_UBO_BINDING);
+	_lightBuffer->Bind(LIGHT_SSBO_BINDING);
+	_clusterBuffer->Bind(CLUSTER_SSBO_BINDING);
+	_indexBuffer->Bind(INDEX_SSBO_BINDING);
+}
+
+uint32_t ClusteredLighting::SelectObjectLights(const BoundingSphere& bounds, glm::vec4& outIndices) const
+{
+	float scores[MAX_OBJECT_LIGHTS];
+	uint32_t count = 0;
+	outIndices = glm::vec4(-1.0f);
+
+	for (uint32_t ix = 0; ix < _lights.size(); ix++) {
+		const GpuLight& light = _lights[ix];
+		float radius = light.PositionRadius.w;
+		float dist = glm::max(glm::distance(glm::vec3(light.PositionRadius), bounds.Center) - bounds.Radius, 0.0f);
+		if (dist >= radius) {
+			continue;
+		}
+
+		// Same falloff as CalcPointLightContribution, weighted by how bright the light's color is
+		float window = 1.0f - glm::pow(dist / radius, 4.0f);
+		float brightness = glm::dot(glm::vec3(light.ColorAttenuation), glm::vec3(0.2126f, 0.7152f, 0.0722f));
+		float score = brightness * window * window / (1.0f + light.ColorAttenuation.w * dist * dist);
+		if (count == MAX_OBJECT_LIGHTS && score <= scores[count - 1]) {
+			continue;
+		}
+
+		// Insertion sort into the list, dropping the dimmest light if it's full
+		uint32_t slot = count < MAX_OBJECT_LIGHTS ? count++ : count - 1;
+		while (slot > 0 && scores[slot - 1] < score) {
+			scores[slot] = scores[slot - 1];
+			outIndices[slot] = outIndices[slot - 1];
+			slot--;
+		}
+		scores[slot] = score;
+		outIndices[slot] = static_cast<float>(ix);
+	}
+
+	return count;
+}
+
+float ClusteredLighting::GetCutoffRadius(const Gameplay::Light& light)
+{
+	// Solving 1 / (1 + attenuation * d^2) = cutoff for d, see CalcPointLightContribution
+	float attenuation = 1.0f / (1.0f + light.Range);
+	return glm::sqrt((1.0f / LIGHT_CUTOFF - 1.0f) / attenuation);
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include <vector>
+#include <GLM/glm.hpp>
+
+#include "Gameplay/Light.h"
+#include "Graphics/BoundingVolume.h"
+#include "Graphics/Buffers/ShaderStorageBuffer.h"
+#include "Graphics/Buffers/UniformBuffer.h"
+#include "Utils/Macros.h"
+
+/// <summary>
+/// Assigns lights to a 3D grid of clusters over the camera's view, so that each fragment only
+/// has to loop over the lights that can actually reach it
+///
+/// The screen is split into tiles, and the view depth into slices that get exponentially
+/// thicker further from the camera. Every frame each light's sphere of influence is tested
+/// against the grid on the CPU, and the results are uploaded as a compact list of light indices
+/// per cluster. See fragments/multiple_point_lights.glsl for the shader side
+/// </summary>
+class ClusteredLighting final {
+public:
+	MAKE_PTRS(ClusteredLighting);
+	NO_COPY(ClusteredLighting);
+	NO_MOVE(ClusteredLighting);
+
+	// The number of clusters along each axis, these get sent to the shader so they can be tweaked freely
+	static constexpr uint32_t GRID_X = 16;
+	static constexpr uint32_t GRID_Y = 9;
+	static constexpr uint32_t GRID_Z = 24;
+
+	// Lights are cut off once their attenuation falls below this, lower values mean bigger clusters
+	static constexpr float LIGHT_CUTOFF = 1.0f / 256.0f;
+	// The most lights that SelectObjectLights will pick, matches the ivec4 in multiple_point_lights.glsl
+	static constexpr uint32_t MAX_OBJECT_LIGHTS = 4;
+
+	static const int CLUSTER_UBO_BINDING = 3;
+	static const int LIGHT_SSBO_BINDING = 0;
+	static const int CLUSTER_SSBO_BINDING = 1;
+	static const int INDEX_SSBO_BINDING = 2;
+
+	ClusteredLighting();
+	~ClusteredLighting() = default;
+
+	/// <summary>
+	/// Assigns all the lights to clusters for the given camera, and uploads the results to the GPU
+	/// </summary>
+	/// <param name="lights">The lights to assign</param>
+	/// <param name="view">The camera's view matrix</param>
+	/// <param name="projection">The camera's projection matrix</param>
+	/// <param name="nearPlane">The distance to the camera's near plane</param>
+	/// <param name="farPlane">The distance to the camera's far plane</param>
+	/// <param name="isOrtho">True if the projection is orthographic, in which case only a single depth slice is used</param>
+	void Update(const std::vector<Gameplay::Light>& lights, const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane, bool isOrtho);
+
+	/// <summary>
+	/// Binds the cluster uniforms and storage buffers to their slots
+	/// </summary>
+	void Bind() const;
+
+	/// <summary>
+	/// Gets the number of lights that were uploaded in the last update
+	/// </summary>
+	uint32_t GetLightCount() const { return static_cast<uint32_t>(_lights.size()); }
+	/// <summary>
+	/// Gets the total number of light indices across all clusters in the last update, each entry is a
+	/// light that a fragment in that cluster will evaluate
+	/// </summary>
+	uint32_t GetIndexCount() const { return static_cast<uint32_t>(_indices.size()); }
+
+	/// <summary>
+	/// Picks the lights from the last update that contribute the most to an object, scored by how bright
+	/// each light is at the closest point of the object's bounding sphere. This is the alternative to the
+	/// clusters for shaders compiled with PER_OBJECT_LIGHTS, and only reads from the light list, so it
+	/// can be called from many threads at once between updates
+	/// </summary>
+	/// <param name="bounds">The object's world space bounding sphere</param>
+	/// <param name="outIndices">Receives the indices of the brightest lights in order, with -1 in any unused slots</param>
+	/// <returns>The number of lights that were picked</returns>
+	uint32_t SelectObjectLights(const BoundingSphere& bounds, glm::vec4& outIndices) const;
+
+	/// <summary>
+	/// Gets the distance at which a light's contribution falls below LIGHT_CUTOFF
+	/// </summary>
+	static float GetCutoffRadius(const Gameplay::Light& light);
+
+protected:
+	// Matches the Light struct in multiple_point_lights.glsl
+	struct GpuLight {
+		// World space position in xyz, cutoff radius in w
+		glm::vec4 PositionRadius;
+		// Stores color in RGB and attenuation in w
+		glm::vec4 ColorAttenuation;
+	};
+
+	// The range of a cluster in the index list
+	struct ClusterRange {
+		uint32_t Offset;
+		uint32_t Count;
+	};
+
+	// Matches b_LightClusterBlock in multiple_point_lights.glsl
+	struct ClusterUniforms {
+		// The view projection used to build the clusters, for finding a fragment's tile and depth
+		glm::mat4  ViewProjection;
+		// The number of clusters along each axis in xyz
+		glm::uvec4 GridSize;
+		// The scale and bias to turn log(depth) into a slice index
+		glm::vec4  DepthParams;
+	};
+
+	// A rectangle of tiles in a single slice that a light touches
+	struct LightSpan {
+		uint32_t Light;
+		uint32_t Slice;
+		glm::uvec2 Min;
+		glm::uvec2 Max;
+	};
+
+	std::vector<GpuLight>     _lights;
+	std::vector<ClusterRange> _clusters;
+	std::vector<uint32_t>     _indices;
+	std::vector<LightSpan>    _spans;
+
+	ShaderStorageBuffer::Sptr _lightBuffer;
+	ShaderStorageBuffer::Sptr _clusterBuffer;
+	ShaderStorageBuffer::Sptr _indexBuffer;
+	UniformBuffer<ClusterUniforms>::Sptr _uniforms;
+};
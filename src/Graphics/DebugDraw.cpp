@@ -1,19 +1,22 @@
 #include "Graphics/DebugDraw.h"
+#include <cstring>
 
 DebugDrawer::DebugDrawer() :
 	_colorStack(std::stack<glm::vec3>()),
 	_transformStack(std::stack<glm::mat4>()),
 	_viewProjection(glm::mat4(1.0f)),
 	_lineOffset(0),
-	_triangleOffset(0)
+	_triangleOffset(0),
+	_lineStreamCursor(0),
+	_triStreamCursor(0)
 {
-	_linesVBO = VertexBuffer::Create(BufferUsage::DynamicDraw);
-	_linesVBO->LoadData<VertexPosCol>(nullptr, LINE_BATCH_SIZE * 2);
+	_linesVBO = VertexBuffer::Create(BufferUsage::StreamDraw);
+	_linesVBO->LoadData<VertexPosCol>(nullptr, LINE_BATCH_SIZE * 2 * STREAM_BATCH_COUNT);
 	_linesVAO = VertexArrayObject::Create();
 	_linesVAO->AddVertexBuffer(_linesVBO, VertexPosCol::V_DECL);
 
-	_trisVBO = VertexBuffer::Create(BufferUsage::DynamicDraw);
-	_trisVBO->LoadData<VertexPosCol>(nullptr, TRI_BATCH_SIZE * 3);
+	_trisVBO = VertexBuffer::Create(BufferUsage::StreamDraw);
+	_trisVBO->LoadData<VertexPosCol>(nullptr, TRI_BATCH_SIZE * 3 * STREAM_BATCH_COUNT);
 	_trisVAO = VertexArrayObject::Create();
 	_trisVAO->AddVertexBuffer(_trisVBO, VertexPosCol::V_DECL);
 
@@ -60,7 +63,7 @@ void DebugDrawer::DrawLine(const glm::vec3& p1, const glm::vec3& p2, const glm::
 	_lineBuffer[_lineOffset + 1].Position = p2;
 
 	_lineOffset += 2;
-	if (_lineOffset >= LINE_BATCH_SIZE) {
+	if (_lineOffset >= LINE_BATCH_SIZE * 2) {
 		FlushLines();
 	}
 }
@@ -70,16 +73,12 @@ void DebugDrawer::FlushLines()
 	if (_lineOffset > 0) {
 		__Shader->Bind();
 		__Shader->SetUniformMatrix("u_MVP", _viewProjection * _transformStack.top());
-		int restorePoint = 0;
-		glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &restorePoint);
-		VertexArrayObject::Unbind();
-		_linesVBO->LoadData<VertexPosCol>(_lineBuffer, LINE_BATCH_SIZE * 2);
-		_linesVAO->Bind();
-		_linesVAO->Draw(DrawMode::LineList);
-		_linesVAO->Unbind();
+		GLuint restorePoint = VertexArrayObject::GetBoundHandle();
+		size_t first = _StreamVertices(_linesVBO, _lineStreamCursor, LINE_BATCH_SIZE * 2 * STREAM_BATCH_COUNT, _lineBuffer, _lineOffset);
+		_linesVAO->DrawRange(static_cast<uint32_t>(first), static_cast<uint32_t>(_lineOffset), DrawMode::LineList);
 		_lineOffset = 0;
 		if (restorePoint != 0) {
-			glBindVertexArray(restorePoint);
+			VertexArrayObject::BindHandle(restorePoint);
 		}
 	}
 }
@@ -103,7 +102,7 @@ void DebugDrawer::DrawTri(const glm::vec3& p1, const glm::vec3& p2, const glm::v
 	_triBuffer[_triangleOffset + 2].Position = p3;
 
 	_triangleOffset += 3;
-	if (_triangleOffset >= TRI_BATCH_SIZE) {
+	if (_triangleOffset >= TRI_BATCH_SIZE * 3) {
 		FlushTris();
 	}
 }
@@ -113,20 +112,41 @@ void DebugDrawer::FlushTris()
 	if (_triangleOffset > 0) {
 		__Shader->Bind();
 		__Shader->SetUniformMatrix("u_MVP", _viewProjection * _transformStack.top());
-		int restorePoint = 0;
-		glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &restorePoint);
-		VertexArrayObject::Unbind();
-		_trisVBO->LoadData<VertexPosCol>(_triBuffer, TRI_BATCH_SIZE * 3);
-		_trisVAO->Bind();
-		_trisVAO->Draw(DrawMode::LineList);
-		_trisVAO->Unbind();
+		GLuint restorePoint = VertexArrayObject::GetBoundHandle();
+		size_t first = _StreamVertices(_trisVBO, _triStreamCursor, TRI_BATCH_SIZE * 3 * STREAM_BATCH_COUNT, _triBuffer, _triangleOffset);
+		_trisVAO->DrawRange(static_cast<uint32_t>(first), static_cast<uint32_t>(_triangleOffset), DrawMode::TriangleList);
 		_triangleOffset = 0;
 		if (restorePoint != 0) {
-			glBindVertexArray(restorePoint);
+			VertexArrayObject::BindHandle(restorePoint);
 		}
 	}
 }
 
+size_t DebugDrawer::_StreamVertices(const VertexBuffer::Sptr& buffer, size_t& cursor, size_t capacity, const VertexPosCol* data, size_t count)
+{
+	// Once we run out of room, hand the old storage back to the driver and start over in a fresh block,
+	// rather than waiting for draws that are still reading from it
+	if (cursor + count > capacity) {
+		buffer->LoadData<VertexPosCol>(nullptr, static_cast<uint32_t>(capacity));
+		cursor = 0;
+	}
+
+	// Nothing has been drawn from this range since the buffer was last orphaned, so there's no need to sync
+	size_t first = cursor;
+	GLintptr offset = static_cast<GLintptr>(first * sizeof(VertexPosCol));
+	GLsizeiptr size = static_cast<GLsizeiptr>(count * sizeof(VertexPosCol));
+	void* mapped = glMapNamedBufferRange(buffer->GetHandle(), offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if (mapped != nullptr) {
+		memcpy(mapped, data, size);
+		glUnmapNamedBuffer(buffer->GetHandle());
+	} else {
+		glNamedBufferSubData(buffer->GetHandle(), offset, size, data);
+	}
+
+	cursor += count;
+	return first;
+}
+
 void DebugDrawer::FlushAll()
 {
 	FlushLines();
@@ -15,6 +15,8 @@ class DebugDrawer
 public:
 	inline static const size_t LINE_BATCH_SIZE = 8192;
 	inline static const size_t TRI_BATCH_SIZE = 4096;
+	// How many full batches the streaming buffers can hold before they wrap around and get orphaned
+	inline static const size_t STREAM_BATCH_COUNT = 4;
 
 	// Delete copy and mode
 
@@ -143,6 +145,22 @@ protected:
 	VertexBuffer::Sptr _trisVBO;
 	VertexArrayObject::Sptr _trisVAO;
 
+	// The next free vertex in each of the streaming buffers
+	size_t       _lineStreamCursor;
+	size_t       _triStreamCursor;
+
+	/// <summary>
+	/// Appends vertices to a streaming buffer after the ones written by previous flushes, orphaning
+	/// the buffer when it's full, so we never write over vertices the GPU may still be reading
+	/// </summary>
+	/// <param name="buffer">The buffer to write to</param>
+	/// <param name="cursor">The next free vertex in the buffer, advanced past the new vertices</param>
+	/// <param name="capacity">The number of vertices the buffer holds</param>
+	/// <param name="data">The vertices to upload</param>
+	/// <param name="count">The number of vertices to upload</param>
+	/// <returns>The index of the first uploaded vertex in the buffer</returns>
+	static size_t _StreamVertices(const VertexBuffer::Sptr& buffer, size_t& cursor, size_t capacity, const VertexPosCol* data, size_t count);
+
 	inline static DebugDrawer* __Instance = nullptr;
 	inline static ShaderProgram::Sptr __Shader = nullptr;
 };
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "GeometryPool.h"
+#include "Logging.h"
+
+GeometryPool::GeometryPool(const VertexArrayObject::VertexDeclaration& vDecl, uint32_t vertexStride, uint32_t initialVertices, uint32_t initialIndices) :
+	_vDecl(vDecl),
+	_vertexStride(vertexStride),
+	_vertices(nullptr),
+	_indices(nullptr),
+	_vao(nullptr),
+	_vertexCount(0),
+	_indexCount(0),
+	_vertexCapacity(0),
+	_indexCapacity(0),
+	_entries(std::unordered_map<VertexArrayObject*, Entry>()),
+	_vertexRanges(std::unordered_map<VertexBuffer*, VertexRange>())
+{
+	_Reserve(initialVertices, initialIndices);
+}
+
+const GeometryPool::Allocation* GeometryPool::GetAllocation(const VertexArrayObject::Sptr& mesh) {
+	if (mesh == nullptr) {
+		return nullptr;
+	}
+
+	// Make sure the entry is actually for this mesh, and not an old one that lived at the same address
+	auto it = _entries.find(mesh.get());
+	if (it != _entries.end() && it->second.Source.lock() == mesh) {
+		return it->second.Valid ? &it->second.Alloc : nullptr;
+	}
+
+	Entry& entry = _entries[mesh.get()];
+	entry.Source = mesh;
+	entry.Valid = _IsCompatible(mesh);
+	if (!entry.Valid) {
+		return nullptr;
+	}
+
+	const VertexBuffer::Sptr& srcVertices = mesh->GetBufferBinding(AttribUsage::Position)->GetBuffer();
+	const IndexBuffer::Sptr srcIndices = mesh->GetIndexBuffer();
+	uint32_t numIndices = srcIndices->GetElementCount();
+
+	// Meshes that share a vertex buffer (ex: the LODs of a mesh) only need their vertices in the pool once
+	auto range = _vertexRanges.find(srcVertices.get());
+	bool sharedVertices = range != _vertexRanges.end() && range->second.Source.lock() == srcVertices;
+	uint32_t numVertices = sharedVertices ? 0 : srcVertices->GetElementCount();
+
+	_Reserve(_vertexCount + numVertices, _indexCount + numIndices);
+
+	// Copy the mesh into the end of our buffers, this all stays on the GPU
+	if (sharedVertices) {
+		entry.Alloc.BaseVertex = range->second.BaseVertex;
+	} else {
+		glCopyNamedBufferSubData(srcVertices->GetHandle(), _vertices->GetHandle(), 0, (GLintptr)_vertexCount * _vertexStride, (GLsizeiptr)numVertices * _vertexStride);
+		entry.Alloc.BaseVertex = static_cast<int32_t>(_vertexCount);
+		_vertexRanges[srcVertices.get()] ={ srcVertices, entry.Alloc.BaseVertex };
+	}
+	glCopyNamedBufferSubData(srcIndices->GetHandle(), _indices->GetHandle(), 0, (GLintptr)_indexCount * sizeof(uint32_t), (GLsizeiptr)numIndices * sizeof(uint32_t));
+
+	entry.Alloc.FirstIndex = _indexCount;
+	entry.Alloc.IndexCount = numIndices;
+
+	_vertexCount += numVertices;
+	_indexCount += numIndices;
+
+	LOG_TRACE("Added mesh \"{}\" to geometry pool ({} vertices, {} indices)", mesh->GetDebugName(), numVertices, numIndices);
+
+	return &entry.Alloc;
+}
+
+bool GeometryPool::_IsCompatible(const VertexArrayObject::Sptr& mesh) const {
+	// We need indices to be able to use base vertex offsets
+	const IndexBuffer::Sptr indices = mesh->GetIndexBuffer();
+	if (indices == nullptr || indices->GetElementType() != IndexType::UInt) {
+		return false;
+	}
+
+	// All attributes need to come from a single interleaved buffer with our layout
+	VertexArrayObject::VertexBufferBinding* binding = mesh->GetBufferBinding(AttribUsage::Position);
+	if (binding == nullptr || binding->IsInstanced() || binding->GetBuffer()->GetElementSize() != _vertexStride) {
+		return false;
+	}
+
+	const std::vector<BufferAttribute>& attribs = binding->GetAttributes();
+	if (attribs.size() != _vDecl.size()) {
+		return false;
+	}
+	for (size_t ix = 0; ix < attribs.size(); ix++) {
+		const BufferAttribute& a = attribs[ix];
+		const BufferAttribute& b = _vDecl[ix];
+		if (a.Slot != b.Slot || a.Size != b.Size || a.Type != b.Type || a.Normalized != b.Normalized || a.Stride != b.Stride || a.Offset != b.Offset) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void GeometryPool::_Reserve(uint32_t vertices, uint32_t indices) {
+	bool changed = false;
+
+	if (vertices > _vertexCapacity || _vertices == nullptr) {
+		uint32_t capacity = glm::max(_vertexCapacity, 1u);
+		while (capacity < vertices) {
+			capacity *= 2;
+		}
+
+		// Buffers can't be resized in place, so we make a new one and copy over what we have so far
+		VertexBuffer::Sptr buffer = VertexBuffer::Create(BufferUsage::StaticDraw);
+		buffer->SetDebugName("Geometry Pool Vertices");
+		buffer->LoadData(nullptr, _vertexStride, capacity);
+		if (_vertices != nullptr && _vertexCount > 0) {
+			glCopyNamedBufferSubData(_vertices->GetHandle(), buffer->GetHandle(), 0, 0, (GLsizeiptr)_vertexCount * _vertexStride);
+		}
+
+		_vertices = buffer;
+		_vertexCapacity = capacity;
+		changed = true;
+	}
+
+	if (indices > _indexCapacity || _indices == nullptr) {
+		uint32_t capacity = glm::max(_indexCapacity, 1u);
+		while (capacity < indices) {
+			capacity *= 2;
+		}
+
+		IndexBuffer::Sptr buffer = IndexBuffer::Create(BufferUsage::StaticDraw);
+		buffer->SetDebugName("Geometry Pool Indices");
+		buffer->LoadData(nullptr, sizeof(uint32_t), capacity, IndexType::UInt);
+		if (_indices != nullptr && _indexCount > 0) {
+			glCopyNamedBufferSubData(_indices->GetHandle(), buffer->GetHandle(), 0, 0, (GLsizeiptr)_indexCount * sizeof(uint32_t));
+		}
+
+		_indices = buffer;
+		_indexCapacity = capacity;
+		changed = true;
+	}
+
+	if (changed) {
+		_RebuildVao();
+	}
+}
+
+void GeometryPool::_RebuildVao() {
+	_vao = VertexArrayObject::Create();
+	_vao->SetDebugName("Geometry Pool");
+	_vao->SetIndexBuffer(_indices);
+	_vao->AddVertexBuffer(_vertices, _vDecl);
+	_vao->SetVDecl(_vDecl);
+}
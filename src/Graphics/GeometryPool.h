@@ -0,0 +1,100 @@
+#pragma once
+#include <unordered_map>
+
+#include "Graphics/VertexArrayObject.h"
+#include "Utils/Macros.h"
+
+/// <summary>
+/// Packs many meshes that share a vertex layout into one large vertex and index buffer, so
+/// that they can be drawn from a single VAO (ex: with glMultiDrawElementsIndirect)
+///
+/// Meshes are copied into the pool on the GPU the first time they are requested. Space is
+/// never reclaimed, so this is intended for static level geometry rather than meshes that
+/// are created and destroyed at runtime
+/// </summary>
+class GeometryPool final {
+public:
+	MAKE_PTRS(GeometryPool);
+	NO_COPY(GeometryPool);
+	NO_MOVE(GeometryPool);
+
+	/// <summary>
+	/// The location of a mesh within the pool's buffers, matches the parameters
+	/// for glDrawElementsBaseVertex
+	/// </summary>
+	struct Allocation {
+		uint32_t FirstIndex;
+		uint32_t IndexCount;
+		int32_t  BaseVertex;
+	};
+
+	/// <summary>
+	/// Creates a new geometry pool for meshes with the given vertex layout
+	/// </summary>
+	/// <param name="vDecl">The vertex declaration that meshes must match to be added to the pool</param>
+	/// <param name="vertexStride">The size of a single vertex, in bytes</param>
+	/// <param name="initialVertices">The number of vertices to reserve space for, will grow as needed</param>
+	/// <param name="initialIndices">The number of indices to reserve space for, will grow as needed</param>
+	GeometryPool(const VertexArrayObject::VertexDeclaration& vDecl, uint32_t vertexStride, uint32_t initialVertices = 1 << 16, uint32_t initialIndices = 1 << 18);
+	~GeometryPool() = default;
+
+	/// <summary>
+	/// Gets where a mesh lives in the pool, adding it if it has not been seen before
+	/// </summary>
+	/// <param name="mesh">The mesh to look up</param>
+	/// <returns>The mesh's allocation, or nullptr if the mesh is not compatible with the pool (different layout, non-indexed, or non 32 bit indices)</returns>
+	const Allocation* GetAllocation(const VertexArrayObject::Sptr& mesh);
+
+	/// <summary>
+	/// Gets the VAO that draws from the pool's buffers. Note that this may be replaced
+	/// when the pool grows, so it should not be held on to between frames
+	/// </summary>
+	const VertexArrayObject::Sptr& GetVao() const { return _vao; }
+
+	uint32_t GetVertexCount() const { return _vertexCount; }
+	uint32_t GetIndexCount() const { return _indexCount; }
+
+protected:
+	struct Entry {
+		VertexArrayObject::Wptr Source;
+		Allocation              Alloc;
+		// False if the mesh could not be added to the pool, so we don't re-check it every frame
+		bool                    Valid;
+	};
+
+	// Where a source vertex buffer was copied into the pool, so meshes sharing it can share the copy
+	struct VertexRange {
+		std::weak_ptr<VertexBuffer> Source;
+		int32_t                     BaseVertex;
+	};
+
+	VertexArrayObject::VertexDeclaration _vDecl;
+	uint32_t _vertexStride;
+
+	VertexBuffer::Sptr      _vertices;
+	IndexBuffer::Sptr       _indices;
+	VertexArrayObject::Sptr _vao;
+
+	// The number of vertices and indices that are in use
+	uint32_t _vertexCount;
+	uint32_t _indexCount;
+	// The number of vertices and indices that the buffers can hold
+	uint32_t _vertexCapacity;
+	uint32_t _indexCapacity;
+
+	std::unordered_map<VertexArrayObject*, Entry> _entries;
+	std::unordered_map<VertexBuffer*, VertexRange> _vertexRanges;
+
+	/// <summary>
+	/// Returns true if the mesh has a single interleaved vertex buffer matching our layout, and 32 bit indices
+	/// </summary>
+	bool _IsCompatible(const VertexArrayObject::Sptr& mesh) const;
+	/// <summary>
+	/// Grows the buffers so they can hold at least the given number of vertices and indices, preserving their contents
+	/// </summary>
+	void _Reserve(uint32_t vertices, uint32_t indices);
+	/// <summary>
+	/// Re-creates the VAO to point at the current buffers
+	/// </summary>
+	void _RebuildVao();
+};
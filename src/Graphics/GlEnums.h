@@ -17,6 +17,7 @@ ENUM(ShaderPartType, GLint,
 	 TessControl  = GL_TESS_CONTROL_SHADER,
 	 TessEval     = GL_TESS_EVALUATION_SHADER,
 	 Geometry     = GL_GEOMETRY_SHADER,
+	 Compute      = GL_COMPUTE_SHADER,
 	 Unknown      = GL_NONE // Usually good practice to have an "unknown" or "none" state for enums
 )
 
@@ -29,7 +30,8 @@ ENUM(TextureType, GLenum,
 	_2D            = GL_TEXTURE_2D,
 	_3D            = GL_TEXTURE_3D,
 	Cubemap        = GL_TEXTURE_CUBE_MAP,
-	_2DMultisample = GL_TEXTURE_2D_MULTISAMPLE
+	_2DMultisample = GL_TEXTURE_2D_MULTISAMPLE,
+	_2DArray       = GL_TEXTURE_2D_ARRAY
 )
 
 // https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glTexImage2D.xhtml
@@ -745,9 +747,11 @@ ENUM(BlendEquation, uint32_t,
 /// </summary>
 /// <see>https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glBufferData.xhtml</see>
 ENUM(BufferType, GLenum,
-	Vertex  = GL_ARRAY_BUFFER,
-	Index   = GL_ELEMENT_ARRAY_BUFFER,
-	Uniform = GL_UNIFORM_BUFFER
+	Vertex        = GL_ARRAY_BUFFER,
+	Index         = GL_ELEMENT_ARRAY_BUFFER,
+	Uniform       = GL_UNIFORM_BUFFER,
+	Indirect      = GL_DRAW_INDIRECT_BUFFER,
+	ShaderStorage = GL_SHADER_STORAGE_BUFFER
 )
 
 /// <summary>
@@ -0,0 +1,147 @@
+#include "GpuCuller.h"
+#include "Logging.h"
+
+GpuCuller::GpuCuller() :
+	_cullShader(nullptr),
+	_instances(nullptr),
+	_bounds(nullptr),
+	_instancesTested(0)
+{
+	const char* cs_source = R"LIT(#version 450
+			layout (local_size_x = 64) in;
+
+			// Matches GpuCuller::InstanceBounds
+			struct Bounds {
+				vec3  Center;
+				uint  Command;
+				vec3  Extents;
+				float Padding;
+			};
+
+			// Matches DrawElementsIndirectCommand
+			struct DrawCommand {
+				uint Count;
+				uint InstanceCount;
+				uint FirstIndex;
+				int  BaseVertex;
+				uint BaseInstance;
+			};
+
+			// The instances are copied as a block of vec4s, so we don't need to know their layout
+			// beyond the model matrix at the start of each one
+			layout (std430, binding = 4) readonly buffer b_Instances {
+				vec4 Instances[];
+			};
+			layout (std430, binding = 5) readonly buffer b_Bounds {
+				Bounds InstanceBounds[];
+			};
+			layout (std430, binding = 6) buffer b_Commands {
+				DrawCommand Commands[];
+			};
+			layout (std430, binding = 7) writeonly buffer b_Output {
+				vec4 Output[];
+			};
+
+			layout (location = 0) uniform vec4 u_FrustumPlanes[6];
+			layout (location = 6) uniform int  u_InstanceCount;
+			// The size of each instance in vec4s
+			layout (location = 7) uniform int  u_InstanceStride;
+
+			void main() {
+				uint ix = gl_GlobalInvocationID.x;
+				if (ix >= uint(u_InstanceCount)) {
+					return;
+				}
+
+				Bounds bounds = InstanceBounds[ix];
+				uint stride = uint(u_InstanceStride);
+				uint source = ix * stride;
+
+				// Meshes without bounds are always drawn
+				if (bounds.Extents.x >= 0.0) {
+					// Get the world space box that contains the transformed local box, same as AABB::Transform
+					mat4 model = mat4(Instances[source], Instances[source + 1], Instances[source + 2], Instances[source + 3]);
+					vec3 center = (model * vec4(bounds.Center, 1.0)).xyz;
+					vec3 extents = abs(model[0].xyz) * bounds.Extents.x + abs(model[1].xyz) * bounds.Extents.y + abs(model[2].xyz) * bounds.Extents.z;
+
+					// Same as Frustum::Intersects, if the corner furthest along a plane's normal is behind it, the box is outside
+					for (int plane = 0; plane < 6; plane++) {
+						vec4 p = u_FrustumPlanes[plane];
+						if (dot(p.xyz, center) + p.w < -dot(abs(p.xyz), extents)) {
+							return;
+						}
+					}
+				}
+
+				// Claim the next slot in our command's range of the output
+				uint slot = atomicAdd(Commands[bounds.Command].InstanceCount, 1u);
+				uint dest = (Commands[bounds.Command].BaseInstance + slot) * stride;
+				for (uint v = 0; v < stride; v++) {
+					Output[dest + v] = Instances[source + v];
+				}
+			}
+		)LIT";
+
+	_cullShader = ShaderProgram::Create();
+	_cullShader->LoadShaderPart(cs_source, ShaderPartType::Compute);
+	_cullShader->Link();
+	_cullShader->SetDebugName("GPU Frustum Culling");
+
+	_instances = ShaderStorageBuffer::Create(BufferUsage::StreamDraw);
+	_instances->SetDebugName("GPU Cull Instances");
+	_bounds = ShaderStorageBuffer::Create(BufferUsage::StreamDraw);
+	_bounds->SetDebugName("GPU Cull Bounds");
+}
+
+void GpuCuller::Cull(const Frustum& frustum, const void* instances, uint32_t instanceSize, const std::vector<InstanceBounds>& bounds,
+					 const IndirectBuffer::Sptr& commands, const VertexBuffer::Sptr& output)
+{
+	LOG_ASSERT(instanceSize % sizeof(glm::vec4) == 0, "Instances must be made up of whole vec4s");
+
+	_instancesTested = static_cast<uint32_t>(bounds.size());
+	if (bounds.empty()) {
+		return;
+	}
+
+	// Re-specifying the buffers every frame lets the driver hand us fresh memory instead of waiting on last frame's cull
+	_instances->LoadData(instances, instanceSize, _instancesTested);
+	_bounds->LoadData(bounds.data(), _instancesTested);
+	output->LoadData(nullptr, instanceSize, _instancesTested);
+
+	// The command and output buffers are bound as storage buffers for the dispatch, even though they get drawn from as
+	// indirect and vertex buffers afterwards
+	_instances->Bind(INSTANCE_SSBO_BINDING);
+	_bounds->Bind(BOUNDS_SSBO_BINDING);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMAND_SSBO_BINDING, commands->GetHandle());
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, OUTPUT_SSBO_BINDING, output->GetHandle());
+
+	int count = static_cast<int>(_instancesTested);
+	int stride = static_cast<int>(instanceSize / sizeof(glm::vec4));
+	_cullShader->Bind();
+	_cullShader->SetUniform(0, frustum.Planes, Frustum::Count);
+	_cullShader->SetUniform(6, &count);
+	_cullShader->SetUniform(7, &stride);
+	glDispatchCompute((_instancesTested + GROUP_SIZE - 1) / GROUP_SIZE, 1, 1);
+
+	// The draws read the counts as indirect commands and the instances as vertex attributes, so those
+	// reads need to see the compute shader's writes
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+
+	ShaderStorageBuffer::UnBind(COMMAND_SSBO_BINDING);
+	ShaderStorageBuffer::UnBind(OUTPUT_SSBO_BINDING);
+}
+
+GpuCuller::InstanceBounds GpuCuller::MakeBounds(const AABB& localBox, uint32_t command)
+{
+	InstanceBounds result;
+	result.Command = command;
+	result._padding = 0.0f;
+	if (localBox.IsValid()) {
+		result.Center = localBox.GetCenter();
+		result.Extents = localBox.GetExtents();
+	} else {
+		result.Center = glm::vec3(0.0f);
+		result.Extents = glm::vec3(-1.0f);
+	}
+	return result;
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <vector>
+#include <GLM/glm.hpp>
+
+#include "Graphics/BoundingVolume.h"
+#include "Graphics/ShaderProgram.h"
+#include "Graphics/Buffers/IndirectBuffer.h"
+#include "Graphics/Buffers/ShaderStorageBuffer.h"
+#include "Graphics/Buffers/VertexBuffer.h"
+#include "Utils/Macros.h"
+
+/// <summary>
+/// Frustum culling for instanced indirect draws, done in a compute shader so the CPU never has
+/// to look at individual objects
+///
+/// Every instance comes with the index of the indirect command that draws it and it's mesh's
+/// local bounding box. The compute shader transforms each box by the instance's model matrix and
+/// tests it against the frustum. Instances that pass bump their command's InstanceCount with an
+/// atomic add, and are copied into the output instance buffer starting at the command's
+/// BaseInstance. The commands can then be drawn with glMultiDrawElementsIndirect as normal, commands
+/// with nothing visible simply draw zero instances
+///
+/// Results never come back to the CPU, so the number of visible instances is not known
+/// </summary>
+class GpuCuller final {
+public:
+	MAKE_PTRS(GpuCuller);
+	NO_COPY(GpuCuller);
+	NO_MOVE(GpuCuller);
+
+	/// <summary>
+	/// The bounds of a single instance, matches the Bounds struct in the compute shader
+	/// </summary>
+	struct InstanceBounds {
+		// Center of the mesh's bounding box, in the mesh's local space
+		glm::vec3 Center;
+		// Index of the indirect command that draws this instance
+		uint32_t  Command;
+		// Half the size of the mesh's bounding box, negative if the mesh has no bounds and should always be drawn
+		glm::vec3 Extents;
+		float     _padding;
+	};
+
+	// The storage buffer bindings used while culling, these start after ClusteredLighting's so that
+	// the light buffers don't need to be re-bound afterwards
+	static const int INSTANCE_SSBO_BINDING = 4;
+	static const int BOUNDS_SSBO_BINDING = 5;
+	static const int COMMAND_SSBO_BINDING = 6;
+	static const int OUTPUT_SSBO_BINDING = 7;
+
+	GpuCuller();
+	~GpuCuller() = default;
+
+	/// <summary>
+	/// Culls a set of instances against the frustum, writing the visible ones out for indirect drawing.
+	/// The commands should already be uploaded with InstanceCount set to 0, and with room for all of their
+	/// instances after each BaseInstance
+	/// </summary>
+	/// <param name="frustum">The frustum to cull against</param>
+	/// <param name="instances">The per-instance data, the first 64 bytes of each instance must be it's model matrix</param>
+	/// <param name="instanceSize">The size of a single instance in bytes, must be a multiple of 16</param>
+	/// <param name="bounds">The bounds of each instance, in the same order as the instance data</param>
+	/// <param name="commands">The indirect commands to add the visible instances to</param>
+	/// <param name="output">The buffer to copy the visible instances into, will be re-allocated to fit all of the instances</param>
+	void Cull(const Frustum& frustum, const void* instances, uint32_t instanceSize, const std::vector<InstanceBounds>& bounds,
+			  const IndirectBuffer::Sptr& commands, const VertexBuffer::Sptr& output);
+
+	/// <summary>
+	/// Gets the number of instances that were tested in the last call to Cull
+	/// </summary>
+	uint32_t GetInstancesTested() const { return _instancesTested; }
+
+	/// <summary>
+	/// Gets the bounds to cull a mesh with, from it's local space bounding box
+	/// </summary>
+	/// <param name="localBox">The mesh's bounding box, or an invalid box if the mesh has none</param>
+	/// <param name="command">The index of the command that draws the instance</param>
+	static InstanceBounds MakeBounds(const AABB& localBox, uint32_t command);
+
+protected:
+	// Must match local_size_x in the compute shader
+	static const uint32_t GROUP_SIZE = 64;
+
+	ShaderProgram::Sptr       _cullShader;
+	ShaderStorageBuffer::Sptr _instances;
+	ShaderStorageBuffer::Sptr _bounds;
+	uint32_t                  _instancesTested;
+};
@@ -0,0 +1,181 @@
+#include "Graphics/GpuProfiler.h"
+#include <Logging.h>
+#include <algorithm>
+#include <GLM/glm.hpp>
+
+GpuProfiler::GpuProfiler() :
+	_frameIndex(0),
+	_openScopes(std::vector<size_t>()),
+	_scopeIds(std::unordered_map<std::string, uint32_t>()),
+	_stats(std::vector<ScopeStats>()),
+	_history(std::vector<History>()),
+	_frameTotals(std::vector<float>()),
+	_droppedFrames(0)
+{ }
+
+GpuProfiler::~GpuProfiler() {
+	for (Frame& frame : _frames) {
+		if (!frame.Queries.empty()) {
+			glDeleteQueries(static_cast<GLsizei>(frame.Queries.size()), frame.Queries.data());
+		}
+	}
+}
+
+GpuProfiler& GpuProfiler::Get() {
+	if (__Instance == nullptr) {
+		__Instance = new GpuProfiler();
+	}
+	return *__Instance;
+}
+
+void GpuProfiler::Uninitialize() {
+	if (__Instance != nullptr) {
+		delete __Instance;
+		__Instance = nullptr;
+	}
+}
+
+void GpuProfiler::BeginFrame() {
+	// This slot was last used FRAME_LATENCY frames ago, so its results have most likely come in
+	Frame& frame = _frames[_frameIndex];
+	_ReadFrame(frame);
+	frame.QueriesUsed = 0;
+	frame.Records.clear();
+	_openScopes.clear();
+}
+
+void GpuProfiler::EndFrame() {
+	if (!_openScopes.empty()) {
+		LOG_WARN("{} GPU profiler scope(s) were not closed this frame", _openScopes.size());
+		while (!_openScopes.empty()) {
+			EndScope();
+		}
+	}
+	_frameIndex = (_frameIndex + 1) % FRAME_LATENCY;
+}
+
+void GpuProfiler::BeginScope(const std::string& name) {
+	Frame& frame = _frames[_frameIndex];
+
+	// Nested scopes are named after their parents, so the same sub pass in different layers stays separate
+	std::string fullName = _openScopes.empty() ? name : _stats[frame.Records[_openScopes.back()].ScopeId].Name + "/" + name;
+
+	auto it = _scopeIds.find(fullName);
+	if (it == _scopeIds.end()) {
+		it = _scopeIds.emplace(fullName, static_cast<uint32_t>(_stats.size())).first;
+		ScopeStats& stats = _stats.emplace_back();
+		stats.Name = fullName;
+		_history.emplace_back();
+		_frameTotals.push_back(0.0f);
+	}
+
+	Record& record = frame.Records.emplace_back();
+	record.ScopeId = it->second;
+	record.Start = _NextQuery(frame);
+	record.End = 0;
+	glQueryCounter(record.Start, GL_TIMESTAMP);
+
+	_openScopes.push_back(frame.Records.size() - 1);
+}
+
+void GpuProfiler::EndScope() {
+	if (_openScopes.empty()) {
+		LOG_WARN("GPU profiler scope ended without being started");
+		return;
+	}
+
+	Frame& frame = _frames[_frameIndex];
+	GLuint query = _NextQuery(frame);
+	glQueryCounter(query, GL_TIMESTAMP);
+	frame.Records[_openScopes.back()].End = query;
+	_openScopes.pop_back();
+}
+
+const GpuProfiler::ScopeStats* GpuProfiler::GetScope(const std::string& name) const {
+	auto it = _scopeIds.find(name);
+	return it != _scopeIds.end() ? &_stats[it->second] : nullptr;
+}
+
+void GpuProfiler::ResetStats() {
+	for (size_t ix = 0; ix < _stats.size(); ix++) {
+		_stats[ix].Last = 0.0f;
+		_stats[ix].Average = 0.0f;
+		_stats[ix].Max = 0.0f;
+		_stats[ix].Samples = 0;
+		_history[ix] = History();
+	}
+	_droppedFrames = 0;
+}
+
+nlohmann::json GpuProfiler::ToJson() const {
+	nlohmann::json result = nlohmann::json::object();
+	for (const ScopeStats& stats : _stats) {
+		result[stats.Name] ={
+			{ "last_ms", stats.Last },
+			{ "average_ms", stats.Average },
+			{ "max_ms", stats.Max },
+			{ "samples", stats.Samples }
+		};
+	}
+	return result;
+}
+
+GLuint GpuProfiler::_NextQuery(Frame& frame) {
+	if (frame.QueriesUsed == frame.Queries.size()) {
+		GLuint query = 0;
+		glCreateQueries(GL_TIMESTAMP, 1, &query);
+		frame.Queries.push_back(query);
+	}
+	return frame.Queries[frame.QueriesUsed++];
+}
+
+void GpuProfiler::_ReadFrame(Frame& frame) {
+	if (frame.Records.empty()) {
+		return;
+	}
+
+	// Timestamps are written in order, so once the last query is done the rest are as well
+	GLint available = 0;
+	glGetQueryObjectiv(frame.Queries[frame.QueriesUsed - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available) {
+		_droppedFrames++;
+		return;
+	}
+
+	std::fill(_frameTotals.begin(), _frameTotals.end(), -1.0f);
+	for (const Record& record : frame.Records) {
+		if (record.End == 0) {
+			continue;
+		}
+		GLuint64 start = 0, end = 0;
+		glGetQueryObjectui64v(record.Start, GL_QUERY_RESULT, &start);
+		glGetQueryObjectui64v(record.End, GL_QUERY_RESULT, &end);
+		float& total = _frameTotals[record.ScopeId];
+		total = glm::max(total, 0.0f) + static_cast<float>(end - start) / 1000000.0f;
+	}
+
+	// Push a sample for every scope that showed up in the frame, and update its stats
+	for (size_t ix = 0; ix < _stats.size(); ix++) {
+		if (_frameTotals[ix] < 0.0f) {
+			continue;
+		}
+
+		History& history = _history[ix];
+		history.Samples[history.Next] = _frameTotals[ix];
+		history.Next = (history.Next + 1) % ROLLING_WINDOW;
+
+		ScopeStats& stats = _stats[ix];
+		stats.Last = _frameTotals[ix];
+		stats.Version++;
+		stats.Samples = glm::min(stats.Samples + 1, ROLLING_WINDOW);
+		float sum = 0.0f;
+		stats.Max = 0.0f;
+		for (uint32_t sample = 0; sample < stats.Samples; sample++) {
+			// The most recent samples are just behind the write position
+			float value = history.Samples[(history.Next + ROLLING_WINDOW - 1 - sample) % ROLLING_WINDOW];
+			sum += value;
+			stats.Max = glm::max(stats.Max, value);
+		}
+		stats.Average = sum / stats.Samples;
+	}
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <glad/glad.h>
+#include <json.hpp>
+
+#include "Utils/Macros.h"
+
+/// <summary>
+/// Measures how much GPU time named sections of a frame take, using GL_TIMESTAMP queries
+///
+/// Sections are marked with BeginScope / EndScope (or a GpuProfiler::Scope on the stack), and may
+/// be nested, in which case the inner scope is named "Outer/Inner". Queries are kept in a ring that
+/// is FRAME_LATENCY frames deep, and a frame's results are only read back when its slot comes
+/// around again and the GPU says they are available, so the profiler never stalls the pipeline.
+/// If the results still aren't ready, that frame is dropped
+///
+/// Each scope keeps the average and max of its time over the last ROLLING_WINDOW frames it was seen in
+/// </summary>
+class GpuProfiler final {
+public:
+	NO_COPY(GpuProfiler);
+	NO_MOVE(GpuProfiler);
+
+	~GpuProfiler();
+
+	// The number of frames between issuing a frame's queries and reading them back
+	inline static const uint32_t FRAME_LATENCY = 4;
+	// The number of frames that averages and maxes are taken over
+	inline static const uint32_t ROLLING_WINDOW = 60;
+
+	/// <summary>
+	/// The timings for one scope, all times are in milliseconds
+	/// </summary>
+	struct ScopeStats {
+		std::string Name;
+		// The time from the most recent frame we have results for
+		float       Last = 0.0f;
+		float       Average = 0.0f;
+		float       Max = 0.0f;
+		// The number of frames the average and max are taken over, up to ROLLING_WINDOW
+		uint32_t    Samples = 0;
+		// Goes up by one every time a new result comes in, so callers can tell when Last has changed
+		uint64_t    Version = 0;
+	};
+
+	/// <summary>
+	/// Marks a scope for as long as it's alive, ex:
+	///		{
+	///			GpuProfiler::Scope scope("Skybox");
+	///			DrawSkybox();
+	///		}
+	/// </summary>
+	struct Scope {
+		NO_COPY(Scope);
+		NO_MOVE(Scope);
+		Scope(const std::string& name) { GpuProfiler::Get().BeginScope(name); }
+		~Scope() { GpuProfiler::Get().EndScope(); }
+	};
+
+	/// <summary>
+	/// Gets the singleton instance of the profiler
+	/// </summary>
+	static GpuProfiler& Get();
+	/// <summary>
+	/// Deletes all of the profiler's queries, must be called while the GL context is still alive
+	/// </summary>
+	static void Uninitialize();
+
+	/// <summary>
+	/// Starts a new frame, reading back the results from FRAME_LATENCY frames ago if they're ready
+	/// </summary>
+	void BeginFrame();
+	/// <summary>
+	/// Ends the current frame, any scopes that are still open are closed
+	/// </summary>
+	void EndFrame();
+
+	/// <summary>
+	/// Starts timing a section of the frame, must be matched with a call to EndScope
+	/// </summary>
+	/// <param name="name">The name of the section, prefixed with the names of any scopes it is nested in</param>
+	void BeginScope(const std::string& name);
+	/// <summary>
+	/// Stops timing the most recently started scope
+	/// </summary>
+	void EndScope();
+
+	/// <summary>
+	/// Gets the timings for every scope we have seen, in the order they were first seen
+	/// </summary>
+	const std::vector<ScopeStats>& GetScopes() const { return _stats; }
+	/// <summary>
+	/// Gets the timings for a single scope
+	/// </summary>
+	/// <param name="name">The full name of the scope, including the names of the scopes it is nested in</param>
+	/// <returns>The scope's timings, or nullptr if the scope has never been seen</returns>
+	const ScopeStats* GetScope(const std::string& name) const;
+	/// <summary>
+	/// Gets the number of frames whose results were dropped because the GPU hadn't finished them in time
+	/// </summary>
+	uint32_t GetDroppedFrames() const { return _droppedFrames; }
+	/// <summary>
+	/// Clears the timings for all scopes, ex: before starting a benchmark
+	/// </summary>
+	void ResetStats();
+
+	/// <summary>
+	/// Gets the timings for every scope as a JSON object keyed by scope name, for saving benchmark results
+	/// </summary>
+	nlohmann::json ToJson() const;
+
+protected:
+	GpuProfiler();
+
+	// A scope that was issued in a frame, waiting for its queries to be read back
+	struct Record {
+		uint32_t ScopeId;
+		GLuint   Start;
+		GLuint   End;
+	};
+
+	// The queries and scopes for one frame in the ring
+	struct Frame {
+		// Every query this frame has made, reused each time the frame comes around
+		std::vector<GLuint> Queries;
+		uint32_t            QueriesUsed = 0;
+		std::vector<Record> Records;
+	};
+
+	// The samples for a scope, ROLLING_WINDOW long
+	struct History {
+		float    Samples[ROLLING_WINDOW] ={ 0.0f };
+		uint32_t Next = 0;
+	};
+
+	Frame    _frames[FRAME_LATENCY];
+	uint32_t _frameIndex;
+	// Indices into the current frame's records for the scopes that are open
+	std::vector<size_t> _openScopes;
+
+	std::unordered_map<std::string, uint32_t> _scopeIds;
+	std::vector<ScopeStats> _stats;
+	std::vector<History>    _history;
+	// Scratch space for adding up each scope's time in a frame, since a scope may be entered more than once
+	std::vector<float>      _frameTotals;
+	uint32_t                _droppedFrames;
+
+	inline static GpuProfiler* __Instance = nullptr;
+
+	GLuint _NextQuery(Frame& frame);
+	void _ReadFrame(Frame& frame);
+};
@@ -0,0 +1,162 @@
+#include "OcclusionCuller.h"
+#include "Logging.h"
+
+#include <GLM/gtc/matrix_transform.hpp>
+
+OcclusionCuller::OcclusionCuller() :
+	_entries(std::unordered_map<const void*, Entry>()),
+	_candidates(std::vector<Candidate>()),
+	_frame(0),
+	_queriesIssued(0),
+	_boxMesh(nullptr),
+	_boxShader(nullptr)
+{
+	// Unit cube, we only need positions since nothing gets written to the color buffer
+	static const glm::vec3 positions[8] ={
+		{ 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f },
+		{ 0.0f, 0.0f, 1.0f }, { 1.0f, 0.0f, 1.0f }, { 1.0f, 1.0f, 1.0f }, { 0.0f, 1.0f, 1.0f }
+	};
+	static const uint16_t indices[36] ={
+		0, 2, 1,  0, 3, 2, // -Z
+		4, 5, 6,  4, 6, 7, // +Z
+		0, 1, 5,  0, 5, 4, // -Y
+		3, 6, 2,  3, 7, 6, // +Y
+		0, 4, 7,  0, 7, 3, // -X
+		1, 2, 6,  1, 6, 5  // +X
+	};
+
+	VertexBuffer::Sptr vbo = VertexBuffer::Create();
+	vbo->LoadData(positions, 8);
+	IndexBuffer::Sptr ibo = IndexBuffer::Create();
+	ibo->LoadData(indices, 36);
+
+	_boxMesh = VertexArrayObject::Create();
+	_boxMesh->SetDebugName("Occlusion Box");
+	_boxMesh->SetIndexBuffer(ibo);
+	_boxMesh->AddVertexBuffer(vbo, {
+		BufferAttribute(0, 3, AttributeType::Float, sizeof(glm::vec3), 0, AttribUsage::Position)
+	});
+
+	const char* vs_source = R"LIT(#version 450
+			layout (location = 0) in vec3 inPosition;
+
+			layout (location = 0) uniform mat4 u_MVP;
+
+			void main() {
+				gl_Position = u_MVP * vec4(inPosition, 1.0);
+			}
+		)LIT";
+	const char* fs_source = R"LIT(#version 450
+			void main() { }
+		)LIT";
+
+	_boxShader = ShaderProgram::Create();
+	_boxShader->LoadShaderPart(vs_source, ShaderPartType::Vertex);
+	_boxShader->LoadShaderPart(fs_source, ShaderPartType::Fragment);
+	_boxShader->Link();
+	_boxShader->SetDebugName("Occlusion Box");
+}
+
+OcclusionCuller::~OcclusionCuller() {
+	for (auto& [key, entry] : _entries) {
+		glDeleteQueries(1, &entry.Query);
+	}
+	_entries.clear();
+}
+
+void OcclusionCuller::BeginFrame() {
+	_frame++;
+	_candidates.clear();
+
+	// Objects that have been deleted or have stopped being tested will eventually get cleaned up here
+	for (auto it = _entries.begin(); it != _entries.end(); ) {
+		if (_frame - it->second.LastFrame > MAX_IDLE_FRAMES) {
+			glDeleteQueries(1, &it->second.Query);
+			it = _entries.erase(it);
+		} else {
+			it++;
+		}
+	}
+}
+
+bool OcclusionCuller::Test(const void* key, const AABB& worldBox, GLuint& condition) {
+	condition = 0;
+
+	auto it = _entries.find(key);
+	if (it == _entries.end()) {
+		Entry entry;
+		glCreateQueries(GL_ANY_SAMPLES_PASSED_CONSERVATIVE, 1, &entry.Query);
+		entry.Pending = false;
+		entry.Visible = true;
+		it = _entries.emplace(key, entry).first;
+	}
+
+	Entry& entry = it->second;
+	entry.LastFrame = _frame;
+
+	// Only read the result if it's already there, asking for it otherwise would stall until the GPU catches up
+	if (entry.Pending) {
+		GLuint available = GL_FALSE;
+		glGetQueryObjectuiv(entry.Query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available) {
+			GLuint result = GL_TRUE;
+			glGetQueryObjectuiv(entry.Query, GL_QUERY_RESULT, &result);
+			entry.Visible = result != GL_FALSE;
+			entry.Pending = false;
+		}
+	}
+
+	// Still waiting, let the GPU decide with the old query and don't issue a new one
+	if (entry.Pending) {
+		condition = entry.Query;
+		return true;
+	}
+
+	// Occluded objects still get re-tested every frame so they show up again once they're uncovered
+	_candidates.push_back({ &entry, worldBox });
+	return entry.Visible;
+}
+
+void OcclusionCuller::IssueQueries(const glm::mat4& viewProjection, const glm::vec3& cameraPos) {
+	_queriesIssued = 0;
+	if (_candidates.empty()) {
+		return;
+	}
+
+	// We only want the depth test, and back faces need to count in case the near plane clips the front ones
+	// Culling is put back the way we found it, since not every pass draws with it enabled
+	GLboolean cullFace = glIsEnabled(GL_CULL_FACE);
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glDepthMask(GL_FALSE);
+	glDisable(GL_CULL_FACE);
+
+	_boxShader->Bind();
+	_boxMesh->Bind();
+	for (const Candidate& candidate : _candidates) {
+		// If the camera is inside the box, it's faces may be entirely clipped away, so just assume it's visible
+		glm::vec3 padding = glm::vec3(0.1f);
+		if (AABB(candidate.Box.Min - padding, candidate.Box.Max + padding).Contains(cameraPos)) {
+			candidate.Target->Visible = true;
+			continue;
+		}
+
+		glm::mat4 mvp = viewProjection;
+		mvp = glm::translate(mvp, candidate.Box.Min);
+		mvp = glm::scale(mvp, candidate.Box.Max - candidate.Box.Min);
+		_boxShader->SetUniformMatrix(0, &mvp);
+
+		glBeginQuery(GL_ANY_SAMPLES_PASSED_CONSERVATIVE, candidate.Target->Query);
+		glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_SHORT, nullptr);
+		glEndQuery(GL_ANY_SAMPLES_PASSED_CONSERVATIVE);
+
+		candidate.Target->Pending = true;
+		_queriesIssued++;
+	}
+	VertexArrayObject::Unbind();
+
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glDepthMask(GL_TRUE);
+	if (cullFace) {
+		glEnable(GL_CULL_FACE);
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+#include <GLM/glm.hpp>
+
+#include "Graphics/BoundingVolume.h"
+#include "Graphics/ShaderProgram.h"
+#include "Graphics/VertexArrayObject.h"
+#include "Utils/Macros.h"
+
+/// <summary>
+/// Hardware occlusion culling using GL_ANY_SAMPLES_PASSED_CONSERVATIVE queries
+///
+/// After the scene has been drawn, the bounding box of each tested object is drawn against the
+/// depth buffer inside of a query. The next frame, objects whose query has come back with
+/// no samples are skipped on the CPU. If a query has not come back yet we never wait on it,
+/// instead the object is drawn with conditional rendering so the GPU can make the call
+///
+/// Since results lag by a frame, objects that come out from behind an occluder may pop in one
+/// frame late. This works best for large objects that hide a lot of the scene (ex: level chunks)
+/// </summary>
+class OcclusionCuller final {
+public:
+	MAKE_PTRS(OcclusionCuller);
+	NO_COPY(OcclusionCuller);
+	NO_MOVE(OcclusionCuller);
+
+	OcclusionCuller();
+	~OcclusionCuller();
+
+	/// <summary>
+	/// Starts a new frame, releasing queries for objects that have not been tested in a while
+	/// </summary>
+	void BeginFrame();
+
+	/// <summary>
+	/// Checks whether an object was visible according to the most recent query result, and
+	/// schedules a new query for it if the last one has finished
+	/// </summary>
+	/// <param name="key">A unique key for the object, usually a pointer to the object or component</param>
+	/// <param name="worldBox">The object's bounding box in world space</param>
+	/// <param name="condition">Set to the query to use with glBeginConditionalRender if the result is not ready yet, otherwise 0</param>
+	/// <returns>False if the object is known to be occluded and can be skipped</returns>
+	bool Test(const void* key, const AABB& worldBox, GLuint& condition);
+
+	/// <summary>
+	/// Draws the bounding boxes for all objects scheduled in Test against the current depth buffer.
+	/// Color and depth writes are disabled while the boxes are drawn
+	/// </summary>
+	/// <param name="viewProjection">The camera's view projection matrix</param>
+	/// <param name="cameraPos">The camera's position in world space, objects containing the camera are always visible</param>
+	void IssueQueries(const glm::mat4& viewProjection, const glm::vec3& cameraPos);
+
+	/// <summary>
+	/// Gets the number of queries that were issued in the last call to IssueQueries
+	/// </summary>
+	uint32_t GetQueriesIssued() const { return _queriesIssued; }
+
+protected:
+	struct Entry {
+		GLuint   Query;
+		// True if the query has been issued and we have not read the result yet
+		bool     Pending;
+		// The most recent result we've read
+		bool     Visible;
+		// The frame the entry was last tested, for cleaning up stale entries
+		uint64_t LastFrame;
+	};
+
+	struct Candidate {
+		Entry* Target;
+		AABB   Box;
+	};
+
+	std::unordered_map<const void*, Entry> _entries;
+	std::vector<Candidate> _candidates;
+	uint64_t _frame;
+	uint32_t _queriesIssued;
+
+	// A unit cube from (0,0,0) to (1,1,1), scaled to fit each box
+	VertexArrayObject::Sptr _boxMesh;
+	ShaderProgram::Sptr     _boxShader;
+
+	// Entries that haven't been tested for this many frames have their queries deleted
+	const uint64_t MAX_IDLE_FRAMES = 120;
+};
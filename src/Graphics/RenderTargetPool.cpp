@@ -0,0 +1,108 @@
+#include "Graphics/RenderTargetPool.h"
+#include <algorithm>
+#include <Logging.h>
+
+RenderTargetPool::RenderTargetPool() :
+	_entries(std::vector<Entry>()),
+	_frame(0),
+	_allocations(0),
+	_allocationsLastFrame(0)
+{ }
+
+void RenderTargetPool::BeginFrame() {
+	_frame++;
+	_allocationsLastFrame = _allocations;
+	_allocations = 0;
+
+	for (Entry& entry : _entries) {
+		if (entry.InUse) {
+			if (!entry.FrameLifetime) {
+				LOG_WARN("Render target {} was not released last frame, releasing", entry.Target->GetDebugName());
+			}
+			entry.InUse = false;
+			entry.FrameLifetime = false;
+		}
+	}
+
+	// Drop anything that nobody has asked for in a while
+	_entries.erase(std::remove_if(_entries.begin(), _entries.end(), [&](const Entry& entry) {
+		return _frame - entry.LastFrame > MAX_IDLE_FRAMES;
+	}), _entries.end());
+}
+
+Framebuffer::Sptr RenderTargetPool::Acquire(uint32_t width, uint32_t height, RenderTargetType format, uint8_t sampleCount) {
+	for (Entry& entry : _entries) {
+		if (!entry.InUse && entry.Width == width && entry.Height == height && entry.Format == format && entry.SampleCount == sampleCount) {
+			entry.InUse = true;
+			entry.FrameLifetime = false;
+			entry.LastFrame = _frame;
+			return entry.Target;
+		}
+	}
+
+	// Free targets of the same kind that haven't been touched this frame are almost always left over from
+	// before a resize, so get rid of them now rather than waiting for them to go idle
+	_entries.erase(std::remove_if(_entries.begin(), _entries.end(), [&](const Entry& entry) {
+		return !entry.InUse && entry.LastFrame != _frame && entry.Format == format && entry.SampleCount == sampleCount;
+	}), _entries.end());
+
+	FramebufferDescriptor descriptor;
+	descriptor.Width = width;
+	descriptor.Height = height;
+	descriptor.SampleCount = sampleCount;
+	descriptor.RenderTargets[_GetAttachment(format)] ={ true, format };
+
+	Entry& entry = _entries.emplace_back();
+	entry.Target        = std::make_shared<Framebuffer>(descriptor);
+	entry.Width         = width;
+	entry.Height        = height;
+	entry.Format        = format;
+	entry.SampleCount   = sampleCount;
+	entry.InUse         = true;
+	entry.FrameLifetime = false;
+	entry.LastFrame     = _frame;
+	entry.Target->SetDebugName("Transient " + ~format + " " + std::to_string(width) + "x" + std::to_string(height));
+	entry.Target->Validate();
+
+	_allocations++;
+	return entry.Target;
+}
+
+Framebuffer::Sptr RenderTargetPool::AcquireForFrame(uint32_t width, uint32_t height, RenderTargetType format, uint8_t sampleCount) {
+	Framebuffer::Sptr result = Acquire(width, height, format, sampleCount);
+	for (Entry& entry : _entries) {
+		if (entry.Target == result) {
+			entry.FrameLifetime = true;
+			break;
+		}
+	}
+	return result;
+}
+
+void RenderTargetPool::Release(const Framebuffer::Sptr& target) {
+	for (Entry& entry : _entries) {
+		if (entry.Target == target) {
+			entry.InUse = false;
+			entry.FrameLifetime = false;
+			return;
+		}
+	}
+	LOG_WARN("Attempted to release a render target that did not come from this pool");
+}
+
+RenderTargetAttachment RenderTargetPool::_GetAttachment(RenderTargetType format) {
+	switch (format) {
+		case RenderTargetType::DepthStencil:
+			return RenderTargetAttachment::DepthStencil;
+		case RenderTargetType::Depth16:
+		case RenderTargetType::Depth24:
+		case RenderTargetType::Depth32:
+			return RenderTargetAttachment::Depth;
+		case RenderTargetType::Stencil4:
+		case RenderTargetType::Stencil8:
+		case RenderTargetType::Stencil16:
+			return RenderTargetAttachment::Stencil;
+		default:
+			return RenderTargetAttachment::Color0;
+	}
+}
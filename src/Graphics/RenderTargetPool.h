@@ -0,0 +1,96 @@
+#pragma once
+#include <vector>
+
+#include "Graphics/Framebuffer.h"
+#include "Graphics/GlEnums.h"
+#include "Utils/Macros.h"
+
+/// <summary>
+/// Hands out short lived render targets for passes that only need them for part of a frame
+/// (ex: post processing)
+///
+/// Passes ask for a target by size, format and sample count, and give it back once nothing
+/// else in the frame needs to read it. Targets that have been given back can be handed to a
+/// later pass in the same frame, so passes whose lifetimes don't overlap share the same memory.
+/// Targets are kept between frames, and are only destroyed once they have gone unused for a few
+/// frames, or when a target with the same format has to be made at a new size (ex: the window was
+/// resized). This keeps the number of allocations flat no matter how many passes we add
+/// </summary>
+class RenderTargetPool final {
+public:
+	MAKE_PTRS(RenderTargetPool);
+	NO_COPY(RenderTargetPool);
+	NO_MOVE(RenderTargetPool);
+
+	RenderTargetPool();
+	~RenderTargetPool() = default;
+
+	/// <summary>
+	/// Starts a new frame, destroying targets that have not been used in a while. Targets from
+	/// AcquireForFrame are reclaimed here, any other targets that were not released during the
+	/// last frame are released with a warning
+	/// </summary>
+	void BeginFrame();
+
+	/// <summary>
+	/// Gets a framebuffer with a single attachment of the given format, reusing a free one if possible.
+	/// Color formats are attached to Color0, depth and stencil formats to their matching attachment
+	/// </summary>
+	/// <param name="width">The width of the target in pixels</param>
+	/// <param name="height">The height of the target in pixels</param>
+	/// <param name="format">The format of the target's attachment</param>
+	/// <param name="sampleCount">The number of samples per pixel, 1 for no multisampling</param>
+	/// <returns>A framebuffer that the caller may use until it is released</returns>
+	Framebuffer::Sptr Acquire(uint32_t width, uint32_t height, RenderTargetType format, uint8_t sampleCount = 1);
+	/// <summary>
+	/// Same as Acquire, but the target is held until the start of the next frame instead of being released
+	/// by the caller. Use this for targets that get handed to something outside of the render layers
+	/// (ex: a layer's output, which is presented after every layer has finished)
+	/// </summary>
+	/// <param name="width">The width of the target in pixels</param>
+	/// <param name="height">The height of the target in pixels</param>
+	/// <param name="format">The format of the target's attachment</param>
+	/// <param name="sampleCount">The number of samples per pixel, 1 for no multisampling</param>
+	/// <returns>A framebuffer that the caller may use until the end of the frame</returns>
+	Framebuffer::Sptr AcquireForFrame(uint32_t width, uint32_t height, RenderTargetType format, uint8_t sampleCount = 1);
+	/// <summary>
+	/// Returns a target to the pool, after which it may be given to another pass. The contents
+	/// of the target should not be used after it has been released
+	/// </summary>
+	/// <param name="target">The target to release, must have come from Acquire</param>
+	void Release(const Framebuffer::Sptr& target);
+
+	/// <summary>
+	/// Gets the number of targets currently owned by the pool, in use or not
+	/// </summary>
+	uint32_t GetTargetCount() const { return static_cast<uint32_t>(_entries.size()); }
+	/// <summary>
+	/// Gets the number of targets that had to be created during the last frame
+	/// </summary>
+	uint32_t GetAllocationsLastFrame() const { return _allocationsLastFrame; }
+
+protected:
+	struct Entry {
+		Framebuffer::Sptr Target;
+		uint32_t          Width;
+		uint32_t          Height;
+		RenderTargetType  Format;
+		uint8_t           SampleCount;
+		// True while a pass is holding on to the target
+		bool              InUse;
+		// True if the target came from AcquireForFrame, and will be reclaimed when the next frame starts
+		bool              FrameLifetime;
+		// The frame the target was last acquired, for cleaning up stale targets
+		uint64_t          LastFrame;
+	};
+
+	std::vector<Entry> _entries;
+	uint64_t _frame;
+	uint32_t _allocations;
+	uint32_t _allocationsLastFrame;
+
+	// Free targets that haven't been acquired for this many frames are destroyed
+	const uint64_t MAX_IDLE_FRAMES = 8;
+
+	static RenderTargetAttachment _GetAttachment(RenderTargetType format);
+};
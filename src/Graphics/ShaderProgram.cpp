@@ -3,6 +3,7 @@
 #include <fstream>
 #include <sstream>
 #include <filesystem>
+#include <algorithm>
 
 #include "Utils/FileHelpers.h"
 #include "Utils/JsonGlmHelpers.h"
@@ -156,6 +157,142 @@ bool ShaderProgram::Link() {
 	return status != GL_FALSE;
 }
 
+std::unordered_map<std::string, ShaderProgram::Wptr> ShaderProgram::__VariantCache;
+
+const ShaderProgram::Sptr& ShaderProgram::GetVariant(const std::vector<std::string>& defines) {
+	// Sort the defines so the same set always maps to the same entry, regardless of order
+	std::vector<std::string> sorted = defines;
+	std::sort(sorted.begin(), sorted.end());
+	std::string key;
+	for (const std::string& define : sorted) {
+		key += define + ";";
+	}
+
+	auto it = _variants.find(key);
+	if (it == _variants.end()) {
+		// Failed variants are cached as nullptr, so we only try to build them once
+		ShaderProgram::Sptr variant = _BuildVariant(sorted, false);
+		if (variant == nullptr) {
+			LOG_WARN("Failed to build variant of shader \"{}\" with defines [{}]", _debugName, key);
+		}
+		it = _variants.emplace(key, variant).first;
+	}
+	return it->second;
+}
+
+const ShaderProgram::Sptr& ShaderProgram::GetInstancedVariant() {
+	return GetVariant({ "INSTANCED" });
+}
+
+const ShaderProgram::Sptr& ShaderProgram::GetDepthOnlyVariant() {
+	if (_depthOnlyVariant == nullptr && !_depthOnlyVariantFailed) {
+		_depthOnlyVariant = _BuildVariant({ }, true);
+		if (_depthOnlyVariant == nullptr) {
+			LOG_TRACE("Shader \"{}\" has no depth only variant, it will be skipped in depth only passes", _debugName);
+			_depthOnlyVariantFailed = true;
+		}
+	}
+	return _depthOnlyVariant;
+}
+
+const ShaderProgram::Sptr& ShaderProgram::GetDeferredVariant() {
+	if (_deferredVariant == nullptr && !_deferredVariantFailed) {
+		auto fragment = _fileSourceMap.find(ShaderPartType::Fragment);
+		if (fragment != _fileSourceMap.end()) {
+			std::string source = fragment->second.IsFilePath ? FileHelpers::ReadResolveIncludes(fragment->second.Source) : fragment->second.Source;
+			if (source.find("DEFERRED") != std::string::npos) {
+				_deferredVariant = GetVariant({ "DEFERRED" });
+			}
+		}
+		if (_deferredVariant == nullptr) {
+			LOG_TRACE("Shader \"{}\" has no deferred variant, it will be shaded forward", _debugName);
+			_deferredVariantFailed = true;
+		}
+	}
+	return _deferredVariant;
+}
+
+ShaderProgram::Sptr ShaderProgram::_BuildVariant(const std::vector<std::string>& defines, bool depthOnly) {
+	// The depth only variant keeps every stage except the fragment shader, so positions come out
+	// exactly the same as the full shader (see the invariant declaration in vs_common.glsl)
+	static const char* emptyFragment = R"LIT(#version 440
+		void main() { }
+	)LIT";
+
+	if (_fileSourceMap.find(ShaderPartType::Vertex) == _fileSourceMap.end()) {
+		return nullptr;
+	}
+
+	// Resolve the final source for each stage, and join them all together with the stage types. The full
+	// text is the cache key, so two different programs can never be mistaken for each other
+	std::string key;
+	std::vector<std::pair<ShaderPartType, std::string>> sources;
+	for (auto& [type, part] : _fileSourceMap) {
+		std::string source = part.IsFilePath ? FileHelpers::ReadResolveIncludes(part.Source) : part.Source;
+		if (depthOnly && type == ShaderPartType::Fragment) {
+			// Shaders that discard (ex: alpha testing) change the depth buffer from the fragment stage, so
+			// the empty fragment shader would write depth where the full shader doesn't
+			if (source.find("discard") != std::string::npos) {
+				return nullptr;
+			}
+			source = emptyFragment;
+		}
+		for (const std::string& define : defines) {
+			bool vertexOnly = std::find(VERTEX_ONLY_DEFINES.begin(), VERTEX_ONLY_DEFINES.end(), define) != VERTEX_ONLY_DEFINES.end();
+			if (type == ShaderPartType::Vertex || !vertexOnly) {
+				source = _InjectDefine(source, define);
+			}
+		}
+		// Each stage is prefixed with it's type and length, so the boundaries between stages can't be ambiguous
+		key += std::to_string(static_cast<uint32_t>(type)) + " " + std::to_string(source.size()) + "\n" + source;
+		sources.push_back({ type, source });
+	}
+
+	// Materials often share shader files without sharing the ShaderProgram, so check if another
+	// shader has already built this exact program
+	auto cached = __VariantCache.find(key);
+	if (cached != __VariantCache.end()) {
+		ShaderProgram::Sptr existing = cached->second.lock();
+		if (existing != nullptr) {
+			return existing;
+		}
+	}
+
+	std::string suffix = depthOnly ? "depth only" : "";
+	for (const std::string& define : defines) {
+		suffix += (suffix.empty() ? "" : ", ") + define;
+	}
+
+	ShaderProgram::Sptr variant = std::make_shared<ShaderProgram>();
+	variant->SetDebugName(_debugName + " (" + suffix + ")");
+	bool success = true;
+	for (auto& [type, source] : sources) {
+		success &= variant->LoadShaderPart(source.c_str(), type);
+	}
+	if (!success || !variant->Link()) {
+		return nullptr;
+	}
+
+	// Variants die with the shaders that use them (ex: when a scene is unloaded), so this is a good time to
+	// drop any entries that have expired rather than letting the cache grow for the life of the app
+	for (auto it = __VariantCache.begin(); it != __VariantCache.end();) {
+		it = it->second.expired() ? __VariantCache.erase(it) : std::next(it);
+	}
+	__VariantCache[key] = variant;
+	return variant;
+}
+
+std::string ShaderProgram::_InjectDefine(const std::string& source, const std::string& define) {
+	// #version must be the first directive in the file, so our define goes on the line after it
+	size_t versionPos = source.find("#version");
+	size_t insertPos = versionPos == std::string::npos ? 0 : source.find('\n', versionPos);
+	insertPos = insertPos == std::string::npos ? source.size() : insertPos + 1;
+
+	std::string result = source;
+	result.insert(insertPos, "#define " + define + "\n");
+	return result;
+}
+
 void ShaderProgram::Bind() {
 	// Simply calls glUseProgram with our shader handle
 	glUseProgram(_rendererId);
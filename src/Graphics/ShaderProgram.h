@@ -3,6 +3,7 @@
 #include <memory>
 #include <string>               // for std::string
 #include <unordered_map>        // for std::unordered_map
+#include <vector>               // for std::vector
 #include <GLM/glm.hpp>          // for our GLM types
 #include <GLM/gtc/type_ptr.hpp> // for glm::value_ptr
 #include <Logging.h>            // for the logging functions
@@ -108,6 +109,38 @@ public:
 	static void Unbind();
 
 	const std::unordered_map<std::string, UniformInfo>& GetUniforms() const { return _uniforms; }
+	/// <summary>
+	/// Gets the uniform blocks in this shader, keyed by block name. The Location of each sub uniform is it's offset within the block
+	/// </summary>
+	const std::unordered_map<std::string, UniformBlockInfo>& GetUniformBlocks() const { return _uniformBlocks; }
+
+	/// <summary>
+	/// Gets a variant of this shader with the given #defines inserted after the #version line of every
+	/// stage (or just the vertex stage, for the defines in VERTEX_ONLY_DEFINES). Variants are compiled on
+	/// first use, and cached by their final source so that shaders loaded from the same files share variants
+	/// </summary>
+	/// <param name="defines">The defines to add, either a name (ex: "INSTANCED") or a name and value (ex: "COUNT 4")</param>
+	/// <returns>The variant, or nullptr if it failed to compile</returns>
+	const ShaderProgram::Sptr& GetVariant(const std::vector<std::string>& defines);
+	/// <summary>
+	/// Gets a variant of this shader with INSTANCED defined, so that model and normal matrices are read
+	/// from per-instance vertex attributes instead of the instance UBO (see vs_common.glsl)
+	/// </summary>
+	/// <returns>The instanced variant, or nullptr if it failed to compile</returns>
+	const ShaderProgram::Sptr& GetInstancedVariant();
+	/// <summary>
+	/// Gets a variant of this shader with the same vertex stage and an empty fragment stage, for
+	/// drawing depth only (ex: a depth pre-pass). The variant is compiled on first use and cached
+	/// </summary>
+	/// <returns>The depth only variant, or nullptr if the fragment stage can discard fragments or it failed to compile</returns>
+	const ShaderProgram::Sptr& GetDepthOnlyVariant();
+	/// <summary>
+	/// Gets a variant of this shader with DEFERRED defined, which writes the surface to the G-buffer instead
+	/// of shading it (see fragments/gbuffer_outputs.glsl). Only shaders that check for DEFERRED in their
+	/// fragment stage get a variant, anything else would write it's lit color over the albedo
+	/// </summary>
+	/// <returns>The deferred variant, or nullptr if the shader doesn't support it or it failed to compile</returns>
+	const ShaderProgram::Sptr& GetDeferredVariant();
 
 	// Inherited from IGraphicsResource
 
@@ -194,6 +227,36 @@ protected:
 	};
 	std::unordered_map<ShaderPartType, ShaderSource> _fileSourceMap;
 
+	// Lazily compiled variants keyed by their sorted defines, see GetVariant. Failed variants are stored as nullptr
+	std::unordered_map<std::string, ShaderProgram::Sptr> _variants;
+	// Lazily compiled variant for depth only rendering, see GetDepthOnlyVariant
+	ShaderProgram::Sptr _depthOnlyVariant;
+	bool                _depthOnlyVariantFailed = false;
+	// Lazily compiled variant for writing to the G-buffer, see GetDeferredVariant
+	ShaderProgram::Sptr _deferredVariant;
+	bool                _deferredVariantFailed = false;
+
+	// Every variant that has been built, keyed by it's final source for every stage. Entries are only weak
+	// references, so the dead ones are swept out whenever a new variant is added
+	static std::unordered_map<std::string, ShaderProgram::Wptr> __VariantCache;
+	// Defines that only change the vertex stage (ex: INSTANCED swaps the per-object uniforms for vertex
+	// attributes), so they aren't injected into the other stages
+	inline static const std::vector<std::string> VERTEX_ONLY_DEFINES = { "INSTANCED" };
+
+	/// <summary>
+	/// Builds a variant of this shader, or finds an identical one that has already been built
+	/// </summary>
+	/// <param name="defines">The defines to inject, see VERTEX_ONLY_DEFINES</param>
+	/// <param name="depthOnly">True to replace the fragment stage with an empty one</param>
+	/// <returns>The variant, or nullptr if it failed to compile (or the shader can't be drawn depth only)</returns>
+	ShaderProgram::Sptr _BuildVariant(const std::vector<std::string>& defines, bool depthOnly);
+	/// <summary>
+	/// Inserts a #define directive directly after the #version line of a shader source
+	/// </summary>
+	/// <param name="source">The GLSL source to modify</param>
+	/// <param name="define">The name of the define to add</param>
+	static std::string _InjectDefine(const std::string& source, const std::string& define);
+
 	/// <summary>
 	/// Performs program introspection, where we examine the uniforms that
 	/// the program contains
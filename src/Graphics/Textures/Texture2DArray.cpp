@@ -0,0 +1,155 @@
+#include "Texture2DArray.h"
+#include <stb_image.h>
+#include <Logging.h>
+#include "GLM/glm.hpp"
+#include "Utils/JsonGlmHelpers.h"
+
+/// <summary>
+/// Get the number of mipmap levels required for a texture of the given size
+/// </summary>
+inline int CalcRequiredMipLevels(int width, int height) {
+	return (1 + floor(log2(glm::max(width, height))));
+}
+
+Texture2DArray::Texture2DArray(const Texture2DArrayDescription& description) :
+	ITexture(TextureType::_2DArray),
+	_description(description)
+{
+	_SetTextureParams();
+	_LoadLayersFromFiles();
+}
+
+void Texture2DArray::LoadData(uint32_t layer, uint32_t width, uint32_t height, PixelFormat format, PixelType type, void* data, uint32_t offsetX, uint32_t offsetY) {
+	// Ensure the rectangle we're setting is within the bounds of the image
+	LOG_ASSERT(layer < _description.Layers, "Layer is outside of the array!");
+	LOG_ASSERT((width + offsetX) <= _description.Width, "Pixel bounds are outside of the X extents of the image!");
+	LOG_ASSERT((height + offsetY) <= _description.Height, "Pixel bounds are outside of the Y extents of the image!");
+
+	// Align the data store to the size of a single component to ensure we don't get weirdness with images that aren't RGBA
+	int componentSize = (GLint)GetTexelComponentSize(type);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, componentSize);
+
+	// Upload our data to the layer, which is just a slice along the z axis
+	glTextureSubImage3D(_rendererId, 0, offsetX, offsetY, layer, width, height, 1, (GLenum)format, (GLenum)type, data);
+
+	UpdateMipMaps();
+}
+
+void Texture2DArray::CopyLayer(uint32_t layer, const Texture2D::Sptr& texture) {
+	LOG_ASSERT(layer < _description.Layers, "Layer is outside of the array!");
+	LOG_ASSERT(texture->GetWidth() == _description.Width && texture->GetHeight() == _description.Height, "Texture size does not match the array!");
+	LOG_ASSERT(texture->GetFormat() == _description.Format, "Texture format does not match the array!");
+
+	glCopyImageSubData(
+		texture->GetHandle(), GL_TEXTURE_2D, 0, 0, 0, 0,
+		_rendererId, GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer,
+		_description.Width, _description.Height, 1
+	);
+}
+
+void Texture2DArray::UpdateMipMaps() {
+	if (_description.GenerateMipMaps) {
+		glGenerateTextureMipmap(_rendererId);
+	}
+}
+
+nlohmann::json Texture2DArray::ToJson() const {
+	nlohmann::json result ={
+		{ "size_x",            _description.Width },
+		{ "size_y",            _description.Height },
+		{ "layers",            _description.Layers },
+		{ "internal_format",  ~_description.Format },
+		{ "wrap_s",           ~_description.HorizontalWrap },
+		{ "wrap_t",           ~_description.VerticalWrap },
+		{ "filter_min",       ~_description.MinificationFilter },
+		{ "filter_mag",       ~_description.MagnificationFilter },
+		{ "anisotropic",       _description.MaxAnisotropic },
+		{ "generate_mipmaps",  _description.GenerateMipMaps },
+		{ "filenames",         _description.Filenames }
+	};
+	return result;
+}
+
+Texture2DArray::Sptr Texture2DArray::FromJson(const nlohmann::json& data) {
+	Texture2DArrayDescription descr = Texture2DArrayDescription();
+	descr.Width               = JsonGet(data, "size_x", descr.Width);
+	descr.Height              = JsonGet(data, "size_y", descr.Height);
+	descr.Layers              = JsonGet(data, "layers", descr.Layers);
+	descr.Format              = JsonParseEnum(InternalFormat, data, "internal_format", InternalFormat::RGBA8);
+	descr.HorizontalWrap      = JsonParseEnum(WrapMode, data, "wrap_s", WrapMode::ClampToEdge);
+	descr.VerticalWrap        = JsonParseEnum(WrapMode, data, "wrap_t", WrapMode::ClampToEdge);
+	descr.MinificationFilter  = JsonParseEnum(MinFilter, data, "filter_min", MinFilter::NearestMipNearest);
+	descr.MagnificationFilter = JsonParseEnum(MagFilter, data, "filter_mag", MagFilter::Linear);
+	descr.MaxAnisotropic      = JsonGet(data, "anisotropic", 0.0f);
+	descr.GenerateMipMaps     = JsonGet(data, "generate_mipmaps", false);
+	if (data.contains("filenames") && data["filenames"].is_array()) {
+		descr.Filenames = data["filenames"].get<std::vector<std::string>>();
+	}
+
+	return std::make_shared<Texture2DArray>(descr);
+}
+
+void Texture2DArray::_LoadLayersFromFiles() {
+	bool loadedAny = false;
+	size_t layers = glm::min(_description.Filenames.size(), (size_t)_description.Layers);
+	for (size_t layer = 0; layer < layers; layer++) {
+		const std::string& filename = _description.Filenames[layer];
+		if (filename.empty()) {
+			continue;
+		}
+
+		// Match Texture2D's orientation, so UVs are the same whether a material uses the array or not
+		int width, height, numChannels;
+		const int targetChannels = GetTexelComponentCount(_description.FormatHint);
+		stbi_set_flip_vertically_on_load(true);
+		uint8_t* data = stbi_load(filename.c_str(), &width, &height, &numChannels, targetChannels);
+
+		if (data == nullptr) {
+			LOG_WARN("STBI Failed to load image from \"{}\"", filename);
+			continue;
+		}
+		if ((uint32_t)width != _description.Width || (uint32_t)height != _description.Height) {
+			LOG_WARN("Image \"{}\" is {}x{}, but the texture array is {}x{}, skipping layer", filename, width, height, _description.Width, _description.Height);
+			stbi_image_free(data);
+			continue;
+		}
+
+		if (targetChannels != 0) {
+			numChannels = targetChannels;
+		}
+
+		// Upload without going through LoadData, so mip maps only get generated once at the end
+		glTextureSubImage3D(_rendererId, 0, 0, 0, (GLint)layer, width, height, 1, (GLenum)GetPixelFormatForChannels(numChannels), GL_UNSIGNED_BYTE, data);
+		stbi_image_free(data);
+		loadedAny = true;
+	}
+
+	if (loadedAny) {
+		UpdateMipMaps();
+	}
+}
+
+void Texture2DArray::_SetTextureParams() {
+	// If the anisotropy is negative, we assume that we want max anisotropy
+	if (_description.MaxAnisotropic < 0.0f) {
+		_description.MaxAnisotropic = ITexture::GetLimits().MAX_ANISOTROPY;
+	}
+
+	if (_description.Layers > (uint32_t)ITexture::GetLimits().MAX_ARRAY_TEXTURE_LAYERS) {
+		LOG_WARN("Texture array has {} layers, but the renderer only supports {}", _description.Layers, ITexture::GetLimits().MAX_ARRAY_TEXTURE_LAYERS);
+	}
+
+	// Make sure the size is greater than zero and that we have a format specified before trying to set parameters
+	if ((_description.Width * _description.Height * _description.Layers > 0) && _description.Format != InternalFormat::Unknown) {
+		// Calculate how many levels of storage to allocate based on whether mipmaps are enabled or not
+		int levels = _description.GenerateMipMaps ? CalcRequiredMipLevels(_description.Width, _description.Height) : 1;
+		// Allocates the memory for every layer at once
+		glTextureStorage3D(_rendererId, levels, (GLenum)_description.Format, _description.Width, _description.Height, _description.Layers);
+
+		glTextureParameteri(_rendererId, GL_TEXTURE_MIN_FILTER, (GLenum)_description.MinificationFilter);
+		glTextureParameteri(_rendererId, GL_TEXTURE_MAG_FILTER, (GLenum)_description.MagnificationFilter);
+		glTextureParameterf(_rendererId, GL_TEXTURE_MAX_ANISOTROPY, _description.MaxAnisotropic);
+		glTextureParameteri(_rendererId, GL_TEXTURE_WRAP_S, (GLenum)_description.HorizontalWrap);
+		glTextureParameteri(_rendererId, GL_TEXTURE_WRAP_T, (GLenum)_description.VerticalWrap);
+	}
+}
@@ -1,6 +1,7 @@
 #include "VertexArrayObject.h"
 #include "Buffers/IndexBuffer.h"
 #include "Buffers/VertexBuffer.h"
+#include "Buffers/IndirectBuffer.h"
 #include "Logging.h"
 
 VertexArrayObject::VertexArrayObject() :
@@ -16,6 +17,10 @@ VertexArrayObject::VertexArrayObject() :
 VertexArrayObject::~VertexArrayObject()
 {
 	if (_handle != 0) {
+		// Deleting the bound VAO reverts the binding to 0
+		if (__BoundHandle == _handle) {
+			__BoundHandle = 0;
+		}
 		glDeleteVertexArrays(1, &_handle);
 		_handle = 0;
 	}
@@ -43,7 +48,8 @@ VertexArrayObject::VertexBufferBinding* VertexArrayObject::AddVertexBuffer(const
 			_elementCount = _vertexCount;
 		}
 	} 
-	else if (buffer->GetElementCount() != _vertexCount) {
+	// Instanced buffers hold one element per instance, so they won't line up with the vertex count
+	else if (!instanced && buffer->GetElementCount() != _vertexCount) {
 		LOG_WARN("Buffer element count does not match vertex count of this VAO!!!");
 	}
 
@@ -113,27 +119,49 @@ void VertexArrayObject::Draw(DrawMode mode) {
 	Unbind();
 }
 
-void VertexArrayObject::DrawInstanced(uint32_t instanceCount, DrawMode mode /*= DrawMode::TriangleList*/)
+void VertexArrayObject::DrawRange(uint32_t firstVertex, uint32_t vertexCount, DrawMode mode /*= DrawMode::TriangleList*/)
+{
+	Bind();
+	glDrawArrays((GLenum)mode, firstVertex, vertexCount);
+	Unbind();
+}
+
+void VertexArrayObject::DrawInstanced(uint32_t instanceCount, DrawMode mode /*= DrawMode::TriangleList*/, uint32_t baseInstance /*= 0*/)
 {
 	Bind();
 	if (_indexBuffer == nullptr) {
 		uint32_t elements = _elementCount == 0 ? _vertexBuffers[0]->Buffer->GetElementCount() : _elementCount;
-		glDrawArraysInstanced((GLenum)mode, 0, elements, instanceCount);
+		glDrawArraysInstancedBaseInstance((GLenum)mode, 0, elements, instanceCount, baseInstance);
 	}
 	else {
 		uint32_t elements = _elementCount == 0 ? _indexBuffer->GetElementCount() : _elementCount;
-		glDrawElementsInstanced((GLenum)mode, elements, (GLenum)_indexBuffer->GetElementType(), nullptr, instanceCount);
+		glDrawElementsInstancedBaseInstance((GLenum)mode, elements, (GLenum)_indexBuffer->GetElementType(), nullptr, instanceCount, baseInstance);
 	}
 	Unbind();
 	
 }
 
+void VertexArrayObject::MultiDrawIndirect(uint32_t commandCount, uint32_t firstCommand /*= 0*/, DrawMode mode /*= DrawMode::TriangleList*/)
+{
+	LOG_ASSERT(_indexBuffer != nullptr, "Indirect draws require an index buffer");
+	Bind();
+	// The last parameter is the stride, 0 means the commands are tightly packed
+	const void* offset = reinterpret_cast<const void*>(static_cast<uintptr_t>(firstCommand) * sizeof(DrawElementsIndirectCommand));
+	glMultiDrawElementsIndirect((GLenum)mode, (GLenum)_indexBuffer->GetElementType(), offset, commandCount, 0);
+	Unbind();
+}
+
 void VertexArrayObject::Bind() {
-	glBindVertexArray(_handle);
+	BindHandle(_handle);
 }
 
 void VertexArrayObject::Unbind() {
-	glBindVertexArray(0);
+	BindHandle(0);
+}
+
+void VertexArrayObject::BindHandle(GLuint handle) {
+	glBindVertexArray(handle);
+	__BoundHandle = handle;
 }
 
 void VertexArrayObject::SetVDecl(const VertexDeclaration& vDecl) {
@@ -177,6 +205,7 @@ VertexArrayObject::Sptr VertexArrayObject::Clone() const
 	}
 
 	result->SetVDecl(_vDecl);
+	result->SetBounds(_bounds);
 
 	return result;
 }
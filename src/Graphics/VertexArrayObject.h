@@ -9,6 +9,7 @@
 #include "Graphics/Buffers/IndexBuffer.h"
 #include "Graphics/GlEnums.h"
 #include "Graphics/IGraphicsResource.h"
+#include "Graphics/BoundingVolume.h"
 
 /// <summary>
 /// This structure will represent the parameters passed to the glVertexAttribPointer commands
@@ -125,6 +126,14 @@ public:
 	/// </summary>
 	/// <param name="mode">The draw mode for primitives in this VAO</param>
 	void Draw(DrawMode mode = DrawMode::TriangleList);
+	/// <summary>
+	/// Renders a range of vertices from this VAO without going through the index buffer, for
+	/// buffers that are streamed into a piece at a time (ex: the debug drawer)
+	/// </summary>
+	/// <param name="firstVertex">The index of the first vertex to draw</param>
+	/// <param name="vertexCount">The number of vertices to draw</param>
+	/// <param name="mode">The primitive mode for rendering the vertices</param>
+	void DrawRange(uint32_t firstVertex, uint32_t vertexCount, DrawMode mode = DrawMode::TriangleList);
 
 	/// <summary>
 	/// Renders this VAO with the given instance count, using the specified draw mode. 
@@ -132,7 +141,17 @@ public:
 	/// </summary>
 	/// <param name="instanceCount">The number of instances to render</param>
 	/// <param name="mode">The primitive mode for rendering the mesh</param>
-	void DrawInstanced(uint32_t instanceCount, DrawMode mode = DrawMode::TriangleList);
+	/// <param name="baseInstance">The index of the first element to read from instanced buffers</param>
+	void DrawInstanced(uint32_t instanceCount, DrawMode mode = DrawMode::TriangleList, uint32_t baseInstance = 0);
+
+	/// <summary>
+	/// Renders a series of draw commands read from the currently bound indirect buffer, using glMultiDrawElementsIndirect.
+	/// This VAO must have an index buffer, and the commands index into it using their FirstIndex and BaseVertex
+	/// </summary>
+	/// <param name="commandCount">The number of commands to read from the indirect buffer</param>
+	/// <param name="firstCommand">The index of the first command to read from the indirect buffer</param>
+	/// <param name="mode">The primitive mode for rendering the mesh</param>
+	void MultiDrawIndirect(uint32_t commandCount, uint32_t firstCommand = 0, DrawMode mode = DrawMode::TriangleList);
 
 	/// <summary>
 	/// Binds this VAO as the source of data for draw operations
@@ -142,6 +161,16 @@ public:
 	/// Unbinds the currently bound VAO
 	/// </summary>
 	static void Unbind();
+	/// <summary>
+	/// Gets the handle of the VAO that was last bound through this class. Lets callers restore the
+	/// binding when they're done without a glGet, which can stall the pipeline
+	/// </summary>
+	static GLuint GetBoundHandle() { return __BoundHandle; }
+	/// <summary>
+	/// Binds a VAO by it's handle, for restoring a binding returned by GetBoundHandle
+	/// </summary>
+	/// <param name="handle">The handle of the VAO to bind, or 0 to unbind</param>
+	static void BindHandle(GLuint handle);
 
 	/// <summary>
 	/// Returns the underlying OpenGL handle that this class is wrapping around
@@ -151,6 +180,15 @@ public:
 	void SetVDecl(const VertexDeclaration& vDecl);
 	const VertexDeclaration& GetVDecl();
 
+	/// <summary>
+	/// Sets the object space bounds of the mesh, these are calculated when a mesh is baked or loaded
+	/// </summary>
+	void SetBounds(const MeshBounds& bounds) { _bounds = bounds; }
+	/// <summary>
+	/// Gets the object space bounds of the mesh, the box will be invalid if bounds were never set
+	/// </summary>
+	const MeshBounds& GetBounds() const { return _bounds; }
+
 protected:
 	
 	// The index buffer bound to this VAO
@@ -162,12 +200,18 @@ protected:
 	// defined in VertexTypes.cpp
 	VertexDeclaration _vDecl;
 
+	// Object space bounding volumes for culling
+	MeshBounds _bounds;
+
 	uint32_t _vertexCount;
 	uint32_t _elementCount;
 
 	// The underlying OpenGL handle that this class is wrapping around
 	GLuint _handle;
 
+	// The VAO last bound through Bind, Unbind or BindHandle
+	inline static GLuint __BoundHandle = 0;
+
 	// Inherited via IGraphicsResource
 	virtual GlResourceType GetResourceClass() const override;
 };
@@ -0,0 +1,403 @@
+#include "DynamicAabbTree.h"
+#include <algorithm>
+#include <Logging.h>
+
+DynamicAabbTree::DynamicAabbTree() :
+	_nodes(std::vector<Node>()),
+	_root(NULL_PROXY),
+	_freeList(NULL_PROXY),
+	_proxyCount(0)
+{ }
+
+DynamicAabbTree::ProxyId DynamicAabbTree::CreateProxy(const AABB& box, void* userData) {
+	int32_t leaf = _AllocateNode();
+	_nodes[leaf].Box = _Fatten(box);
+	_nodes[leaf].UserData = userData;
+	_nodes[leaf].Height = 0;
+	_InsertLeaf(leaf);
+	_proxyCount++;
+	return leaf;
+}
+
+void DynamicAabbTree::DestroyProxy(ProxyId proxy) {
+	LOG_ASSERT(proxy >= 0 && proxy < static_cast<int32_t>(_nodes.size()) && _nodes[proxy].IsLeaf(), "Invalid proxy ID");
+	_RemoveLeaf(proxy);
+	_FreeNode(proxy);
+	_proxyCount--;
+}
+
+bool DynamicAabbTree::MoveProxy(ProxyId proxy, const AABB& box) {
+	LOG_ASSERT(proxy >= 0 && proxy < static_cast<int32_t>(_nodes.size()) && _nodes[proxy].IsLeaf(), "Invalid proxy ID");
+
+	// Still inside the fat box, and the fat box isn't way too big for it (ex: the object shrank a
+	// lot or was teleported onto a tiny mesh), so nothing above this leaf can have changed
+	const AABB& fat = _nodes[proxy].Box;
+	if (_Contains(fat, box)) {
+		AABB huge = _Fatten(_Fatten(box));
+		if (_Contains(huge, fat)) {
+			return false;
+		}
+	}
+
+	_RemoveLeaf(proxy);
+	_nodes[proxy].Box = _Fatten(box);
+	_InsertLeaf(proxy);
+	return true;
+}
+
+void* DynamicAabbTree::GetUserData(ProxyId proxy) const {
+	return _nodes[proxy].UserData;
+}
+
+const AABB& DynamicAabbTree::GetFatBox(ProxyId proxy) const {
+	return _nodes[proxy].Box;
+}
+
+void DynamicAabbTree::QueryBox(const AABB& box, const QueryCallback& callback) const {
+	if (_root == NULL_PROXY) {
+		return;
+	}
+
+	int32_t stack[STACK_SIZE];
+	int count = 0;
+	stack[count++] = _root;
+	while (count > 0) {
+		const Node& node = _nodes[stack[--count]];
+		if (!node.Box.Intersects(box)) {
+			continue;
+		}
+		if (node.IsLeaf()) {
+			if (!callback(static_cast<ProxyId>(&node - _nodes.data()))) {
+				return;
+			}
+		} else {
+			LOG_ASSERT(count + 2 <= STACK_SIZE, "Tree query stack overflow");
+			stack[count++] = node.Child1;
+			stack[count++] = node.Child2;
+		}
+	}
+}
+
+void DynamicAabbTree::QuerySphere(const BoundingSphere& sphere, const QueryCallback& callback) const {
+	if (_root == NULL_PROXY) {
+		return;
+	}
+
+	int32_t stack[STACK_SIZE];
+	int count = 0;
+	stack[count++] = _root;
+	while (count > 0) {
+		const Node& node = _nodes[stack[--count]];
+		if (!SphereIntersects(node.Box, sphere)) {
+			continue;
+		}
+		if (node.IsLeaf()) {
+			if (!callback(static_cast<ProxyId>(&node - _nodes.data()))) {
+				return;
+			}
+		} else {
+			LOG_ASSERT(count + 2 <= STACK_SIZE, "Tree query stack overflow");
+			stack[count++] = node.Child1;
+			stack[count++] = node.Child2;
+		}
+	}
+}
+
+void DynamicAabbTree::QueryFrustum(const Frustum& frustum, const QueryCallback& callback) const {
+	if (_root == NULL_PROXY) {
+		return;
+	}
+
+	// The high bit of a stack entry marks nodes that we already know are entirely inside the frustum,
+	// everything under them gets reported without touching the planes again
+	constexpr int32_t INSIDE_BIT = INT32_MIN;
+
+	int32_t stack[STACK_SIZE];
+	int count = 0;
+	stack[count++] = _root;
+	while (count > 0) {
+		int32_t entry = stack[--count];
+		bool inside = (entry & INSIDE_BIT) != 0;
+		const Node& node = _nodes[entry & ~INSIDE_BIT];
+		if (!inside) {
+			if (!frustum.Intersects(node.Box)) {
+				continue;
+			}
+			inside = !node.IsLeaf() && frustum.Contains(node.Box);
+		}
+		if (node.IsLeaf()) {
+			if (!callback(static_cast<ProxyId>(&node - _nodes.data()))) {
+				return;
+			}
+		} else {
+			LOG_ASSERT(count + 2 <= STACK_SIZE, "Tree query stack overflow");
+			stack[count++] = node.Child1 | (inside ? INSIDE_BIT : 0);
+			stack[count++] = node.Child2 | (inside ? INSIDE_BIT : 0);
+		}
+	}
+}
+
+void DynamicAabbTree::RayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, const RayCallback& callback) const {
+	if (_root == NULL_PROXY) {
+		return;
+	}
+
+	// Dividing by a zero component gives +/-infinity, which the slab test handles correctly
+	const glm::vec3 invDirection = 1.0f / direction;
+
+	int32_t stack[STACK_SIZE];
+	int count = 0;
+	stack[count++] = _root;
+	while (count > 0 && maxDistance > 0.0f) {
+		int32_t index = stack[--count];
+		const Node& node = _nodes[index];
+		float entry;
+		if (!RayIntersects(node.Box, origin, invDirection, maxDistance, entry)) {
+			continue;
+		}
+		if (node.IsLeaf()) {
+			maxDistance = glm::min(maxDistance, callback(index, entry, maxDistance));
+		} else {
+			LOG_ASSERT(count + 2 <= STACK_SIZE, "Tree query stack overflow");
+			stack[count++] = node.Child1;
+			stack[count++] = node.Child2;
+		}
+	}
+}
+
+int DynamicAabbTree::GetHeight() const {
+	return _root == NULL_PROXY ? 0 : _nodes[_root].Height;
+}
+
+bool DynamicAabbTree::RayIntersects(const AABB& box, const glm::vec3& origin, const glm::vec3& invDirection, float maxDistance, float& outDistance) {
+	glm::vec3 t0 = (box.Min - origin) * invDirection;
+	glm::vec3 t1 = (box.Max - origin) * invDirection;
+	glm::vec3 tMin = glm::min(t0, t1);
+	glm::vec3 tMax = glm::max(t0, t1);
+	float enter = glm::max(glm::max(tMin.x, tMin.y), glm::max(tMin.z, 0.0f));
+	float exit  = glm::min(glm::min(tMax.x, tMax.y), glm::min(tMax.z, maxDistance));
+	outDistance = enter;
+	return enter <= exit;
+}
+
+bool DynamicAabbTree::SphereIntersects(const AABB& box, const BoundingSphere& sphere) {
+	glm::vec3 closest = glm::clamp(sphere.Center, box.Min, box.Max);
+	glm::vec3 delta = closest - sphere.Center;
+	return glm::dot(delta, delta) <= sphere.Radius * sphere.Radius;
+}
+
+int32_t DynamicAabbTree::_AllocateNode() {
+	int32_t result;
+	if (_freeList != NULL_PROXY) {
+		result = _freeList;
+		_freeList = _nodes[result].Parent;
+	} else {
+		result = static_cast<int32_t>(_nodes.size());
+		_nodes.emplace_back();
+	}
+
+	Node& node = _nodes[result];
+	node.Box = AABB();
+	node.UserData = nullptr;
+	node.Parent = NULL_PROXY;
+	node.Child1 = NULL_PROXY;
+	node.Child2 = NULL_PROXY;
+	node.Height = 0;
+	return result;
+}
+
+void DynamicAabbTree::_FreeNode(int32_t node) {
+	_nodes[node].Parent = _freeList;
+	_nodes[node].Height = -1;
+	_freeList = node;
+}
+
+void DynamicAabbTree::_InsertLeaf(int32_t leaf) {
+	if (_root == NULL_PROXY) {
+		_root = leaf;
+		_nodes[leaf].Parent = NULL_PROXY;
+		return;
+	}
+
+	// Walk down towards the sibling that would add the least surface area to the tree. Pushing the leaf
+	// further down costs the area that every branch on the way has to grow by, so we stop when pairing
+	// the leaf with the current node is cheaper than going any further
+	const AABB leafBox = _nodes[leaf].Box;
+	int32_t index = _root;
+	while (!_nodes[index].IsLeaf()) {
+		const Node& node = _nodes[index];
+		float area = _SurfaceArea(node.Box);
+		float combinedArea = _SurfaceArea(_Combine(node.Box, leafBox));
+
+		// Cost of making a new parent for this node and the leaf
+		float cost = 2.0f * combinedArea;
+		// Minimum cost of pushing the leaf further down
+		float inheritanceCost = 2.0f * (combinedArea - area);
+
+		float childCosts[2];
+		for (int ix = 0; ix < 2; ix++) {
+			const Node& child = _nodes[ix == 0 ? node.Child1 : node.Child2];
+			float childArea = _SurfaceArea(_Combine(child.Box, leafBox));
+			if (!child.IsLeaf()) {
+				childArea -= _SurfaceArea(child.Box);
+			}
+			childCosts[ix] = childArea + inheritanceCost;
+		}
+
+		if (cost < childCosts[0] && cost < childCosts[1]) {
+			break;
+		}
+		index = childCosts[0] < childCosts[1] ? node.Child1 : node.Child2;
+	}
+
+	// Make a new branch to hold the sibling and the leaf
+	int32_t sibling = index;
+	int32_t oldParent = _nodes[sibling].Parent;
+	int32_t newParent = _AllocateNode();
+	_nodes[newParent].Parent = oldParent;
+	_nodes[newParent].Box = _Combine(leafBox, _nodes[sibling].Box);
+	_nodes[newParent].Height = _nodes[sibling].Height + 1;
+	_nodes[newParent].Child1 = sibling;
+	_nodes[newParent].Child2 = leaf;
+	_nodes[sibling].Parent = newParent;
+	_nodes[leaf].Parent = newParent;
+
+	if (oldParent != NULL_PROXY) {
+		if (_nodes[oldParent].Child1 == sibling) {
+			_nodes[oldParent].Child1 = newParent;
+		} else {
+			_nodes[oldParent].Child2 = newParent;
+		}
+	} else {
+		_root = newParent;
+	}
+
+	_RefitUpwards(_nodes[leaf].Parent);
+}
+
+void DynamicAabbTree::_RemoveLeaf(int32_t leaf) {
+	if (leaf == _root) {
+		_root = NULL_PROXY;
+		return;
+	}
+
+	// The leaf's sibling takes it's parent's place
+	int32_t parent = _nodes[leaf].Parent;
+	int32_t grandParent = _nodes[parent].Parent;
+	int32_t sibling = _nodes[parent].Child1 == leaf ? _nodes[parent].Child2 : _nodes[parent].Child1;
+
+	if (grandParent != NULL_PROXY) {
+		if (_nodes[grandParent].Child1 == parent) {
+			_nodes[grandParent].Child1 = sibling;
+		} else {
+			_nodes[grandParent].Child2 = sibling;
+		}
+		_nodes[sibling].Parent = grandParent;
+		_FreeNode(parent);
+		_RefitUpwards(grandParent);
+	} else {
+		_root = sibling;
+		_nodes[sibling].Parent = NULL_PROXY;
+		_FreeNode(parent);
+	}
+}
+
+void DynamicAabbTree::_RefitUpwards(int32_t index) {
+	while (index != NULL_PROXY) {
+		index = _Balance(index);
+
+		Node& node = _nodes[index];
+		const Node& child1 = _nodes[node.Child1];
+		const Node& child2 = _nodes[node.Child2];
+		node.Height = 1 + glm::max(child1.Height, child2.Height);
+		node.Box = _Combine(child1.Box, child2.Box);
+
+		index = node.Parent;
+	}
+}
+
+int32_t DynamicAabbTree::_Balance(int32_t iA) {
+	Node* A = &_nodes[iA];
+	if (A->IsLeaf() || A->Height < 2) {
+		return iA;
+	}
+
+	int32_t iB = A->Child1;
+	int32_t iC = A->Child2;
+	Node* B = &_nodes[iB];
+	Node* C = &_nodes[iC];
+
+	int32_t balance = C->Height - B->Height;
+
+	// Rotates the taller child (iUp) up into A's place, and moves A down to become it's child. The taller
+	// of the raised node's children stays with it, the shorter one is handed to A
+	auto rotate = [&](int32_t iUp, int32_t iOther) {
+		Node* up = &_nodes[iUp];
+		Node* other = &_nodes[iOther];
+		int32_t iF = up->Child1;
+		int32_t iG = up->Child2;
+		Node* F = &_nodes[iF];
+		Node* G = &_nodes[iG];
+
+		up->Child1 = iA;
+		up->Parent = A->Parent;
+		A->Parent = iUp;
+
+		if (up->Parent != NULL_PROXY) {
+			if (_nodes[up->Parent].Child1 == iA) {
+				_nodes[up->Parent].Child1 = iUp;
+			} else {
+				_nodes[up->Parent].Child2 = iUp;
+			}
+		} else {
+			_root = iUp;
+		}
+
+		// Keep the taller grandchild up top, and give the shorter one to A in the raised node's old slot
+		int32_t iKeep = F->Height > G->Height ? iF : iG;
+		int32_t iGive = iKeep == iF ? iG : iF;
+		Node* keep = &_nodes[iKeep];
+		Node* give = &_nodes[iGive];
+
+		up->Child2 = iKeep;
+		if (A->Child1 == iUp) {
+			A->Child1 = iGive;
+		} else {
+			A->Child2 = iGive;
+		}
+		give->Parent = iA;
+
+		A->Box = _Combine(other->Box, give->Box);
+		A->Height = 1 + glm::max(other->Height, give->Height);
+		up->Box = _Combine(A->Box, keep->Box);
+		up->Height = 1 + glm::max(A->Height, keep->Height);
+	};
+
+	if (balance > 1) {
+		rotate(iC, iB);
+		return iC;
+	}
+	if (balance < -1) {
+		rotate(iB, iC);
+		return iB;
+	}
+	return iA;
+}
+
+AABB DynamicAabbTree::_Fatten(const AABB& box) {
+	glm::vec3 margin = glm::vec3(FAT_MARGIN) + (box.Max - box.Min) * FAT_SCALE;
+	return AABB(box.Min - margin, box.Max + margin);
+}
+
+AABB DynamicAabbTree::_Combine(const AABB& a, const AABB& b) {
+	return AABB(glm::min(a.Min, b.Min), glm::max(a.Max, b.Max));
+}
+
+float DynamicAabbTree::_SurfaceArea(const AABB& box) {
+	glm::vec3 size = box.Max - box.Min;
+	return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+bool DynamicAabbTree::_Contains(const AABB& outer, const AABB& inner) {
+	return glm::all(glm::lessThanEqual(outer.Min, inner.Min)) && glm::all(glm::greaterThanEqual(outer.Max, inner.Max));
+}
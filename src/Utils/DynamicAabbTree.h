@@ -0,0 +1,177 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <GLM/glm.hpp>
+
+#include "Utils/Macros.h"
+#include "Graphics/BoundingVolume.h"
+
+/// <summary>
+/// A bounding volume hierarchy for answering spatial queries over lots of moving boxes, without
+/// having to rebuild it every frame
+///
+/// Each proxy is stored with a "fat" box that is a bit bigger than the box it was given, so small
+/// movements only need a containment check. When a box leaves it's fat box, the leaf is pulled out
+/// and re-inserted next to the sibling that grows the tree's surface area the least, and the path
+/// back to the root is refit and re-balanced with tree rotations
+///
+/// Queries are const and keep their traversal stack on the stack, so they can be run from many
+/// threads at once as long as nothing is being moved at the same time
+/// </summary>
+class DynamicAabbTree final {
+public:
+	MAKE_PTRS(DynamicAabbTree);
+	NO_COPY(DynamicAabbTree);
+	NO_MOVE(DynamicAabbTree);
+
+	typedef int32_t ProxyId;
+	static constexpr ProxyId NULL_PROXY = -1;
+
+	/// <summary>
+	/// Invoked for every proxy that a query overlaps. Return false to stop the query early
+	/// </summary>
+	typedef std::function<bool(ProxyId proxy)> QueryCallback;
+	/// <summary>
+	/// Invoked for every proxy who's fat box the ray passes through, with the distance along the
+	/// ray that it enters the box. Returns the new max distance for the ray, return the distance
+	/// of a hit to only look for closer ones, maxDistance to keep going, or 0 to stop
+	/// </summary>
+	typedef std::function<float(ProxyId proxy, float entryDistance, float maxDistance)> RayCallback;
+
+	DynamicAabbTree();
+	~DynamicAabbTree() = default;
+
+	/// <summary>
+	/// Adds a new proxy to the tree
+	/// </summary>
+	/// <param name="box">The tight bounds of the proxy, will be fattened before insertion</param>
+	/// <param name="userData">Pointer to store with the proxy, can be retrieved with GetUserData</param>
+	/// <returns>The ID of the new proxy, which stays the same for the life of the proxy</returns>
+	ProxyId CreateProxy(const AABB& box, void* userData);
+	/// <summary>
+	/// Removes a proxy from the tree, the ID may be re-used by a later proxy
+	/// </summary>
+	void DestroyProxy(ProxyId proxy);
+	/// <summary>
+	/// Updates the bounds of a proxy. The tree is only modified if the new box is outside of the
+	/// proxy's fat box, or much smaller than it
+	/// </summary>
+	/// <param name="proxy">The proxy to move</param>
+	/// <param name="box">The new tight bounds of the proxy</param>
+	/// <returns>True if the proxy had to be re-inserted</returns>
+	bool MoveProxy(ProxyId proxy, const AABB& box);
+
+	/// <summary>
+	/// Gets the pointer that was passed in when the proxy was created
+	/// </summary>
+	void* GetUserData(ProxyId proxy) const;
+	/// <summary>
+	/// Gets the enlarged box that the proxy is stored with
+	/// </summary>
+	const AABB& GetFatBox(ProxyId proxy) const;
+
+	/// <summary>
+	/// Finds all proxies who's fat boxes overlap the given box
+	/// </summary>
+	void QueryBox(const AABB& box, const QueryCallback& callback) const;
+	/// <summary>
+	/// Finds all proxies who's fat boxes overlap the given sphere
+	/// </summary>
+	void QuerySphere(const BoundingSphere& sphere, const QueryCallback& callback) const;
+	/// <summary>
+	/// Finds all proxies who's fat boxes are at least partially inside the frustum. Branches that
+	/// are entirely inside the frustum are reported without testing any more planes
+	/// </summary>
+	void QueryFrustum(const Frustum& frustum, const QueryCallback& callback) const;
+	/// <summary>
+	/// Finds the proxies who's fat boxes are crossed by a ray, see RayCallback for how to
+	/// narrow down the search as hits are found. Proxies are not reported in distance order
+	/// </summary>
+	/// <param name="origin">The world space start point of the ray</param>
+	/// <param name="direction">The direction of the ray, does not need to be normalized</param>
+	/// <param name="maxDistance">How far along the ray to search, in multiples of direction</param>
+	/// <param name="callback">The callback to invoke for each proxy the ray crosses</param>
+	void RayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, const RayCallback& callback) const;
+
+	/// <summary>
+	/// Gets the height of the tree, a balanced tree will be around log2 of the proxy count
+	/// </summary>
+	int GetHeight() const;
+	/// <summary>
+	/// Gets the number of proxies in the tree
+	/// </summary>
+	uint32_t GetProxyCount() const { return _proxyCount; }
+
+	/// <summary>
+	/// Tests a ray against a box using the slab method
+	/// </summary>
+	/// <param name="origin">The start point of the ray</param>
+	/// <param name="invDirection">One over the direction of the ray for each axis</param>
+	/// <param name="maxDistance">How far along the ray to search</param>
+	/// <param name="outDistance">Receives the distance the ray enters the box at, or 0 if it starts inside</param>
+	/// <returns>True if the ray crosses the box within maxDistance</returns>
+	static bool RayIntersects(const AABB& box, const glm::vec3& origin, const glm::vec3& invDirection, float maxDistance, float& outDistance);
+	/// <summary>
+	/// Returns true if the box and sphere overlap
+	/// </summary>
+	static bool SphereIntersects(const AABB& box, const BoundingSphere& sphere);
+
+protected:
+	// Boxes are fattened by this amount in world units, plus FAT_SCALE times their size along each axis
+	static constexpr float FAT_MARGIN = 0.1f;
+	static constexpr float FAT_SCALE  = 0.1f;
+	// Deeper than any tree we'll ever build, a balanced tree of a million proxies is ~20 levels deep
+	static constexpr int   STACK_SIZE = 256;
+
+	struct Node {
+		// The fat box for leaves, the union of the children's boxes for branches
+		AABB    Box;
+		void*   UserData;
+		// Parent node for nodes in the tree, the next free node for nodes in the free list
+		int32_t Parent;
+		int32_t Child1;
+		int32_t Child2;
+		// 0 for leaves, -1 for free nodes
+		int32_t Height;
+
+		bool IsLeaf() const { return Child1 == NULL_PROXY; }
+	};
+
+	std::vector<Node> _nodes;
+	int32_t           _root;
+	int32_t           _freeList;
+	uint32_t          _proxyCount;
+
+	int32_t _AllocateNode();
+	void _FreeNode(int32_t node);
+
+	void _InsertLeaf(int32_t leaf);
+	void _RemoveLeaf(int32_t leaf);
+	/// <summary>
+	/// Re-fits and re-balances the boxes from the given node up to the root
+	/// </summary>
+	void _RefitUpwards(int32_t node);
+	/// <summary>
+	/// Performs a left or right rotation if the node is imbalanced
+	/// </summary>
+	/// <returns>The new root of the sub-tree</returns>
+	int32_t _Balance(int32_t node);
+
+	/// <summary>
+	/// Adds the margins to a tight box
+	/// </summary>
+	static AABB _Fatten(const AABB& box);
+	/// <summary>
+	/// Gets the box enclosing both boxes
+	/// </summary>
+	static AABB _Combine(const AABB& a, const AABB& b);
+	/// <summary>
+	/// Gets the surface area of a box, which is proportional to the odds of a random query hitting it
+	/// </summary>
+	static float _SurfaceArea(const AABB& box);
+	/// <summary>
+	/// Returns true if outer entirely contains inner
+	/// </summary>
+	static bool _Contains(const AABB& outer, const AABB& inner);
+};
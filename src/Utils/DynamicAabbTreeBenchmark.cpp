@@ -0,0 +1,198 @@
+#include "DynamicAabbTreeBenchmark.h"
+#include <random>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <GLM/gtc/matrix_transform.hpp>
+#include <Logging.h>
+
+#include "Utils/DynamicAabbTree.h"
+
+namespace {
+	typedef std::chrono::high_resolution_clock Clock;
+
+	double ElapsedMs(const Clock::time_point& start) {
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+}
+
+std::vector<std::string> DynamicAabbTreeBenchmark::Run(uint32_t objectCount) {
+	constexpr uint32_t QUERY_COUNT = 500;
+	constexpr float    WORLD_SIZE  = 500.0f;
+
+	// Fixed seed so runs are comparable
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> position(-WORLD_SIZE, WORLD_SIZE);
+	std::uniform_real_distribution<float> extent(0.25f, 4.0f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	auto randomDirection = [&]() {
+		glm::vec3 result(unit(random), unit(random), unit(random));
+		return glm::length(result) > 0.001f ? glm::normalize(result) : glm::vec3(1.0f, 0.0f, 0.0f);
+	};
+
+	std::vector<AABB> boxes;
+	boxes.reserve(objectCount);
+	for (uint32_t ix = 0; ix < objectCount; ix++) {
+		glm::vec3 center(position(random), position(random), position(random) * 0.1f);
+		glm::vec3 size(extent(random), extent(random), extent(random));
+		boxes.emplace_back(center - size, center + size);
+	}
+
+	DynamicAabbTree tree;
+	std::vector<DynamicAabbTree::ProxyId> proxies;
+	proxies.reserve(objectCount);
+	Clock::time_point start = Clock::now();
+	for (AABB& box : boxes) {
+		proxies.push_back(tree.CreateProxy(box, &box));
+	}
+	double buildMs = ElapsedMs(start);
+
+	// Nudge a tenth of the objects, about what a busy frame of gameplay would do. Most stay inside their fat boxes
+	uint32_t reinserted = 0;
+	start = Clock::now();
+	for (uint32_t ix = 0; ix < objectCount; ix += 10) {
+		glm::vec3 offset = randomDirection() * 0.05f;
+		boxes[ix].Min += offset;
+		boxes[ix].Max += offset;
+		reinserted += tree.MoveProxy(proxies[ix], boxes[ix]) ? 1 : 0;
+	}
+	double refitMs = ElapsedMs(start);
+
+	std::vector<Frustum>        frusta;
+	std::vector<AABB>           queryBoxes;
+	std::vector<BoundingSphere> spheres;
+	std::vector<glm::vec3>      rayOrigins;
+	std::vector<glm::vec3>      rayDirections;
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 200.0f);
+	for (uint32_t ix = 0; ix < QUERY_COUNT; ix++) {
+		glm::vec3 eye(position(random), position(random), 10.0f);
+		frusta.push_back(Frustum::FromViewProjection(projection * glm::lookAt(eye, eye + randomDirection(), glm::vec3(0.0f, 0.0f, 1.0f))));
+		glm::vec3 center(position(random), position(random), 0.0f);
+		queryBoxes.emplace_back(center - glm::vec3(20.0f), center + glm::vec3(20.0f));
+		BoundingSphere sphere;
+		sphere.Center = glm::vec3(position(random), position(random), 0.0f);
+		sphere.Radius = 20.0f;
+		spheres.push_back(sphere);
+		rayOrigins.push_back(glm::vec3(position(random), position(random), position(random) * 0.1f));
+		rayDirections.push_back(randomDirection());
+	}
+
+	// Runs a query QUERY_COUNT times, returning the average time per query in ms and the total hits
+	auto measure = [&](const std::function<uint32_t(uint32_t)>& query, uint32_t& hits) {
+		hits = 0;
+		Clock::time_point begin = Clock::now();
+		for (uint32_t ix = 0; ix < QUERY_COUNT; ix++) {
+			hits += query(ix);
+		}
+		return ElapsedMs(begin) / QUERY_COUNT;
+	};
+
+	// The tree reports fat boxes, so both sides test the real box to make sure they agree on the hits
+	struct Result {
+		const char* Name;
+		double      TreeMs;
+		double      LinearMs;
+		uint32_t    TreeHits;
+		uint32_t    LinearHits;
+	};
+	std::vector<Result> results;
+	results.reserve(4);
+
+	Result& frustumResult = results.emplace_back(Result{ "Frustum" });
+	frustumResult.TreeMs = measure([&](uint32_t ix) {
+		uint32_t hits = 0;
+		tree.QueryFrustum(frusta[ix], [&](DynamicAabbTree::ProxyId proxy) {
+			hits += frusta[ix].Intersects(*static_cast<AABB*>(tree.GetUserData(proxy))) ? 1 : 0;
+			return true;
+		});
+		return hits;
+	}, frustumResult.TreeHits);
+	frustumResult.LinearMs = measure([&](uint32_t ix) {
+		uint32_t hits = 0;
+		for (const AABB& box : boxes) {
+			hits += frusta[ix].Intersects(box) ? 1 : 0;
+		}
+		return hits;
+	}, frustumResult.LinearHits);
+
+	Result& boxResult = results.emplace_back(Result{ "Box" });
+	boxResult.TreeMs = measure([&](uint32_t ix) {
+		uint32_t hits = 0;
+		tree.QueryBox(queryBoxes[ix], [&](DynamicAabbTree::ProxyId proxy) {
+			hits += queryBoxes[ix].Intersects(*static_cast<AABB*>(tree.GetUserData(proxy))) ? 1 : 0;
+			return true;
+		});
+		return hits;
+	}, boxResult.TreeHits);
+	boxResult.LinearMs = measure([&](uint32_t ix) {
+		uint32_t hits = 0;
+		for (const AABB& box : boxes) {
+			hits += queryBoxes[ix].Intersects(box) ? 1 : 0;
+		}
+		return hits;
+	}, boxResult.LinearHits);
+
+	Result& sphereResult = results.emplace_back(Result{ "Sphere" });
+	sphereResult.TreeMs = measure([&](uint32_t ix) {
+		uint32_t hits = 0;
+		tree.QuerySphere(spheres[ix], [&](DynamicAabbTree::ProxyId proxy) {
+			hits += DynamicAabbTree::SphereIntersects(*static_cast<AABB*>(tree.GetUserData(proxy)), spheres[ix]) ? 1 : 0;
+			return true;
+		});
+		return hits;
+	}, sphereResult.TreeHits);
+	sphereResult.LinearMs = measure([&](uint32_t ix) {
+		uint32_t hits = 0;
+		for (const AABB& box : boxes) {
+			hits += DynamicAabbTree::SphereIntersects(box, spheres[ix]) ? 1 : 0;
+		}
+		return hits;
+	}, sphereResult.LinearHits);
+
+	// Closest hit, like picking would do. Hits are counted as rays that hit anything
+	constexpr float RAY_LENGTH = 2.0f * WORLD_SIZE;
+	Result& rayResult = results.emplace_back(Result{ "Ray" });
+	rayResult.TreeMs = measure([&](uint32_t ix) {
+		const glm::vec3 invDirection = 1.0f / rayDirections[ix];
+		bool hit = false;
+		tree.RayCast(rayOrigins[ix], rayDirections[ix], RAY_LENGTH, [&](DynamicAabbTree::ProxyId proxy, float entryDistance, float rayLength) {
+			float distance;
+			if (DynamicAabbTree::RayIntersects(*static_cast<AABB*>(tree.GetUserData(proxy)), rayOrigins[ix], invDirection, rayLength, distance)) {
+				hit = true;
+				return distance;
+			}
+			return rayLength;
+		});
+		return hit ? 1u : 0u;
+	}, rayResult.TreeHits);
+	rayResult.LinearMs = measure([&](uint32_t ix) {
+		const glm::vec3 invDirection = 1.0f / rayDirections[ix];
+		float closest = RAY_LENGTH;
+		bool hit = false;
+		for (const AABB& box : boxes) {
+			float distance;
+			if (DynamicAabbTree::RayIntersects(box, rayOrigins[ix], invDirection, closest, distance)) {
+				closest = distance;
+				hit = true;
+			}
+		}
+		return hit ? 1u : 0u;
+	}, rayResult.LinearHits);
+
+	std::vector<std::string> lines;
+	char buffer[256];
+	snprintf(buffer, sizeof(buffer), "%u objects: build %.2fms, height %d, moved %u (%u re-inserted) in %.3fms",
+			 objectCount, buildMs, tree.GetHeight(), (objectCount + 9) / 10, reinserted, refitMs);
+	lines.push_back(buffer);
+	LOG_INFO("Spatial tree benchmark: {}", buffer);
+	for (const Result& result : results) {
+		snprintf(buffer, sizeof(buffer), "  %-8s tree %.4fms  linear %.4fms  (%.1fx, %u hits)",
+				 result.Name, result.TreeMs, result.LinearMs, result.LinearMs / std::max(result.TreeMs, 1.0e-6), result.TreeHits);
+		lines.push_back(buffer);
+		LOG_INFO("Spatial tree benchmark: {}", buffer);
+		if (result.TreeHits != result.LinearHits) {
+			LOG_WARN("Spatial tree benchmark: {} queries found {} hits, but the linear scan found {}", result.Name, result.TreeHits, result.LinearHits);
+		}
+	}
+	return lines;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+
+/// <summary>
+/// Times queries against a DynamicAabbTree of random boxes, compared to linear scans over the same boxes
+///
+/// Covers building the tree, moving some of the boxes, and frustum, box, sphere and ray queries. Both
+/// sides of each query test the real boxes, so they should always agree on the number of hits
+/// </summary>
+class DynamicAabbTreeBenchmark {
+public:
+	/// <summary>
+	/// Runs the benchmark, logging the results as it goes
+	/// </summary>
+	/// <param name="objectCount">The number of boxes to test with</param>
+	/// <returns>The results, a summary line followed by one line per query type</returns>
+	static std::vector<std::string> Run(uint32_t objectCount);
+
+protected:
+	DynamicAabbTreeBenchmark() = default;
+	~DynamicAabbTreeBenchmark() = default;
+};
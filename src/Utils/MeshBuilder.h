@@ -138,9 +138,19 @@ public:
 		// Store our vertex type in the VAO's vertex declaration
 		result->SetVDecl(VertType::V_DECL);
 
+		// Store the bounds so the mesh can be culled
+		result->SetBounds(CalculateBounds());
+
 		return result;
 	}
 	
+	/// <summary>
+	/// Calculates the bounding box and sphere of the vertices currently in the mesh
+	/// </summary>
+	MeshBounds CalculateBounds() const {
+		return MeshBounds::FromVertices(_vertices.data(), _vertices.size());
+	}
+	
 	/// <summary>
 	/// Resets this mesh, removing all vertices and indices
 	/// </summary>
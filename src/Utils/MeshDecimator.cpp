@@ -0,0 +1,247 @@
+#include "MeshDecimator.h"
+
+#include <algorithm>
+#include <numeric>
+#include <limits>
+
+void MeshDecimator::Quadric::AddPlane(const glm::dvec4& plane, double weight) {
+	A00 += weight * plane.x * plane.x; A01 += weight * plane.x * plane.y; A02 += weight * plane.x * plane.z; A03 += weight * plane.x * plane.w;
+	A11 += weight * plane.y * plane.y; A12 += weight * plane.y * plane.z; A13 += weight * plane.y * plane.w;
+	A22 += weight * plane.z * plane.z; A23 += weight * plane.z * plane.w;
+	A33 += weight * plane.w * plane.w;
+}
+
+void MeshDecimator::Quadric::Add(const Quadric& other) {
+	A00 += other.A00; A01 += other.A01; A02 += other.A02; A03 += other.A03;
+	A11 += other.A11; A12 += other.A12; A13 += other.A13;
+	A22 += other.A22; A23 += other.A23;
+	A33 += other.A33;
+}
+
+double MeshDecimator::Quadric::Error(const glm::dvec3& p) const {
+	// Expanded form of v^T * Q * v, with v = (p, 1)
+	return
+		A00 * p.x * p.x + 2.0 * A01 * p.x * p.y + 2.0 * A02 * p.x * p.z + 2.0 * A03 * p.x +
+		A11 * p.y * p.y + 2.0 * A12 * p.y * p.z + 2.0 * A13 * p.y +
+		A22 * p.z * p.z + 2.0 * A23 * p.z +
+		A33;
+}
+
+std::vector<uint32_t> MeshDecimator::Decimate(const std::vector<uint32_t>& indices, const void* vertices, size_t vertexCount, size_t stride, size_t offset, size_t targetIndexCount)
+{
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(vertices) + offset;
+	auto position = [&](uint32_t vertex) {
+		return glm::dvec3(*reinterpret_cast<const glm::vec3*>(bytes + vertex * stride));
+	};
+
+	// The OBJ loader splits vertices wherever the UVs or normals change, so weld vertices back together by
+	// position to get the actual surface. Each welded vertex is identified by one of it's original vertices
+	std::vector<uint32_t> order(vertexCount);
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+		glm::dvec3 pa = position(a), pb = position(b);
+		return pa.x != pb.x ? pa.x < pb.x : (pa.y != pb.y ? pa.y < pb.y : pa.z < pb.z);
+	});
+	std::vector<uint32_t> weld(vertexCount);
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		bool same = ix > 0 && position(order[ix]) == position(order[ix - 1]);
+		weld[order[ix]] = same ? weld[order[ix - 1]] : order[ix];
+	}
+
+	// Lock welded vertices that are used by more than one original vertex, these are on a seam
+	std::vector<uint32_t> firstWedge(vertexCount, UINT32_MAX);
+	std::vector<uint8_t>  locked(vertexCount, 0);
+	for (uint32_t index : indices) {
+		uint32_t welded = weld[index];
+		if (firstWedge[welded] == UINT32_MAX) {
+			firstWedge[welded] = index;
+		} else if (firstWedge[welded] != index) {
+			locked[welded] = 1;
+		}
+	}
+
+	// Build the welded triangles, dropping any that are already degenerate
+	std::vector<Triangle> triangles;
+	triangles.reserve(indices.size() / 3);
+	for (size_t ix = 0; ix + 2 < indices.size(); ix += 3) {
+		Triangle triangle;
+		for (int corner = 0; corner < 3; corner++) {
+			triangle.Corners[corner] ={ weld[indices[ix + corner]], indices[ix + corner] };
+		}
+		if (!triangle.IsDegenerate()) {
+			triangles.push_back(triangle);
+		}
+	}
+
+	// Lock vertices on open borders, an edge is on the border if no triangle uses it in the other direction
+	std::vector<uint64_t> edges;
+	edges.reserve(triangles.size() * 3);
+	for (const Triangle& triangle : triangles) {
+		for (int corner = 0; corner < 3; corner++) {
+			uint64_t from = triangle.Corners[corner].Welded, to = triangle.Corners[(corner + 1) % 3].Welded;
+			edges.push_back((from << 32) | to);
+		}
+	}
+	std::sort(edges.begin(), edges.end());
+	for (uint64_t edge : edges) {
+		uint64_t reverse = (edge << 32) | (edge >> 32);
+		if (!std::binary_search(edges.begin(), edges.end(), reverse)) {
+			locked[edge >> 32] = 1;
+			locked[edge & 0xFFFFFFFF] = 1;
+		}
+	}
+
+	// Each vertex's quadric is the sum of it's triangles' planes, weighted by area so that small triangles
+	// don't get the same say as large ones
+	std::vector<Quadric> quadrics(vertexCount);
+	for (const Triangle& triangle : triangles) {
+		glm::dvec3 p0 = position(triangle.Corners[0].Welded);
+		glm::dvec3 normal = glm::cross(position(triangle.Corners[1].Welded) - p0, position(triangle.Corners[2].Welded) - p0);
+		double length = glm::length(normal);
+		if (length <= 0.0) {
+			continue;
+		}
+		normal /= length;
+		glm::dvec4 plane = glm::dvec4(normal, -glm::dot(normal, p0));
+		for (int corner = 0; corner < 3; corner++) {
+			quadrics[triangle.Corners[corner].Welded].AddPlane(plane, length * 0.5);
+		}
+	}
+
+	const size_t targetTriangles = targetIndexCount / 3;
+	std::vector<uint32_t> adjacencyOffsets;
+	std::vector<uint32_t> adjacency;
+	std::vector<uint8_t>  touched;
+
+	struct Collapse {
+		uint32_t From;
+		uint32_t To;
+		double   Cost;
+	};
+	std::vector<Collapse> collapses;
+
+	for (int pass = 0; pass < MAX_PASSES && triangles.size() > targetTriangles; pass++) {
+		// Find the triangles around each vertex, counting sort style so it's all one allocation
+		adjacencyOffsets.assign(vertexCount + 1, 0);
+		for (const Triangle& triangle : triangles) {
+			for (int corner = 0; corner < 3; corner++) {
+				adjacencyOffsets[triangle.Corners[corner].Welded + 1]++;
+			}
+		}
+		for (size_t ix = 1; ix <= vertexCount; ix++) {
+			adjacencyOffsets[ix] += adjacencyOffsets[ix - 1];
+		}
+		adjacency.resize(triangles.size() * 3);
+		std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (uint32_t tri = 0; tri < triangles.size(); tri++) {
+			for (int corner = 0; corner < 3; corner++) {
+				adjacency[cursor[triangles[tri].Corners[corner].Welded]++] = tri;
+			}
+		}
+
+		// The cheapest edge to collapse for every vertex that is allowed to move
+		collapses.clear();
+		for (uint32_t vertex = 0; vertex < vertexCount; vertex++) {
+			if (locked[vertex] || adjacencyOffsets[vertex] == adjacencyOffsets[vertex + 1]) {
+				continue;
+			}
+			Collapse best ={ vertex, vertex, std::numeric_limits<double>::max() };
+			for (uint32_t adj = adjacencyOffsets[vertex]; adj < adjacencyOffsets[vertex + 1]; adj++) {
+				for (const Corner& corner : triangles[adjacency[adj]].Corners) {
+					if (corner.Welded == vertex) {
+						continue;
+					}
+					glm::dvec3 target = position(corner.Welded);
+					double cost = quadrics[vertex].Error(target) + quadrics[corner.Welded].Error(target);
+					if (cost < best.Cost) {
+						best ={ vertex, corner.Welded, cost };
+					}
+				}
+			}
+			if (best.To != vertex) {
+				collapses.push_back(best);
+			}
+		}
+		if (collapses.empty()) {
+			break;
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.Cost < b.Cost; });
+
+		// Apply as many collapses as we can, skipping any that touch an area we've already changed this pass
+		touched.assign(vertexCount, 0);
+		size_t remaining = triangles.size();
+		for (const Collapse& collapse : collapses) {
+			if (remaining <= targetTriangles) {
+				break;
+			}
+			if (touched[collapse.From] || touched[collapse.To]) {
+				continue;
+			}
+
+			// Reject collapses that would fold a triangle over, and find which of the target's vertices
+			// is used alongside the vertex we're removing so we keep the right UVs
+			glm::dvec3 target = position(collapse.To);
+			uint32_t targetOriginal = UINT32_MAX;
+			uint32_t removed = 0;
+			bool flips = false;
+			for (uint32_t adj = adjacencyOffsets[collapse.From]; adj < adjacencyOffsets[collapse.From + 1] && !flips; adj++) {
+				const Triangle& triangle = triangles[adjacency[adj]];
+				if (triangle.IsDegenerate()) {
+					continue;
+				}
+				if (triangle.Contains(collapse.To)) {
+					removed++;
+					for (const Corner& corner : triangle.Corners) {
+						if (corner.Welded == collapse.To) {
+							targetOriginal = corner.Original;
+						}
+					}
+					continue;
+				}
+
+				glm::dvec3 points[3], moved[3];
+				for (int corner = 0; corner < 3; corner++) {
+					points[corner] = position(triangle.Corners[corner].Welded);
+					moved[corner] = triangle.Corners[corner].Welded == collapse.From ? target : points[corner];
+				}
+				glm::dvec3 before = glm::cross(points[1] - points[0], points[2] - points[0]);
+				glm::dvec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+				double lengths = glm::length(before) * glm::length(after);
+				flips = lengths <= 0.0 || glm::dot(before, after) < MIN_NORMAL_DOT * lengths;
+			}
+			if (flips || targetOriginal == UINT32_MAX) {
+				continue;
+			}
+
+			// Move the vertex, the triangles that shared the edge become degenerate and get cleaned up after the pass
+			for (uint32_t adj = adjacencyOffsets[collapse.From]; adj < adjacencyOffsets[collapse.From + 1]; adj++) {
+				for (Corner& corner : triangles[adjacency[adj]].Corners) {
+					touched[corner.Welded] = 1;
+					if (corner.Welded == collapse.From) {
+						corner ={ collapse.To, targetOriginal };
+					}
+				}
+			}
+			quadrics[collapse.To].Add(quadrics[collapse.From]);
+			touched[collapse.From] = 1;
+			remaining -= removed;
+		}
+
+		size_t before = triangles.size();
+		triangles.erase(std::remove_if(triangles.begin(), triangles.end(), [](const Triangle& triangle) {
+			return triangle.IsDegenerate();
+		}), triangles.end());
+		if (triangles.size() == before) {
+			break;
+		}
+	}
+
+	std::vector<uint32_t> result;
+	result.reserve(triangles.size() * 3);
+	for (const Triangle& triangle : triangles) {
+		for (const Corner& corner : triangle.Corners) {
+			result.push_back(corner.Original);
+		}
+	}
+	return result;
+}
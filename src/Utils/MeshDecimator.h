@@ -0,0 +1,66 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// Simplifies triangle meshes by collapsing edges in order of their quadric error (Garland and Heckbert),
+/// used for generating mesh LODs
+///
+/// Edges are collapsed onto one of their existing endpoints rather than a new optimal position, so the
+/// simplified mesh can keep using the original vertex buffer and only needs a new index buffer. Vertices on
+/// UV or normal seams and on open borders are never moved, so textures don't smear and holes don't open up
+/// </summary>
+class MeshDecimator {
+public:
+	/// <summary>
+	/// Simplifies a triangle list down to roughly the given number of indices
+	/// </summary>
+	/// <param name="indices">The triangle list to simplify</param>
+	/// <param name="vertices">A pointer to the vertex data that the indices refer to</param>
+	/// <param name="vertexCount">The number of vertices</param>
+	/// <param name="stride">The size of a single vertex in bytes</param>
+	/// <param name="offset">The offset of the vertex position (a vec3) within a vertex, in bytes</param>
+	/// <param name="targetIndexCount">The number of indices to aim for</param>
+	/// <returns>The simplified triangle list, which can have more indices than requested if the mesh could not be simplified any further</returns>
+	static std::vector<uint32_t> Decimate(const std::vector<uint32_t>& indices, const void* vertices, size_t vertexCount, size_t stride, size_t offset, size_t targetIndexCount);
+
+protected:
+	MeshDecimator() = default;
+	~MeshDecimator() = default;
+
+	// Symmetric 4x4 matrix that measures the sum of squared distances from a point to a set of planes
+	struct Quadric {
+		double A00 = 0.0, A01 = 0.0, A02 = 0.0, A03 = 0.0;
+		double A11 = 0.0, A12 = 0.0, A13 = 0.0;
+		double A22 = 0.0, A23 = 0.0;
+		double A33 = 0.0;
+
+		void AddPlane(const glm::dvec4& plane, double weight);
+		void Add(const Quadric& other);
+		double Error(const glm::dvec3& point) const;
+	};
+
+	// A triangle corner, tracking both the position it shares with other vertices and the
+	// vertex from the original buffer that it will output
+	struct Corner {
+		uint32_t Welded;
+		uint32_t Original;
+	};
+
+	struct Triangle {
+		Corner Corners[3];
+
+		bool Contains(uint32_t welded) const {
+			return Corners[0].Welded == welded || Corners[1].Welded == welded || Corners[2].Welded == welded;
+		}
+		bool IsDegenerate() const {
+			return Corners[0].Welded == Corners[1].Welded || Corners[1].Welded == Corners[2].Welded || Corners[0].Welded == Corners[2].Welded;
+		}
+	};
+
+	// The most passes over the mesh we'll make before giving up on reaching the target
+	static constexpr int MAX_PASSES = 64;
+	// Collapses that rotate a neighbouring triangle's normal further than this (as a cosine) are rejected
+	static constexpr double MIN_NORMAL_DOT = 0.2;
+};
@@ -7,8 +7,11 @@
 #include <fstream>
 #include <iostream>
 #include <filesystem>
+#include <algorithm>
+#include <cstddef>
 
 #include "Utils/StringUtils.h"
+#include "Utils/MeshDecimator.h"
 #include "GLFW/glfw3.h"
 #include "Logging.h"
 
@@ -17,7 +20,7 @@ const std::string binaryExtension = ".bin";
 
 namespace fs = std::filesystem;
 
-VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& filename) {
+VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& filename, std::vector<VertexArrayObject::Sptr>* lods) {
 	// Get the file extension and lowercase it
 	fs::path filePath = std::filesystem::path(filename);
 	std::string extension = filePath.extension().string();
@@ -27,16 +30,17 @@ VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& file
 	if (extension == ".obj") {
 		// Get the binary path
 		fs::path binPath = filePath.replace_extension(binaryExtension);
-		// If the file does not exist, convert the OBJ file to a binary file
-		if (!fs::exists(binPath)) {
+		// If the file does not exist, convert the OBJ file to a binary file. Files from before we had LODs
+		// get converted again so they pick them up
+		if (!fs::exists(binPath) || _ReadBinaryVersion(binPath.string()) < 0x03) {
 			ConvertToBinary(filename, binPath.string());
 		}
 		// Load the corresponding binary file
-		return _LoadFromBinFile(binPath.string());
+		return _LoadFromBinFile(binPath.string(), lods);
 	} 
 	// Load our fancy binary files
 	else if (extension == ".bin") {
-		return _LoadFromBinFile(filename);
+		return _LoadFromBinFile(filename, lods);
 	}
 	// We've never met this extension in our life
 	else {
@@ -62,11 +66,27 @@ void OptimizedObjLoader::ConvertToBinary(const std::string& inFile, const std::s
 		outFileName = path.string();
 	}
 
+	// Generate the LOD chain, each level is simplified from the one before it since that's
+	// a lot less work than starting from the full mesh every time
+	std::vector<uint32_t> fullIndices(mesh->GetIndexDataPtr(), mesh->GetIndexDataPtr() + mesh->GetIndexCount());
+	std::vector<std::vector<uint32_t>> lods;
+	const std::vector<uint32_t>* previous = &fullIndices;
+	for (float ratio : LOD_RATIOS) {
+		size_t target = static_cast<size_t>(fullIndices.size() * ratio) / 3 * 3;
+		std::vector<uint32_t> lod = MeshDecimator::Decimate(*previous, mesh->GetVertexDataPtr(), mesh->GetVertexCount(),
+			sizeof(VertexPosNormTexColTangents), offsetof(VertexPosNormTexColTangents, Position), target);
+		if (lod.empty() || lod.size() > previous->size() * LOD_MIN_REDUCTION) {
+			break;
+		}
+		lods.push_back(std::move(lod));
+		previous = &lods.back();
+	}
+
 	// Save the mesh to the file
-	SaveBinaryFile(*mesh, outFileName);
+	SaveBinaryFile(*mesh, outFileName, lods);
 
 	float endTime = static_cast<float>(glfwGetTime());
-	LOG_TRACE("Converted OBJ file to binary \"{}\" in {} seconds ({} vertices, {} indices)", inFile, endTime - startTime, mesh->GetVertexCount(), mesh->GetIndexCount());
+	LOG_TRACE("Converted OBJ file to binary \"{}\" in {} seconds ({} vertices, {} indices, {} LODs)", inFile, endTime - startTime, mesh->GetVertexCount(), mesh->GetIndexCount(), lods.size());
 
 	// We no longer need the mesh data, free it
 	delete mesh;
@@ -233,7 +253,16 @@ MeshBuilder<VertexPosNormTexColTangents>* OptimizedObjLoader::_LoadFromObjFile(c
 	return mesh;
 }
 
-VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string& filename) {
+uint16_t OptimizedObjLoader::_ReadBinaryVersion(const std::string& filename) {
+	std::ifstream file(filename, std::ios::binary);
+	BinaryHeader header = BinaryHeader();
+	if (!file || !file.read(reinterpret_cast<char*>(&header), sizeof(BinaryHeader))) {
+		return 0;
+	}
+	return std::equal(HEADER_BYTES, HEADER_BYTES + 4, header.HeaderBytes) ? header.Version : 0;
+}
+
+VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string& filename, std::vector<VertexArrayObject::Sptr>* lods) {
 
 	// Open the output file
 	std::ifstream file(filename, std::ios::binary);
@@ -258,11 +287,17 @@ VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string&
 
 	// TODO: validate header
 
-	// Handle our version
-	if (header.Version == 0x01) {
-		// Determine how many bytes we need in the file
+	// Handle our version, version 2 is the same as version 1 but with bounds after the header, and
+	// version 3 adds a table of LODs after the bounds
+	if (header.Version >= 0x01 && header.Version <= 0x03) {
+		bool hasBounds = header.Version >= 0x02;
+		bool hasLods = header.Version >= 0x03;
+
+		// Determine how many bytes we need in the file (not counting the LODs, we check those once we know how many there are)
 		size_t requiredBytes =
 			sizeof(BinaryHeader) +
+			(hasBounds ? sizeof(BinaryBounds) : 0) +
+			(hasLods ? sizeof(uint32_t) : 0) +
 			(header.NumAttributes * sizeof(BufferAttribute)) +
 			(header.VertexStride * (size_t)header.NumVertices) +
 			(header.NumIndices * GetIndexTypeSize(header.IndicesType));
@@ -273,6 +308,38 @@ VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string&
 			return nullptr;
 		}
 
+		// Read in the bounds if the file has them
+		MeshBounds meshBounds;
+		if (hasBounds) {
+			BinaryBounds bounds = BinaryBounds();
+			file.read(reinterpret_cast<char*>(&bounds), sizeof(BinaryBounds));
+			meshBounds.Box = AABB(bounds.BoxMin, bounds.BoxMax);
+			meshBounds.Sphere.Center = bounds.SphereCenter;
+			meshBounds.Sphere.Radius = bounds.SphereRadius;
+		}
+
+		// Read in how many indices are in each LOD
+		std::vector<uint32_t> lodIndexCounts;
+		if (hasLods) {
+			uint32_t numLods = 0;
+			file.read(reinterpret_cast<char*>(&numLods), sizeof(uint32_t));
+			requiredBytes += numLods * sizeof(uint32_t);
+			if (size < requiredBytes) {
+				LOG_ERROR("Not enough data in the file!");
+				return nullptr;
+			}
+
+			lodIndexCounts.resize(numLods);
+			file.read(reinterpret_cast<char*>(lodIndexCounts.data()), numLods * sizeof(uint32_t));
+			for (uint32_t count : lodIndexCounts) {
+				requiredBytes += count * sizeof(uint32_t);
+			}
+			if (size < requiredBytes) {
+				LOG_ERROR("Not enough data in the file!");
+				return nullptr;
+			}
+		}
+
 		// Read all attributes from the file, this is basically our VDECL
 		std::vector<BufferAttribute> vertexDeclaration;
 		vertexDeclaration.resize(header.NumAttributes);
@@ -305,6 +372,16 @@ VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string&
 		void* vertexStore = malloc(header.NumVertices * (size_t)header.VertexStride);
 		file.read(reinterpret_cast<char*>(vertexStore), header.NumVertices * (size_t)header.VertexStride);
 
+		// Older files don't have bounds, so we calculate them while we still have the vertices around
+		if (!hasBounds) {
+			auto it = std::find_if(vertexDeclaration.begin(), vertexDeclaration.end(), [](const BufferAttribute& attrib) {
+				return attrib.Usage == AttribUsage::Position;
+			});
+			if (it != vertexDeclaration.end()) {
+				meshBounds = MeshBounds::FromPositions(vertexStore, header.NumVertices, header.VertexStride, it->Offset);
+			}
+		}
+
 		// Load data into OpenGL and free the CPU copy
 		vertices->LoadData(vertexStore, header.VertexStride, header.NumVertices);
 		free(vertexStore);
@@ -316,10 +393,28 @@ VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string&
 
 		// Copy in the vertex declaration we loaded
 		result->SetVDecl(vertexDeclaration);
+		result->SetBounds(meshBounds);
+
+		// LODs are stored as uint indices after the vertices, they get their own IBO but share everything else with the full mesh
+		std::vector<uint32_t> lodIndices;
+		for (uint32_t count : lodIndexCounts) {
+			lodIndices.resize(count);
+			file.read(reinterpret_cast<char*>(lodIndices.data()), count * sizeof(uint32_t));
+			if (lods == nullptr || count == 0) {
+				continue;
+			}
+
+			IndexBuffer::Sptr lodBuffer = IndexBuffer::Create(BufferUsage::StaticDraw);
+			lodBuffer->LoadData(lodIndices.data(), count);
+
+			VertexArrayObject::Sptr lod = result->Clone();
+			lod->SetIndexBuffer(lodBuffer);
+			lods->push_back(lod);
+		}
 
 		// Calculate and trace out how long it took us to load
 		float endTime = static_cast<float>(glfwGetTime());
-		LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices)", filename, endTime - startTime, header.NumVertices, header.NumIndices);
+		LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices, {} LODs)", filename, endTime - startTime, header.NumVertices, header.NumIndices, lodIndexCounts.size());
 
 		return result;
 	}
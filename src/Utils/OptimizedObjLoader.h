@@ -7,6 +7,7 @@
  */
 #pragma once
 #include <fstream>
+#include <vector>
 
 #include "Graphics/VertexArrayObject.h"
 #include "Graphics/VertexTypes.h"
@@ -24,10 +25,11 @@ public:
 	/// to a binary file and load that instead. On subsequent runs, the binary file will be loaded instead
 	/// </summary>
 	/// <param name="filename">The path to the .obj or .bin file to load</param>
+	/// <param name="lods">If not null, will be filled with the mesh's lower detail LODs (coarsest last), which share the returned VAO's vertex buffer</param>
 	/// <returns>A VAO loaded from disk</returns>
-	static VertexArrayObject::Sptr LoadFromFile(const std::string& filename);
+	static VertexArrayObject::Sptr LoadFromFile(const std::string& filename, std::vector<VertexArrayObject::Sptr>* lods = nullptr);
 	/// <summary>
-	/// Manually converts an OBJ file into a binary mesh file
+	/// Manually converts an OBJ file into a binary mesh file, generating a chain of simplified LODs
 	/// </summary>
 	/// <param name="inFile">The path to OBJ file to convert</param>
 	/// <param name="outFile">The output path for the bin file, or empty to use the inFile path and replace the extension with .bin</param>
@@ -39,8 +41,9 @@ public:
 	/// <typeparam name="VertexType"></typeparam>
 	/// <param name="mesh"></param>
 	/// <param name="outFilename"></param>
+	/// <param name="lods">Index lists for any lower detail LODs of the mesh, referencing the mesh's vertices</param>
 	template <typename VertexType>
-	static void SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename);
+	static void SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename, const std::vector<std::vector<uint32_t>>& lods = {});
 
 protected:
 	// Will be put at the start of the binary file, contains info about the contents of the file
@@ -61,15 +64,34 @@ protected:
 		uint8_t   NumAttributes = 0;
 	};
 
+	// Written directly after the header from version 2 onwards, stores the mesh's bounding
+	// volumes so we don't need to walk the vertices at load time
+	struct BinaryBounds {
+		glm::vec3 BoxMin;
+		glm::vec3 BoxMax;
+		glm::vec3 SphereCenter;
+		float     SphereRadius;
+	};
+
+	// The fraction of the full mesh's triangles to aim for in each generated LOD
+	static constexpr float LOD_RATIOS[] ={ 0.5f, 0.25f, 0.1f };
+	// If a LOD can't get below this fraction of the previous level's triangles, the mesh is
+	// as simple as it's going to get and we stop the chain there
+	static constexpr float LOD_MIN_REDUCTION = 0.85f;
+
 	OptimizedObjLoader() = default;
 	~OptimizedObjLoader() = default;
 
 	static MeshBuilder<VertexPosNormTexColTangents>* _LoadFromObjFile(const std::string& filename);
-	static VertexArrayObject::Sptr _LoadFromBinFile(const std::string& filename);
+	static VertexArrayObject::Sptr _LoadFromBinFile(const std::string& filename, std::vector<VertexArrayObject::Sptr>* lods);
+	/// <summary>
+	/// Reads just the version from a binary file's header, or 0 if the file is not a valid binary mesh
+	/// </summary>
+	static uint16_t _ReadBinaryVersion(const std::string& filename);
 };
 
 template <typename VertexType>
-void OptimizedObjLoader::SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename) {
+void OptimizedObjLoader::SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename, const std::vector<std::vector<uint32_t>>& lods) {
 	// Open the output file
 	std::ofstream file(outFilename, std::ios::binary);
 	if (!file) {
@@ -78,7 +100,7 @@ void OptimizedObjLoader::SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std
 
 	// Create the fixed size header for our output file
 	BinaryHeader header  = BinaryHeader();
-	header.Version       = 0x01; // This is version 1! Update this and implement different readers if changes to format are made
+	header.Version       = 0x03; // Version 2 adds bounds after the header, version 3 adds LODs! Update this and implement different readers if changes to format are made
 	header.NumIndices    = mesh.GetIndexCount();
 	header.IndicesType   = IndexType::UInt;
 	header.NumVertices   = mesh.GetVertexCount();
@@ -88,6 +110,23 @@ void OptimizedObjLoader::SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std
 	// Write header bytes to the stream
 	file.write(reinterpret_cast<const char*>(&header), sizeof(BinaryHeader));
 
+	// Write the bounding volumes of the mesh
+	MeshBounds meshBounds = mesh.CalculateBounds();
+	BinaryBounds bounds   = BinaryBounds();
+	bounds.BoxMin         = meshBounds.Box.Min;
+	bounds.BoxMax         = meshBounds.Box.Max;
+	bounds.SphereCenter   = meshBounds.Sphere.Center;
+	bounds.SphereRadius   = meshBounds.Sphere.Radius;
+	file.write(reinterpret_cast<const char*>(&bounds), sizeof(BinaryBounds));
+
+	// Write the number of indices in each LOD, the indices themselves go after the vertex data
+	uint32_t numLods = static_cast<uint32_t>(lods.size());
+	file.write(reinterpret_cast<const char*>(&numLods), sizeof(uint32_t));
+	for (const auto& lod : lods) {
+		uint32_t indexCount = static_cast<uint32_t>(lod.size());
+		file.write(reinterpret_cast<const char*>(&indexCount), sizeof(uint32_t));
+	}
+
 	// Write which attributes we have to the stream
 	for (int ix = 0; ix < VertexType::V_DECL.size(); ix++) {
 		file.write(reinterpret_cast<const char*>(&VertexType::V_DECL[ix]), sizeof(BufferAttribute));
@@ -99,4 +138,9 @@ void OptimizedObjLoader::SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std
 
 	// Write vertex data to file
 	file.write(reinterpret_cast<const char*>(mesh.GetVertexDataPtr()), mesh.GetVertexCount() * sizeof(VertexType));
+
+	// Write the index data for each LOD
+	for (const auto& lod : lods) {
+		file.write(reinterpret_cast<const char*>(lod.data()), lod.size() * sizeof(uint32_t));
+	}
 }
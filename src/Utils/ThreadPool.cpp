@@ -0,0 +1,91 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(uint32_t workerCount) :
+	_workers(std::vector<std::thread>()),
+	_task(nullptr),
+	_taskCount(0),
+	_nextTask(0),
+	_generation(0),
+	_busyWorkers(0),
+	_stopping(false)
+{
+	// The calling thread helps out with every job, so it counts as one of the hardware threads
+	if (workerCount == 0) {
+		workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+	}
+
+	_workers.reserve(workerCount);
+	for (uint32_t ix = 0; ix < workerCount; ix++) {
+		_workers.emplace_back(&ThreadPool::_WorkerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+	_wake.notify_all();
+	for (std::thread& worker : _workers) {
+		worker.join();
+	}
+}
+
+void ThreadPool::ParallelFor(uint32_t count, const std::function<void(uint32_t)>& task) {
+	if (count == 0) {
+		return;
+	}
+
+	// Not worth waking anyone up for
+	if (_workers.empty() || count == 1) {
+		for (uint32_t ix = 0; ix < count; ix++) {
+			task(ix);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_task = &task;
+		_taskCount = count;
+		_nextTask = 0;
+		_busyWorkers = static_cast<uint32_t>(_workers.size());
+		_generation++;
+	}
+	_wake.notify_all();
+
+	_RunTasks();
+
+	// Workers may still be finishing their last task, and the job can't go out of scope until they're done
+	std::unique_lock<std::mutex> lock(_mutex);
+	_done.wait(lock, [this]() { return _busyWorkers == 0; });
+	_task = nullptr;
+}
+
+void ThreadPool::_WorkerLoop() {
+	uint64_t lastGeneration = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_wake.wait(lock, [&]() { return _stopping || _generation != lastGeneration; });
+			if (_stopping) {
+				return;
+			}
+			lastGeneration = _generation;
+		}
+
+		_RunTasks();
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (--_busyWorkers == 0) {
+			_done.notify_one();
+		}
+	}
+}
+
+void ThreadPool::_RunTasks() {
+	for (uint32_t ix = _nextTask++; ix < _taskCount; ix = _nextTask++) {
+		(*_task)(ix);
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+#include "Utils/Macros.h"
+
+/// <summary>
+/// A fixed set of worker threads for splitting up per-frame work into independent tasks
+/// (ex: RenderLayer's draw extraction)
+///
+/// Workers sleep until ParallelFor hands them a job, then pull task indices off a shared
+/// counter until the job is done. The calling thread works on the job as well, so a pool with
+/// no workers just runs everything inline. ParallelFor should not be called from inside a task
+/// </summary>
+class ThreadPool final {
+public:
+	MAKE_PTRS(ThreadPool);
+	NO_COPY(ThreadPool);
+	NO_MOVE(ThreadPool);
+
+	/// <summary>
+	/// Creates a new thread pool
+	/// </summary>
+	/// <param name="workerCount">The number of worker threads to start, or 0 to use one less than the number of hardware threads</param>
+	ThreadPool(uint32_t workerCount = 0);
+	~ThreadPool();
+
+	/// <summary>
+	/// Gets the number of threads that work on a job, including the calling thread
+	/// </summary>
+	uint32_t GetThreadCount() const { return static_cast<uint32_t>(_workers.size()) + 1; }
+
+	/// <summary>
+	/// Invokes task once for every index in [0, count), spread across the workers and the calling
+	/// thread. Returns once every task has finished. Tasks may run in any order
+	/// </summary>
+	/// <param name="count">The number of tasks to run</param>
+	/// <param name="task">The task to run, invoked with the task index</param>
+	void ParallelFor(uint32_t count, const std::function<void(uint32_t)>& task);
+
+protected:
+	std::vector<std::thread> _workers;
+
+	std::mutex              _mutex;
+	// Signalled when a new job is posted, or the pool is shutting down
+	std::condition_variable _wake;
+	// Signalled when the last worker finishes the current job
+	std::condition_variable _done;
+
+	// The current job, only changed while no workers are busy
+	const std::function<void(uint32_t)>* _task;
+	uint32_t                             _taskCount;
+	std::atomic<uint32_t>                _nextTask;
+	// Incremented for every job, so workers can tell a new job from a spurious wakeup
+	uint64_t                             _generation;
+	// The number of workers that haven't finished the current job yet
+	uint32_t                             _busyWorkers;
+	bool                                 _stopping;
+
+	void _WorkerLoop();
+	/// <summary>
+	/// Runs tasks from the current job until there are none left
+	/// </summary>
+	void _RunTasks();
+};